@@ -47,6 +47,20 @@ Result GraphicsInterface::writeBuffer(void *dst_buf, const void *src_mem, size_t
     return res;
 }
 
+Result GraphicsInterface::beginUpload(UploadContext& /*ctx*/)
+{
+    return Result::NotAvailable;
+}
+
+Result GraphicsInterface::endUpload(UploadContext& /*ctx*/)
+{
+    return Result::NotAvailable;
+}
+
+void GraphicsInterface::fenceUploads()
+{
+}
+
 int GraphicsInterface::GetTexelSize(TextureFormat format)
 {
     switch (format)
@@ -102,6 +116,11 @@ GraphicsInterface* CreateGraphicsInterface(DeviceType type, void *device_ptr)
     case DeviceType::Vulkan:
         g_gfx_device = CreateGraphicsInterfaceVulkan(device_ptr);
         break;
+#endif
+#ifdef giSupportNull
+    case DeviceType::Null:
+        g_gfx_device = CreateGraphicsInterfaceNull(device_ptr);
+        break;
 #endif
     }
     return g_gfx_device;
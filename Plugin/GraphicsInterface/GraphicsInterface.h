@@ -11,6 +11,7 @@ enum class DeviceType
     OpenGL,
     Vulkan,
     PS4,
+    Null, // headless. resources are in host memory. for tests and benchmarks
 };
 
 enum class Result
@@ -81,6 +82,33 @@ struct MapContext
     MapMode mode = MapMode::Unknown;
     unsigned int size = 0;
     bool keep_staging_resource = false;
+    // set by mapBuffer(): data_ptr is write-combined memory that should not be written from multiple threads.
+    // build data in system memory and copy it in that case.
+    bool write_combined = false;
+    // set by mapBuffer(): data_ptr holds the current contents of the buffer. writing a part of it is enough.
+    bool keeps_contents = false;
+    // set before unmapBuffer() (optional): bytes written from the beginning of data_ptr. 0: the whole buffer.
+    // backends may transfer only this range.
+    unsigned int written_size = 0;
+};
+
+// sub-allocation in the upload ring. see GraphicsInterface::beginUpload()
+struct UploadContext
+{
+    void *data_ptr = nullptr;   // write here between beginUpload() and endUpload()
+    void *resource = nullptr;   // destination buffer
+    BufferType type = BufferType::Unknown;
+    size_t size = 0;
+    size_t dst_offset = 0;      // offset in the destination buffer
+    size_t ring_offset = 0;     // internal
+};
+
+// settings of DeviceType::Null. pass to CreateGraphicsInterface() as device_ptr (can be null)
+struct NullDeviceSettings
+{
+    double map_latency_ms = 0.0;    // added to each mapBuffer() to simulate the round trip to the driver
+    double bandwidth_gb = 0.0;      // GB per second of CPU -> GPU transfer on unmapBuffer() / endUpload(). 0: unlimited
+    bool   upload_ring = true;      // support beginUpload() / endUpload()
 };
 
 class GraphicsInterface
@@ -109,6 +137,16 @@ public:
     Result readBuffer(void *dst_mem, void *src_buf, size_t read_size, BufferType type);
     Result writeBuffer(void *dst_buf, const void *src_mem, size_t write_size, BufferType type);
 
+    // upload ring: a large persistently mapped buffer that is sub-allocated instead of mapping each destination buffer.
+    // beginUpload() allocates ctx.size bytes and returns the address in ctx.data_ptr. endUpload() issues a copy command to
+    // ctx.resource. fenceUploads() marks the end of a frame; allocations before it are reused after the GPU has passed it.
+    // beginUpload(), endUpload() and fenceUploads() must be called on the render thread. writing data_ptr can be done
+    // on any thread. endUpload() clears ctx.data_ptr even if it fails.
+    // return Result::NotAvailable if the backend has no upload ring (OpenGL only for now). use mapBuffer() in that case.
+    virtual Result  beginUpload(UploadContext& ctx);
+    virtual Result  endUpload(UploadContext& ctx);
+    virtual void    fenceUploads();
+
     static int GetTexelSize(TextureFormat format);
 };
 
@@ -124,6 +162,7 @@ public:
 //    e.g:
 //      void *devices[] = {physical_device, device};
 //      CreateGraphicsInterface(DeviceType::Vulkan, devices);
+//  NullDeviceSettings* or nullptr on Null
 GraphicsInterface* CreateGraphicsInterface(DeviceType type, void *device_ptr);
 
 // return instance created by CreateGraphicsInterface()
@@ -347,6 +347,8 @@ Result GraphicsInterfaceD3D9::mapBuffer(MapContext& ctx)
 {
     if (!ctx.resource) { return Result::InvalidParameter; }
     auto hr = MapBuffer(ctx.resource, ctx.type, ctx.mode, ctx.data_ptr);
+    // discarded dynamic buffers are locked in driver memory
+    ctx.write_combined = ctx.mode == MapMode::Write;
     return TranslateReturnCode(hr);
 }
 
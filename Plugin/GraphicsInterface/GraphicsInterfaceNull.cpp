@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "giInternal.h"
+
+#ifdef giSupportNull
+namespace gi {
+
+// headless backend. textures and buffers are blocks of host memory.
+// the cost of a real device is simulated by NullDeviceSettings: latency per mapBuffer() and transfer time by bandwidth.
+class GraphicsInterfaceNull : public GraphicsInterface
+{
+public:
+    GraphicsInterfaceNull(void *device);
+    ~GraphicsInterfaceNull() override;
+    void release() override;
+
+    void* getDevicePtr() override;
+    DeviceType getDeviceType() override;
+    void sync() override;
+
+    Result createTexture2D(void **dst_tex, int width, int height, TextureFormat format, const void *data, ResourceFlags flags) override;
+    void   releaseTexture2D(void *tex) override;
+    Result readTexture2D(void *dst, size_t read_size, void *src_tex, int width, int height, TextureFormat format) override;
+    Result writeTexture2D(void *dst_tex, int width, int height, TextureFormat format, const void *src, size_t write_size) override;
+
+    Result createBuffer(void **dst_buf, size_t size, BufferType type, const void *data, ResourceFlags flags) override;
+    void   releaseBuffer(void *buf) override;
+    Result mapBuffer(MapContext& ctx) override;
+    Result unmapBuffer(MapContext& ctx) override;
+
+    Result beginUpload(UploadContext& ctx) override;
+    Result endUpload(UploadContext& ctx) override;
+    void   fenceUploads() override;
+
+private:
+    struct Resource
+    {
+        std::vector<char> data;
+        int width = 0, height = 0; // textures only
+    };
+
+    void simulateLatency();
+    void simulateTransfer(size_t size);
+
+    NullDeviceSettings m_settings;
+    std::vector<char> m_upload_ring;
+    size_t m_upload_head = 0;
+    size_t m_upload_used = 0; // since the last fenceUploads()
+};
+
+
+GraphicsInterface* CreateGraphicsInterfaceNull(void *device)
+{
+    return new GraphicsInterfaceNull(device);
+}
+
+
+void* GraphicsInterfaceNull::getDevicePtr() { return nullptr; }
+DeviceType GraphicsInterfaceNull::getDeviceType() { return DeviceType::Null; }
+
+GraphicsInterfaceNull::GraphicsInterfaceNull(void *device)
+{
+    if (device) {
+        m_settings = *(const NullDeviceSettings*)device;
+    }
+    if (m_settings.upload_ring) {
+        m_upload_ring.resize(64 * 1024 * 1024);
+    }
+}
+
+GraphicsInterfaceNull::~GraphicsInterfaceNull()
+{
+}
+
+void GraphicsInterfaceNull::release()
+{
+    delete this;
+}
+
+void GraphicsInterfaceNull::sync()
+{
+}
+
+void GraphicsInterfaceNull::simulateLatency()
+{
+    if (m_settings.map_latency_ms > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(m_settings.map_latency_ms));
+    }
+}
+
+void GraphicsInterfaceNull::simulateTransfer(size_t size)
+{
+    if (m_settings.bandwidth_gb > 0.0) {
+        double sec = (double)size / (m_settings.bandwidth_gb * 1024.0 * 1024.0 * 1024.0);
+        std::this_thread::sleep_for(std::chrono::duration<double>(sec));
+    }
+}
+
+
+Result GraphicsInterfaceNull::createTexture2D(void **dst_tex, int width, int height, TextureFormat format, const void *data, ResourceFlags /*flags*/)
+{
+    if (!dst_tex) { return Result::InvalidParameter; }
+
+    auto *tex = new Resource();
+    tex->width = width;
+    tex->height = height;
+    tex->data.resize((size_t)width * height * GetTexelSize(format));
+    if (data) {
+        memcpy(tex->data.data(), data, tex->data.size());
+    }
+    *dst_tex = tex;
+    return Result::OK;
+}
+
+void GraphicsInterfaceNull::releaseTexture2D(void *tex)
+{
+    delete (Resource*)tex;
+}
+
+Result GraphicsInterfaceNull::readTexture2D(void *dst, size_t read_size, void *src_tex, int /*width*/, int /*height*/, TextureFormat /*format*/)
+{
+    if (!dst || !src_tex) { return Result::InvalidParameter; }
+
+    auto *tex = (Resource*)src_tex;
+    simulateLatency();
+    simulateTransfer(read_size);
+    memcpy(dst, tex->data.data(), std::min<size_t>(read_size, tex->data.size()));
+    return Result::OK;
+}
+
+Result GraphicsInterfaceNull::writeTexture2D(void *dst_tex, int /*width*/, int /*height*/, TextureFormat /*format*/, const void *src, size_t write_size)
+{
+    if (!dst_tex || !src) { return Result::InvalidParameter; }
+
+    auto *tex = (Resource*)dst_tex;
+    simulateTransfer(write_size);
+    memcpy(tex->data.data(), src, std::min<size_t>(write_size, tex->data.size()));
+    return Result::OK;
+}
+
+
+Result GraphicsInterfaceNull::createBuffer(void **dst_buf, size_t size, BufferType /*type*/, const void *data, ResourceFlags /*flags*/)
+{
+    if (!dst_buf) { return Result::InvalidParameter; }
+
+    auto *buf = new Resource();
+    buf->data.resize(size);
+    if (data) {
+        memcpy(buf->data.data(), data, size);
+    }
+    *dst_buf = buf;
+    return Result::OK;
+}
+
+void GraphicsInterfaceNull::releaseBuffer(void *buf)
+{
+    delete (Resource*)buf;
+}
+
+Result GraphicsInterfaceNull::mapBuffer(MapContext& ctx)
+{
+    if (!ctx.resource) { return Result::InvalidParameter; }
+    if (ctx.mode != MapMode::Read && ctx.mode != MapMode::Write) { return Result::InvalidParameter; }
+
+    auto *buf = (Resource*)ctx.resource;
+    simulateLatency();
+    if (ctx.mode == MapMode::Read) {
+        simulateTransfer(buf->data.size());
+    }
+    ctx.data_ptr = buf->data.data();
+    ctx.size = (unsigned int)buf->data.size();
+    ctx.keeps_contents = true;
+    return Result::OK;
+}
+
+Result GraphicsInterfaceNull::unmapBuffer(MapContext& ctx)
+{
+    if (!ctx.resource || !ctx.data_ptr) { return Result::InvalidParameter; }
+
+    auto *buf = (Resource*)ctx.resource;
+    if (ctx.mode == MapMode::Write) {
+        simulateTransfer(ctx.written_size ? std::min<size_t>(ctx.written_size, buf->data.size()) : buf->data.size());
+    }
+    ctx.data_ptr = nullptr;
+    return Result::OK;
+}
+
+
+Result GraphicsInterfaceNull::beginUpload(UploadContext& ctx)
+{
+    if (m_upload_ring.empty()) { return Result::NotAvailable; }
+    if (!ctx.resource || ctx.size == 0) { return Result::InvalidParameter; }
+    if (ctx.size > m_upload_ring.size()) { return Result::OutOfMemory; }
+
+    // copies are done on endUpload(), so everything is free again after fenceUploads().
+    // until then allocations must not overlap.
+    size_t size = (ctx.size + 63) & ~(size_t)63;
+    size_t skip = m_upload_head + size > m_upload_ring.size() ? m_upload_ring.size() - m_upload_head : 0;
+    if (m_upload_used + skip + size > m_upload_ring.size()) { return Result::OutOfMemory; }
+
+    if (skip) { m_upload_head = 0; }
+    ctx.ring_offset = m_upload_head;
+    ctx.data_ptr = &m_upload_ring[m_upload_head];
+    m_upload_head = (m_upload_head + size) % m_upload_ring.size();
+    m_upload_used += skip + size;
+    return Result::OK;
+}
+
+Result GraphicsInterfaceNull::endUpload(UploadContext& ctx)
+{
+    if (!ctx.resource || !ctx.data_ptr) { return Result::InvalidParameter; }
+
+    auto *buf = (Resource*)ctx.resource;
+    if (ctx.dst_offset + ctx.size > buf->data.size()) {
+        // the slot is given up. nothing must be written to it anymore
+        ctx.data_ptr = nullptr;
+        return Result::InvalidParameter;
+    }
+
+    simulateTransfer(ctx.size);
+    memcpy(&buf->data[ctx.dst_offset], &m_upload_ring[ctx.ring_offset], ctx.size);
+    ctx.data_ptr = nullptr;
+    return Result::OK;
+}
+
+void GraphicsInterfaceNull::fenceUploads()
+{
+    m_upload_used = 0;
+}
+
+} // namespace gi
+#endif // giSupportNull
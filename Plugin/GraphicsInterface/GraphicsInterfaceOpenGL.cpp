@@ -19,6 +19,12 @@
     static PFNGLBUFFERDATAPROC      _glBufferData;
     static PFNGLMAPBUFFERPROC       _glMapBuffer;
     static PFNGLUNMAPBUFFERPROC     _glUnmapBuffer;
+    static PFNGLBUFFERSTORAGEPROC   _glBufferStorage;
+    static PFNGLMAPBUFFERRANGEPROC  _glMapBufferRange;
+    static PFNGLCOPYBUFFERSUBDATAPROC _glCopyBufferSubData;
+    static PFNGLFENCESYNCPROC       _glFenceSync;
+    static PFNGLCLIENTWAITSYNCPROC  _glClientWaitSync;
+    static PFNGLDELETESYNCPROC      _glDeleteSync;
 #else
     #define _glGenBuffers    glGenBuffers
     #define _glDeleteBuffers glDeleteBuffers
@@ -26,6 +32,12 @@
     #define _glBufferData    glBufferData
     #define _glMapBuffer     glMapBuffer
     #define _glUnmapBuffer   glUnmapBuffer
+    #define _glBufferStorage glBufferStorage
+    #define _glMapBufferRange glMapBufferRange
+    #define _glCopyBufferSubData glCopyBufferSubData
+    #define _glFenceSync     glFenceSync
+    #define _glClientWaitSync glClientWaitSync
+    #define _glDeleteSync    glDeleteSync
 #endif // _WIN32
 
 static void InitializeOpenGL()
@@ -38,6 +50,12 @@ static void InitializeOpenGL()
     Import(glBufferData);
     Import(glMapBuffer);
     Import(glUnmapBuffer);
+    Import(glBufferStorage);
+    Import(glMapBufferRange);
+    Import(glCopyBufferSubData);
+    Import(glFenceSync);
+    Import(glClientWaitSync);
+    Import(glDeleteSync);
 #undef Import
 #else
     glewInit();
@@ -46,6 +64,126 @@ static void InitializeOpenGL()
 
 namespace gi {
 
+// persistently mapped upload ring (GL 4.4 or ARB_buffer_storage).
+// allocations are FIFO. bytes used = [tail, head) in ring order, and each fence releases the bytes allocated before it.
+class UploadRingOpenGL
+{
+public:
+    UploadRingOpenGL(size_t size);
+    ~UploadRingOpenGL();
+    bool valid() const;
+
+    // return offset in the ring or npos. wait the GPU if the ring is full.
+    size_t allocate(size_t size);
+    void* getData(size_t offset);
+    GLuint getBuffer() const;
+    void fence();
+
+    static const size_t npos = ~(size_t)0;
+
+private:
+    struct Fence
+    {
+        GLsync sync;
+        size_t size;
+    };
+
+    void retire(bool wait);
+
+    GLuint m_buf = 0;
+    char *m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_head = 0;
+    size_t m_used = 0;      // bytes not yet passed by the GPU, including unfenced ones
+    size_t m_unfenced = 0;
+    std::deque<Fence> m_fences;
+};
+
+UploadRingOpenGL::UploadRingOpenGL(size_t size)
+    : m_size(size)
+{
+    if (!_glBufferStorage || !_glMapBufferRange || !_glFenceSync) { return; }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    _glGenBuffers(1, &m_buf);
+    _glBindBuffer(GL_COPY_READ_BUFFER, m_buf);
+    _glBufferStorage(GL_COPY_READ_BUFFER, m_size, nullptr, flags);
+    m_data = (char*)_glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_size, flags);
+    _glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if (!m_data) {
+        giLogError("UploadRingOpenGL: failed to map upload ring\n");
+        _glDeleteBuffers(1, &m_buf);
+        m_buf = 0;
+    }
+}
+
+UploadRingOpenGL::~UploadRingOpenGL()
+{
+    for (auto& f : m_fences) {
+        _glDeleteSync(f.sync);
+    }
+    if (m_buf) {
+        _glBindBuffer(GL_COPY_READ_BUFFER, m_buf);
+        _glUnmapBuffer(GL_COPY_READ_BUFFER);
+        _glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        _glDeleteBuffers(1, &m_buf);
+    }
+}
+
+bool UploadRingOpenGL::valid() const { return m_data != nullptr; }
+void* UploadRingOpenGL::getData(size_t offset) { return m_data + offset; }
+GLuint UploadRingOpenGL::getBuffer() const { return m_buf; }
+
+void UploadRingOpenGL::retire(bool wait)
+{
+    while (!m_fences.empty()) {
+        auto& f = m_fences.front();
+        GLuint64 timeout = wait ? ~(GLuint64)0 : 0;
+        auto r = _glClientWaitSync(f.sync, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+        if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED) { break; }
+
+        _glDeleteSync(f.sync);
+        m_used -= f.size;
+        m_fences.pop_front();
+        if (wait) { break; }
+    }
+}
+
+size_t UploadRingOpenGL::allocate(size_t size)
+{
+    // keep allocations aligned for SIMD stores
+    const size_t align = 64;
+    size = (size + align - 1) & ~(align - 1);
+    if (size > m_size) { return npos; }
+
+    retire(false);
+    for (;;) {
+        // skip the end of the ring if the allocation doesn't fit there
+        size_t skip = m_head + size > m_size ? m_size - m_head : 0;
+        if (m_used + skip + size <= m_size) {
+            if (skip) { m_head = 0; }
+            size_t ret = m_head;
+            m_head = (m_head + size) % m_size;
+            m_used += skip + size;
+            m_unfenced += skip + size;
+            return ret;
+        }
+        // the rest is allocated in this frame. can't wait for it
+        size_t num_fences = m_fences.size();
+        if (num_fences == 0) { return npos; }
+        retire(true);
+        if (m_fences.size() == num_fences) { return npos; }
+    }
+}
+
+void UploadRingOpenGL::fence()
+{
+    if (m_unfenced == 0) { return; }
+    m_fences.push_back({ _glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_unfenced });
+    m_unfenced = 0;
+}
+
+
 class GraphicsInterfaceOpenGL : public GraphicsInterface
 {
 public:
@@ -66,8 +204,18 @@ public:
     void   releaseBuffer(void *buf) override;
     Result mapBuffer(MapContext& ctx) override;
     Result unmapBuffer(MapContext& ctx) override;
+
+    Result beginUpload(UploadContext& ctx) override;
+    Result endUpload(UploadContext& ctx) override;
+    void   fenceUploads() override;
+
+private:
+    std::unique_ptr<UploadRingOpenGL> m_upload_ring;
+    bool m_upload_ring_failed = false;
 };
 
+static const size_t g_upload_ring_size = 64 * 1024 * 1024;
+
 
 GraphicsInterface* CreateGraphicsInterfaceOpenGL(void *device)
 {
@@ -272,6 +420,8 @@ Result GraphicsInterfaceOpenGL::mapBuffer(MapContext& ctx)
     if (!ctx.data_ptr) {
         ret = GetGLError();
     }
+    // glMapBuffer() doesn't invalidate the buffer
+    ctx.keeps_contents = ctx.data_ptr != nullptr;
     return ret;
 }
 
@@ -289,5 +439,47 @@ Result GraphicsInterfaceOpenGL::unmapBuffer(MapContext& ctx)
     return ret;
 }
 
+Result GraphicsInterfaceOpenGL::beginUpload(UploadContext& ctx)
+{
+    if (!ctx.resource || ctx.size == 0) { return Result::InvalidParameter; }
+
+    if (!m_upload_ring && !m_upload_ring_failed) {
+        m_upload_ring.reset(new UploadRingOpenGL(g_upload_ring_size));
+        if (!m_upload_ring->valid()) {
+            m_upload_ring.reset();
+            m_upload_ring_failed = true;
+        }
+    }
+    if (!m_upload_ring) { return Result::NotAvailable; }
+
+    auto offset = m_upload_ring->allocate(ctx.size);
+    if (offset == UploadRingOpenGL::npos) { return Result::OutOfMemory; }
+
+    ctx.ring_offset = offset;
+    ctx.data_ptr = m_upload_ring->getData(offset);
+    return Result::OK;
+}
+
+Result GraphicsInterfaceOpenGL::endUpload(UploadContext& ctx)
+{
+    if (!m_upload_ring || !ctx.resource || !ctx.data_ptr) { return Result::InvalidParameter; }
+
+    // the ring is coherent. writes are visible to commands issued after them
+    _glBindBuffer(GL_COPY_READ_BUFFER, m_upload_ring->getBuffer());
+    _glBindBuffer(GL_COPY_WRITE_BUFFER, (GLuint)(size_t)ctx.resource);
+    _glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, ctx.ring_offset, ctx.dst_offset, ctx.size);
+    _glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    ctx.data_ptr = nullptr;
+    return GetGLError();
+}
+
+void GraphicsInterfaceOpenGL::fenceUploads()
+{
+    if (m_upload_ring) {
+        m_upload_ring->fence();
+    }
+}
+
 } // namespace gi
 #endif // giSupportOpenGL
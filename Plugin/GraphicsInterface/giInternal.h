@@ -14,6 +14,7 @@
 #else
     #define giSupportOpenGL
 #endif
+#define giSupportNull
 
 #include "GraphicsInterface.h"
 
@@ -25,6 +26,7 @@ GraphicsInterface* CreateGraphicsInterfaceD3D11(void *device);
 GraphicsInterface* CreateGraphicsInterfaceD3D12(void *device);
 GraphicsInterface* CreateGraphicsInterfaceOpenGL(void *device);
 GraphicsInterface* CreateGraphicsInterfaceVulkan(void *device);
+GraphicsInterface* CreateGraphicsInterfaceNull(void *device);
 
 
 // i.e:
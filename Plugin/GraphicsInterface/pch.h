@@ -4,10 +4,13 @@
 #include <cstdint>
 #include <array>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <map>
 #include <algorithm>
 #include <functional>
 #include <thread>
+#include <chrono>
 #include <mutex>
 
 #ifdef _WIN32
@@ -2,6 +2,11 @@
 #include "MeshUtils.h"
 #include "mikktspace.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define muEnableStreamingStore
+    #include <emmintrin.h>
+#endif
+
 namespace mu {
 
 void InvertX_Generic(float3 *dst, size_t num)
@@ -24,6 +29,139 @@ void Scale_Generic(float3 *dst, float s, size_t num)
     }
 }
 
+void MulCopy_Generic(float3 *dst, const float3 *src, const float3& s, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = { src[i].x * s.x, src[i].y * s.y, src[i].z * s.z };
+    }
+}
+void MulCopy_Generic(float4 *dst, const float4 *src, const float4& s, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = { src[i].x * s.x, src[i].y * s.y, src[i].z * s.z, src[i].w * s.w };
+    }
+}
+
+void ReverseWinding_Generic(int *dst, const int *src, const int *counts, size_t num_counts)
+{
+    size_t i = 0;
+    for (size_t fi = 0; fi < num_counts; ++fi) {
+        int ngon = counts[fi];
+        for (int ni = 0; ni < ngon; ++ni) {
+            dst[i + ni] = src[i + (ngon - ni - 1)];
+        }
+        i += ngon;
+    }
+}
+
+void UnpackWeights_Generic(float *dst_weights, int *dst_indices, const void *src_, size_t num_points, int num_weights)
+{
+    // weights and indices have the same size. copy them as raw 32 bit words.
+    auto *src = (const int*)src_;
+    auto *dw = (int*)dst_weights;
+    for (size_t pi = 0; pi < num_points; ++pi) {
+        const int *s = src + pi * num_weights * 2;
+        size_t d = pi * num_weights;
+        for (int wi = 0; wi < num_weights; ++wi) {
+            dw[d + wi] = s[wi];
+            dst_indices[d + wi] = s[num_weights + wi];
+        }
+    }
+}
+
+void Lerp_Generic(float *dst, const float *a, const float *b, size_t num, float w)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = a[i] + (b[i] - a[i]) * w;
+    }
+}
+
+static inline uint16_t FloatToHalf1(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, 4);
+    uint32_t sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+
+    if (x >= 0x7f800000) { return (uint16_t)(sign | 0x7c00 | (x > 0x7f800000 ? 0x200 : 0)); } // inf & nan
+    if (x >= 0x477ff000) { return (uint16_t)(sign | 0x7c00); } // overflow
+    if (x < 0x38800000) {
+        // subnormal. round to nearest even.
+        if (x < 0x33000000) { return (uint16_t)sign; }
+        uint32_t e = x >> 23;
+        uint32_t m = (x & 0x7fffff) | 0x800000;
+        uint32_t shift = 126 - e;
+        uint32_t r = m >> shift;
+        uint32_t rem = m & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (r & 1))) { ++r; }
+        return (uint16_t)(sign | r);
+    }
+
+    // normal. rebias exponent and round to nearest even.
+    uint32_t r = (x - 0x38000000) >> 13;
+    uint32_t rem = x & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (r & 1))) { ++r; }
+    return (uint16_t)(sign | r);
+}
+
+static inline float HalfToFloat1(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t e = (h >> 10) & 0x1f;
+    uint32_t m = h & 0x3ff;
+    uint32_t x;
+    if (e == 0) {
+        if (m == 0) {
+            x = sign;
+        }
+        else {
+            // subnormal. normalize.
+            e = 113;
+            while ((m & 0x400) == 0) { m <<= 1; --e; }
+            x = sign | (e << 23) | ((m & 0x3ff) << 13);
+        }
+    }
+    else if (e == 31) {
+        x = sign | 0x7f800000 | (m << 13);
+    }
+    else {
+        x = sign | ((e + 112) << 23) | (m << 13);
+    }
+
+    float ret;
+    memcpy(&ret, &x, 4);
+    return ret;
+}
+
+void FloatToHalf_Generic(uint16_t *dst, const float *src, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = FloatToHalf1(src[i]);
+    }
+}
+
+void HalfToFloat_Generic(float *dst, const uint16_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = HalfToFloat1(src[i]);
+    }
+}
+
+void DoubleToFloat_Generic(float *dst, const double *src, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = (float)src[i];
+    }
+}
+
+void FloatToDouble_Generic(double *dst, const float *src, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = (double)src[i];
+    }
+}
+
 void ComputeBounds_Generic(const float3 *p, size_t num, float3& omin, float3& omax)
 {
     if (num == 0) { return; }
@@ -150,32 +288,197 @@ bool CalculateTangents(
     return genTangSpaceDefault(&tctx) != 0;
 }
 
-template<class VertexT> static inline void InterleaveImpl(VertexT *dst, const typename VertexT::source_t& src, size_t i);
+// compile time versions of GetVertexAttributeSize() / GetVertexAttributeOffset() for the kernels.
+// VS2013 doesn't support constexpr, so these are template metafunctions.
+template<int Attr>
+struct VertexAttributeSize
+{
+    static const size_t value =
+        Attr == VA_Points || Attr == VA_Normals ? sizeof(float3) :
+        Attr == VA_UVs || Attr == VA_UV2 ? sizeof(float2) :
+        Attr == VA_Tangents || Attr == VA_Colors ? sizeof(float4) :
+        Attr == VA_Weights4 ? sizeof(weights4) : 0;
+};
+
+template<int Attrs, int Attr, int Bit = 1, bool End = (Bit >= Attr)>
+struct VertexAttributeOffset
+{
+    static const size_t value =
+        ((Attrs & Bit) ? VertexAttributeSize<Bit>::value : 0) + VertexAttributeOffset<Attrs, Attr, (Bit << 1)>::value;
+};
+template<int Attrs, int Attr, int Bit>
+struct VertexAttributeOffset<Attrs, Attr, Bit, true>
+{
+    static const size_t value = 0;
+};
+
+template<int Attrs, int Attr, class T>
+static inline void InterleaveAttribute(char *dst, const T *src, size_t i)
+{
+    if (Attrs & Attr) {
+        const size_t offset = VertexAttributeOffset<Attrs, Attr>::value;
+        *(T*)(dst + offset) = src[i];
+    }
+}
+
+template<int Attrs>
+static inline void InterleaveVertex(char *dst, const VertexSource& src, size_t i)
+{
+    InterleaveAttribute<Attrs, VA_Points>(dst, src.points, i);
+    InterleaveAttribute<Attrs, VA_Normals>(dst, src.normals, i);
+    InterleaveAttribute<Attrs, VA_UVs>(dst, src.uvs, i);
+    InterleaveAttribute<Attrs, VA_Tangents>(dst, src.tangents, i);
+    InterleaveAttribute<Attrs, VA_Colors>(dst, src.colors, i);
+    InterleaveAttribute<Attrs, VA_UV2>(dst, src.uv2, i);
+    InterleaveAttribute<Attrs, VA_Weights4>(dst, src.weights, i);
+}
+
+template<int Attrs>
+static void InterleaveKernel(void *dst, const VertexSource& src, size_t num)
+{
+    const size_t stride = VertexAttributeOffset<Attrs, VA_End>::value;
+    auto *d = (char*)dst;
+    for (size_t i = 0; i < num; ++i) {
+        InterleaveVertex<Attrs>(d + stride * i, src, i);
+    }
+}
+
+template<int Attrs>
+static void InterleaveStreamKernel(void *dst, const VertexSource& src, size_t num)
+{
+    const size_t stride = VertexAttributeOffset<Attrs, VA_End>::value;
+    auto *d = (char*)dst;
+    size_t i = 0;
+#ifdef muEnableStreamingStore
+    // interleave a chunk in cache and stream it out by 16 byte blocks, so that write-combined memory is written in
+    // full lines and nothing is read back. all attribute sizes are multiple of 4, so 16 vertices are multiple of 16 byte.
+    if ((size_t)dst % 16 == 0 && stride > 0) {
+        const size_t chunk_size = 16;
+        const size_t num_blocks = stride * chunk_size / 16;
+        __m128i chunk_blocks[num_blocks > 0 ? num_blocks : 1]; // aligned by the type
+        auto *chunk = (char*)chunk_blocks;
+        for (; i + chunk_size <= num; i += chunk_size) {
+            for (size_t ci = 0; ci < chunk_size; ++ci) {
+                InterleaveVertex<Attrs>(chunk + stride * ci, src, i + ci);
+            }
+            auto *s = (const __m128i*)chunk;
+            auto *db = (__m128i*)(d + stride * i);
+            for (size_t bi = 0; bi < num_blocks; ++bi) {
+                _mm_stream_si128(db + bi, _mm_load_si128(s + bi));
+            }
+        }
+        _mm_sfence();
+    }
+#endif
+    for (; i < num; ++i) {
+        InterleaveVertex<Attrs>(d + stride * i, src, i);
+    }
+}
+
+// kernels for all combinations of attributes. indexed by VertexLayout::attributes.
+using InterleaveFunc = void(*)(void *dst, const VertexSource& src, size_t num);
+
+// std::index_sequence is C++14
+template<int... I> struct IndexSequence {};
+template<int N, int... I> struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+template<int... I> struct MakeIndexSequence<0, I...> { typedef IndexSequence<I...> type; };
+
+template<int... Attrs>
+static const InterleaveFunc* GetInterleaveKernels(IndexSequence<Attrs...>)
+{
+    static const InterleaveFunc s_kernels[] = { &InterleaveKernel<Attrs>... };
+    return s_kernels;
+}
+template<int... Attrs>
+static const InterleaveFunc* GetInterleaveStreamKernels(IndexSequence<Attrs...>)
+{
+    static const InterleaveFunc s_kernels[] = { &InterleaveStreamKernel<Attrs>... };
+    return s_kernels;
+}
+
+void Interleave_Generic(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num)
+{
+    GetInterleaveKernels(MakeIndexSequence<VA_End>::type())[layout.attributes](dst, src, num);
+}
 
-template<> inline void InterleaveImpl(vertex_v3n3 *dst, const vertex_v3n3::source_t& src, size_t i)
+void InterleaveStream(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num)
 {
-    dst[i].p = src.points[i];
-    dst[i].n = src.normals[i];
+    GetInterleaveStreamKernels(MakeIndexSequence<VA_End>::type())[layout.attributes](dst, src, num);
 }
-template<> inline void InterleaveImpl(vertex_v3n3u2 *dst, const vertex_v3n3u2::source_t& src, size_t i)
+
+void InterleavePartial(void *dst, const VertexLayout& layout, int attributes, const VertexSource& src, size_t num)
+{
+    auto *d = (char*)dst;
+    size_t stride = layout.getStride();
+    attributes &= layout.attributes;
+    if (attributes & VA_Points)   { StridedCopy(d + layout.getOffset(VA_Points), stride, src.points, num); }
+    if (attributes & VA_Normals)  { StridedCopy(d + layout.getOffset(VA_Normals), stride, src.normals, num); }
+    if (attributes & VA_UVs)      { StridedCopy(d + layout.getOffset(VA_UVs), stride, src.uvs, num); }
+    if (attributes & VA_Tangents) { StridedCopy(d + layout.getOffset(VA_Tangents), stride, src.tangents, num); }
+    if (attributes & VA_Colors)   { StridedCopy(d + layout.getOffset(VA_Colors), stride, src.colors, num); }
+    if (attributes & VA_UV2)      { StridedCopy(d + layout.getOffset(VA_UV2), stride, src.uv2, num); }
+    if (attributes & VA_Weights4) { StridedCopy(d + layout.getOffset(VA_Weights4), stride, src.weights, num); }
+}
+
+static inline VertexSource ToVertexSource(const vertex_v3n3::source_t& src)
 {
-    dst[i].p = src.points[i];
-    dst[i].n = src.normals[i];
-    dst[i].u = src.uvs[i];
+    VertexSource ret;
+    ret.points = src.points;
+    ret.normals = src.normals;
+    return ret;
 }
-template<> inline void InterleaveImpl(vertex_v3n3u2t4 *dst, const vertex_v3n3u2t4::source_t& src, size_t i)
+static inline VertexSource ToVertexSource(const vertex_v3n3u2::source_t& src)
 {
-    dst[i].p = src.points[i];
-    dst[i].n = src.normals[i];
-    dst[i].u = src.uvs[i];
-    dst[i].t = src.tangents[i];
+    VertexSource ret;
+    ret.points = src.points;
+    ret.normals = src.normals;
+    ret.uvs = src.uvs;
+    return ret;
+}
+static inline VertexSource ToVertexSource(const vertex_v3n3u2t4::source_t& src)
+{
+    VertexSource ret;
+    ret.points = src.points;
+    ret.normals = src.normals;
+    ret.uvs = src.uvs;
+    ret.tangents = src.tangents;
+    return ret;
 }
 
 template<class VertexT>
-void Interleave_Generic(VertexT *dst, const typename VertexT::source_t& src, size_t num)
+void InterleaveStream(VertexT *dst, const typename VertexT::source_t& src, size_t num)
+{
+    InterleaveStream(dst, VertexLayout(VertexT::attributes), ToVertexSource(src), num);
+}
+
+void Int32ToUInt16(uint16_t *dst, const int *src, size_t num)
 {
     for (size_t i = 0; i < num; ++i) {
-        InterleaveImpl(dst, src, i);
+        dst[i] = (uint16_t)src[i];
+    }
+}
+
+void Int32ToUInt16Stream(uint16_t *dst, const int *src, size_t num)
+{
+    size_t i = 0;
+#ifdef muEnableStreamingStore
+    if ((size_t)dst % 2 == 0) {
+        for (; i < num && (size_t)(dst + i) % 16 != 0; ++i) {
+            dst[i] = (uint16_t)src[i];
+        }
+        for (; i + 8 <= num; i += 8) {
+            // sign-extend lower 16 bits so that _mm_packs_epi32() doesn't saturate. result is same as the cast.
+            __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 4));
+            a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+            b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+            _mm_stream_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+        }
+        _mm_sfence();
+    }
+#endif
+    for (; i < num; ++i) {
+        dst[i] = (uint16_t)src[i];
     }
 }
 
@@ -196,6 +499,68 @@ void Scale_ISPC(float3 *dst, float s, size_t num)
     ispc::ScaleF((float*)dst, s, (int)num * 3);
 }
 
+void MulCopy_ISPC(float3 *dst, const float3 *src, const float3& s, size_t num)
+{
+    ispc::MulCopyF3((ispc::float3*)dst, (const ispc::float3*)src, (const ispc::float3&)s, (int)num);
+}
+void MulCopy_ISPC(float4 *dst, const float4 *src, const float4& s, size_t num)
+{
+    ispc::MulCopyF4((ispc::float4*)dst, (const ispc::float4*)src, (const ispc::float4&)s, (int)num);
+}
+
+void ReverseWinding_ISPC(int *dst, const int *src, const int *counts, size_t num_counts)
+{
+    // runs of triangles go to the kernel. other faces are done one by one.
+    size_t i = 0;
+    size_t fi = 0;
+    while (fi < num_counts) {
+        size_t begin = fi;
+        while (fi < num_counts && counts[fi] == 3) { ++fi; }
+        if (fi > begin) {
+            int ntriangles = (int)(fi - begin);
+            ispc::ReverseWindingTriangles(dst + i, src + i, ntriangles);
+            i += ntriangles * 3;
+        }
+        if (fi < num_counts) {
+            int ngon = counts[fi++];
+            for (int ni = 0; ni < ngon; ++ni) {
+                dst[i + ni] = src[i + (ngon - ni - 1)];
+            }
+            i += ngon;
+        }
+    }
+}
+
+void UnpackWeights_ISPC(float *dst_weights, int *dst_indices, const void *src, size_t num_points, int num_weights)
+{
+    ispc::UnpackWeights(dst_weights, dst_indices, (const int*)src, (int)num_points, num_weights);
+}
+
+void Lerp_ISPC(float *dst, const float *a, const float *b, size_t num, float w)
+{
+    ispc::Lerp(dst, a, b, (int)num, w);
+}
+
+void FloatToHalf_ISPC(uint16_t *dst, const float *src, size_t num)
+{
+    ispc::FloatToHalf(dst, src, (int)num);
+}
+
+void HalfToFloat_ISPC(float *dst, const uint16_t *src, size_t num)
+{
+    ispc::HalfToFloat(dst, src, (int)num);
+}
+
+void DoubleToFloat_ISPC(float *dst, const double *src, size_t num)
+{
+    ispc::DoubleToFloat(dst, src, (int)num);
+}
+
+void FloatToDouble_ISPC(double *dst, const float *src, size_t num)
+{
+    ispc::FloatToDouble(dst, src, (int)num);
+}
+
 void ComputeBounds_ISPC(const float3 *p, size_t num, float3& omin, float3& omax)
 {
     if (num == 0) { return; }
@@ -207,6 +572,25 @@ void Normalize_ISPC(float3 *dst, size_t num)
     ispc::Normalize((ispc::float3*)dst, (int)num);
 }
 
+bool Interleave_ISPC(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num)
+{
+    switch (layout.attributes) {
+    case vertex_v3n3::attributes:
+        ispc::InterleaveV3N3((float*)dst, (const float*)src.points, (const float*)src.normals, (int)num);
+        return true;
+    case vertex_v3n3u2::attributes:
+        ispc::InterleaveV3N3U2((float*)dst, (const float*)src.points, (const float*)src.normals,
+            (const float*)src.uvs, (int)num);
+        return true;
+    case vertex_v3n3u2t4::attributes:
+        ispc::InterleaveV3N3U2T4((float*)dst, (const float*)src.points, (const float*)src.normals,
+            (const float*)src.uvs, (const float*)src.tangents, (int)num);
+        return true;
+    default:
+        return false;
+    }
+}
+
 void CalculateNormals_ISPC(float3 *dst, const float3 *p, const int *indices, size_t num_points, size_t num_indices)
 {
     memset(dst, 0, sizeof(float3)*num_points);
@@ -251,6 +635,50 @@ void Scale(float3 *dst, float s, size_t num)
     Forward(Scale, dst, s, num);
 }
 
+void MulCopy(float3 *dst, const float3 *src, const float3& s, size_t num)
+{
+    Forward(MulCopy, dst, src, s, num);
+}
+void MulCopy(float4 *dst, const float4 *src, const float4& s, size_t num)
+{
+    Forward(MulCopy, dst, src, s, num);
+}
+
+void ReverseWinding(int *dst, const int *src, const int *counts, size_t num_counts)
+{
+    Forward(ReverseWinding, dst, src, counts, num_counts);
+}
+
+void UnpackWeights(float *dst_weights, int *dst_indices, const void *src, size_t num_points, int num_weights)
+{
+    Forward(UnpackWeights, dst_weights, dst_indices, src, num_points, num_weights);
+}
+
+void Lerp(float *dst, const float *a, const float *b, size_t num, float w)
+{
+    Forward(Lerp, dst, a, b, num, w);
+}
+
+void FloatToHalf(uint16_t *dst, const float *src, size_t num)
+{
+    Forward(FloatToHalf, dst, src, num);
+}
+
+void HalfToFloat(float *dst, const uint16_t *src, size_t num)
+{
+    Forward(HalfToFloat, dst, src, num);
+}
+
+void DoubleToFloat(float *dst, const double *src, size_t num)
+{
+    Forward(DoubleToFloat, dst, src, num);
+}
+
+void FloatToDouble(double *dst, const float *src, size_t num)
+{
+    Forward(FloatToDouble, dst, src, num);
+}
+
 void ComputeBounds(const float3 *p, size_t num, float3& omin, float3& omax)
 {
     Forward(ComputeBounds, p, num, omin, omax);
@@ -269,14 +697,26 @@ void CalculateNormals(float3 *dst, const float3 *p, const int *indices, size_t n
     Forward(CalculateNormals, dst, p, indices, num_points, num_indices);
 }
 
+void Interleave(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num)
+{
+#ifdef muEnableISPC
+    // common layouts
+    if (Interleave_ISPC(dst, layout, src, num)) { return; }
+#endif
+    Interleave_Generic(dst, layout, src, num);
+}
+
 template<class VertexT>
 void Interleave(VertexT *dst, const typename VertexT::source_t& src, size_t num)
 {
-    Interleave_Generic(dst, src, num);
+    Interleave(dst, VertexLayout(VertexT::attributes), ToVertexSource(src), num);
 }
 template void Interleave(vertex_v3n3 *dst, const vertex_v3n3::source_t& src, size_t num);
 template void Interleave(vertex_v3n3u2 *dst, const vertex_v3n3u2::source_t& src, size_t num);
 template void Interleave(vertex_v3n3u2t4 *dst, const vertex_v3n3u2t4::source_t& src, size_t num);
+template void InterleaveStream(vertex_v3n3 *dst, const vertex_v3n3::source_t& src, size_t num);
+template void InterleaveStream(vertex_v3n3u2 *dst, const vertex_v3n3u2::source_t& src, size_t num);
+template void InterleaveStream(vertex_v3n3u2t4 *dst, const vertex_v3n3u2t4::source_t& src, size_t num);
 
 
 } // namespace mu
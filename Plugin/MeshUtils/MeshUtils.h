@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include "muVector.h"
 
 namespace mu {
@@ -8,6 +9,22 @@ namespace mu {
 void InvertX(float3 *dst, size_t num);
 void InvertX(float4 *dst, size_t num);
 void Scale(float3 *dst, float s, size_t num);
+// dst[i] = src[i] * s (component-wise). dst can be same as src.
+// e.g. s = { -scale, scale, scale } swaps handedness and scales in one pass.
+void MulCopy(float3 *dst, const float3 *src, const float3& s, size_t num);
+void MulCopy(float4 *dst, const float4 *src, const float4& s, size_t num);
+// reverse vertex order of each face. dst must not overlap src.
+void ReverseWinding(int *dst, const int *src, const int *counts, size_t num_counts);
+// src: num_points elements of { float weight[num_weights]; int indices[num_weights]; }
+// dst_weights, dst_indices: num_points * num_weights elements
+void UnpackWeights(float *dst_weights, int *dst_indices, const void *src, size_t num_points, int num_weights);
+// dst[i] = a[i] + (b[i] - a[i]) * w. dst can be same as a or b.
+void Lerp(float *dst, const float *a, const float *b, size_t num, float w);
+// half is IEEE 754 binary16 (same layout as pxr's half)
+void FloatToHalf(uint16_t *dst, const float *src, size_t num);
+void HalfToFloat(float *dst, const uint16_t *src, size_t num);
+void DoubleToFloat(float *dst, const double *src, size_t num);
+void FloatToDouble(double *dst, const float *src, size_t num);
 void ComputeBounds(const float3 *p, size_t num, float3& o_min, float3& o_max);
 void Normalize(float3 *dst, size_t num);
 void CalculateNormals(float3 *dst, const float3 *p, const int *indices, size_t num_points, size_t num_indices);
@@ -15,6 +32,75 @@ bool CalculateTangents(
     float4 *dst, const float3 *p, const float3 *n, const float2 *t,
     const int *counts, const int *offsets, const int *indices, size_t num_points, size_t num_faces);
 
+// same layout as usdi::Weights4
+struct weights4
+{
+    float weight[4];
+    int indices[4];
+};
+
+// attributes of interleaved vertices. bits are in the order the attributes are placed in a vertex.
+enum VertexAttribute
+{
+    VA_Points   = 0x01, // float3
+    VA_Normals  = 0x02, // float3
+    VA_UVs      = 0x04, // float2
+    VA_Tangents = 0x08, // float4
+    VA_Colors   = 0x10, // float4
+    VA_UV2      = 0x20, // float2
+    VA_Weights4 = 0x40, // weights4
+    VA_End      = 0x80,
+    VA_All      = VA_End - 1,
+};
+
+inline size_t GetVertexAttributeSize(int attr)
+{
+    return
+        attr == VA_Points || attr == VA_Normals ? sizeof(float3) :
+        attr == VA_UVs || attr == VA_UV2 ? sizeof(float2) :
+        attr == VA_Tangents || attr == VA_Colors ? sizeof(float4) :
+        attr == VA_Weights4 ? sizeof(weights4) : 0;
+}
+// sum of sizes of attributes placed before attr
+inline size_t GetVertexAttributeOffset(int attributes, int attr, int bit = 1)
+{
+    return bit >= attr ? 0 :
+        ((attributes & bit) ? GetVertexAttributeSize(bit) : 0) + GetVertexAttributeOffset(attributes, attr, bit << 1);
+}
+
+// describes interleaved vertices by a combination of VertexAttribute.
+// e.g. VertexLayout(VA_Points | VA_Normals | VA_UVs) is same as vertex_v3n3u2.
+struct VertexLayout
+{
+    int attributes;
+
+    VertexLayout(int attrs = 0) : attributes(attrs & VA_All) {}
+    bool   has(int attr) const { return (attributes & attr) == attr; }
+    size_t getStride() const { return GetVertexAttributeOffset(attributes, VA_End); }
+    size_t getOffset(int attr) const { return GetVertexAttributeOffset(attributes, attr); }
+    bool operator==(const VertexLayout& v) const { return attributes == v.attributes; }
+    bool operator!=(const VertexLayout& v) const { return attributes != v.attributes; }
+};
+
+// sources of interleaved vertices. attributes in the layout must not be null.
+struct VertexSource
+{
+    const float3    *points = nullptr;
+    const float3    *normals = nullptr;
+    const float2    *uvs = nullptr;
+    const float4    *tangents = nullptr;
+    const float4    *colors = nullptr;
+    const float2    *uv2 = nullptr;
+    const weights4  *weights = nullptr;
+};
+
+// interleave vertices of any layout. kernels are specialized for every combination of attributes at compile time.
+void Interleave(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num);
+// same as Interleave() but writes dst with non-temporal (streaming) stores. for mapped GPU memory.
+void InterleaveStream(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num);
+// update only some attributes of already interleaved vertices. other attributes in dst are kept.
+void InterleavePartial(void *dst, const VertexLayout& layout, int attributes, const VertexSource& src, size_t num);
+
 struct vertex_v3n3;
 struct vertex_v3n3_source;
 struct vertex_v3n3u2;
@@ -31,6 +117,7 @@ struct vertex_v3n3_source
 struct vertex_v3n3
 {
     using source_t = vertex_v3n3_source;
+    static const int attributes = VA_Points | VA_Normals;
     float3 p;
     float3 n;
 };
@@ -45,6 +132,7 @@ struct vertex_v3n3u2_source
 struct vertex_v3n3u2
 {
     using source_t = vertex_v3n3u2_source;
+    static const int attributes = VA_Points | VA_Normals | VA_UVs;
     float3 p;
     float3 n;
     float2 u;
@@ -61,6 +149,7 @@ struct vertex_v3n3u2t4_source
 struct vertex_v3n3u2t4
 {
     using source_t = vertex_v3n3u2t4_source;
+    static const int attributes = VA_Points | VA_Normals | VA_UVs | VA_Tangents;
     float3 p;
     float3 n;
     float2 u;
@@ -69,10 +158,22 @@ struct vertex_v3n3u2t4
 
 template<class VertexT>
 void Interleave(VertexT *dst, const typename VertexT::source_t& src, size_t num);
+// same as Interleave() but writes dst with non-temporal (streaming) stores. for mapped GPU memory.
+// dst doesn't need to be aligned, but it is fastest if 16 byte aligned.
+template<class VertexT>
+void InterleaveStream(VertexT *dst, const typename VertexT::source_t& src, size_t num);
+// dst[i] = (uint16_t)src[i]. e.g. 32 bit indices -> Unity's 16 bit indices.
+void Int32ToUInt16(uint16_t *dst, const int *src, size_t num);
+// same as Int32ToUInt16() but with streaming stores. for mapped GPU memory. dst is not in the cache after this.
+void Int32ToUInt16Stream(uint16_t *dst, const int *src, size_t num);
 
 template<class DataArray, class IndexArray>
 void CopyWithIndices(DataArray& dst, const DataArray& src, const IndexArray& indices, size_t beg, size_t end, bool expand);
 
+// write one attribute of interleaved vertices. dst points the attribute of the first vertex, stride is the vertex size.
+template<class T>
+void StridedCopy(void *dst, size_t stride, const T *src, size_t num);
+
 
 
 // ------------------------------------------------------------
@@ -86,6 +187,29 @@ void InvertX_ISPC(float4 *dst, size_t num);
 void Scale_Generic(float3 *dst, float s, size_t num);
 void Scale_ISPC(float3 *dst, float s, size_t num);
 
+void MulCopy_Generic(float3 *dst, const float3 *src, const float3& s, size_t num);
+void MulCopy_ISPC(float3 *dst, const float3 *src, const float3& s, size_t num);
+void MulCopy_Generic(float4 *dst, const float4 *src, const float4& s, size_t num);
+void MulCopy_ISPC(float4 *dst, const float4 *src, const float4& s, size_t num);
+
+void ReverseWinding_Generic(int *dst, const int *src, const int *counts, size_t num_counts);
+void ReverseWinding_ISPC(int *dst, const int *src, const int *counts, size_t num_counts);
+
+void UnpackWeights_Generic(float *dst_weights, int *dst_indices, const void *src, size_t num_points, int num_weights);
+void UnpackWeights_ISPC(float *dst_weights, int *dst_indices, const void *src, size_t num_points, int num_weights);
+
+void Lerp_Generic(float *dst, const float *a, const float *b, size_t num, float w);
+void Lerp_ISPC(float *dst, const float *a, const float *b, size_t num, float w);
+
+void FloatToHalf_Generic(uint16_t *dst, const float *src, size_t num);
+void FloatToHalf_ISPC(uint16_t *dst, const float *src, size_t num);
+void HalfToFloat_Generic(float *dst, const uint16_t *src, size_t num);
+void HalfToFloat_ISPC(float *dst, const uint16_t *src, size_t num);
+void DoubleToFloat_Generic(float *dst, const double *src, size_t num);
+void DoubleToFloat_ISPC(float *dst, const double *src, size_t num);
+void FloatToDouble_Generic(double *dst, const float *src, size_t num);
+void FloatToDouble_ISPC(double *dst, const float *src, size_t num);
+
 void ComputeBounds_Generic(const float3 *p, size_t num, float3& o_min, float3& o_max);
 void ComputeBounds_ISPC(const float3 *p, size_t num, float3& o_min, float3& o_max);
 
@@ -95,7 +219,9 @@ void Normalize_ISPC(float3 *dst, size_t num);
 void CalculateNormals_Generic(float3 *dst, const float3 *p, const int *indices, size_t num_points, size_t num_indices);
 void CalculateNormals_ISPC(float3 *dst, const float3 *p, const int *indices, size_t num_points, size_t num_indices);
 
-template<class VertexT> void Interleave_Generic(VertexT *dst, const typename VertexT::source_t& src, size_t num);
+void Interleave_Generic(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num);
+// only vertex_v3n3, vertex_v3n3u2 and vertex_v3n3u2t4 layouts. return false if the layout is not supported.
+bool Interleave_ISPC(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num);
 
 // ------------------------------------------------------------
 // impl
@@ -121,4 +247,14 @@ inline void CopyWithIndices(DataArray& dst, const DataArray& src, const IndexArr
     }
 }
 
+template<class T>
+inline void StridedCopy(void *dst, size_t stride, const T *src, size_t num)
+{
+    auto *d = (char*)dst;
+    for (size_t i = 0; i < num; ++i) {
+        *(T*)d = src[i];
+        d += stride;
+    }
+}
+
 } // namespace mu
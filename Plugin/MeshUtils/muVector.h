@@ -122,6 +122,11 @@ inline float dot(const float3& l, const float3& r)
     return l.x*r.x + l.y*r.y + l.z*r.z;
 }
 
+inline float length(const float3& l)
+{
+    return std::sqrt(dot(l, l));
+}
+
 inline float3 normalize(const float3& l)
 {
     float d = 1.0f / std::sqrt(dot(l, l));
@@ -2,3 +2,5 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <utility>
+#include <type_traits>
@@ -1,4 +1,6 @@
 #include <cstdio>
+#include <cstring>
+#include <cmath>
 #include <vector>
 #include <chrono>
 #include "MeshUtils/MeshUtils.h"
@@ -125,6 +127,533 @@ static void Test_Scale()
 }
 
 
+static void Test_MulCopy()
+{
+    auto data = GenerateTestData(NumTestData, 0.1f, 1.0f);
+    std::vector<float3> result1(data.size());
+    std::vector<float3> result2(data.size());
+    float3 s = { -2.0f, 2.0f, 2.0f };
+
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    bool result = false;
+
+    for (int i = 0; i < NumTry; ++i) {
+        auto start = now();
+        MulCopy_Generic(result1.data(), data.data(), s, data.size());
+        elapsed1 += now() - start;
+
+#ifdef muEnableISPC
+        start = now();
+        MulCopy_ISPC(result2.data(), data.data(), s, data.size());
+        elapsed2 += now() - start;
+#endif // muEnableISPC
+
+        result = near_equal(result1, result2);
+        if (!result) { break; }
+    }
+
+    printf("Test_MulCopy: %s\n", result ? "succeeded" : "failed");
+    printf("    MulCopy_Generic(): avg. %f ms\n", float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    MulCopy_ISPC(): avg. %f ms\n", float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+
+static void Test_ReverseWinding()
+{
+    // triangles with a quad every 64 faces
+    std::vector<int> counts;
+    size_t num_indices = 0;
+    while (num_indices < NumTestData) {
+        int ngon = counts.size() % 64 == 63 ? 4 : 3;
+        counts.push_back(ngon);
+        num_indices += ngon;
+    }
+    std::vector<int> indices(num_indices);
+    for (size_t i = 0; i < indices.size(); ++i) { indices[i] = (int)i; }
+    std::vector<int> result1(num_indices);
+    std::vector<int> result2(num_indices);
+
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    bool result = false;
+
+    for (int i = 0; i < NumTry; ++i) {
+        auto start = now();
+        ReverseWinding_Generic(result1.data(), indices.data(), counts.data(), counts.size());
+        elapsed1 += now() - start;
+
+#ifdef muEnableISPC
+        start = now();
+        ReverseWinding_ISPC(result2.data(), indices.data(), counts.data(), counts.size());
+        elapsed2 += now() - start;
+#endif // muEnableISPC
+
+        result = result1 == result2;
+        if (!result) { break; }
+    }
+
+    printf("Test_ReverseWinding: %s\n", result ? "succeeded" : "failed");
+    printf("    ReverseWinding_Generic(): avg. %f ms\n", float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    ReverseWinding_ISPC(): avg. %f ms\n", float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+
+static void Test_UnpackWeights()
+{
+    const size_t num_points = NumTestData / 4;
+    std::vector<usdi::Weights4> weights(num_points);
+    for (size_t i = 0; i < num_points; ++i) {
+        for (int wi = 0; wi < 4; ++wi) {
+            weights[i].weight[wi] = 0.25f * (wi + 1);
+            weights[i].indices[wi] = (int)(i + wi);
+        }
+    }
+    std::vector<float> weights1(num_points * 4), weights2(num_points * 4);
+    std::vector<int> indices1(num_points * 4), indices2(num_points * 4);
+
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    bool result = false;
+
+    for (int i = 0; i < NumTry; ++i) {
+        auto start = now();
+        UnpackWeights_Generic(weights1.data(), indices1.data(), weights.data(), num_points, 4);
+        elapsed1 += now() - start;
+
+#ifdef muEnableISPC
+        start = now();
+        UnpackWeights_ISPC(weights2.data(), indices2.data(), weights.data(), num_points, 4);
+        elapsed2 += now() - start;
+#endif // muEnableISPC
+
+        result = weights1 == weights2 && indices1 == indices2;
+        if (!result) { break; }
+    }
+
+    printf("Test_UnpackWeights: %s\n", result ? "succeeded" : "failed");
+    printf("    UnpackWeights_Generic(): avg. %f ms\n", float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    UnpackWeights_ISPC(): avg. %f ms\n", float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+
+static void Test_InterleaveStream()
+{
+    auto points = GenerateTestData(NumTestData / 4, 0.1f, 1.0f);
+    auto normals = GenerateTestData(NumTestData / 4, 0.2f, 1.0f);
+    std::vector<float2> uvs(points.size());
+    for (size_t i = 0; i < uvs.size(); ++i) { uvs[i] = { points[i].x, points[i].y }; }
+    std::vector<int> indices(points.size());
+    for (size_t i = 0; i < indices.size(); ++i) { indices[i] = (int)(i * 7); }
+
+    using vertex_t = vertex_v3n3u2;
+    vertex_t::source_t src = { points.data(), normals.data(), uvs.data() };
+    std::vector<vertex_t> tmp(points.size()), result1(points.size()), result2(points.size());
+    std::vector<uint16_t> indices1(indices.size()), indices2(indices.size());
+
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    bool result = false;
+
+    for (int i = 0; i < NumTry; ++i) {
+        // old path: interleave into a temporary buffer and copy
+        auto start = now();
+        Interleave(tmp.data(), src, tmp.size());
+        memcpy(result1.data(), tmp.data(), sizeof(vertex_t) * tmp.size());
+        Int32ToUInt16(indices1.data(), indices.data(), indices.size());
+        elapsed1 += now() - start;
+
+        start = now();
+        InterleaveStream(result2.data(), src, result2.size());
+        Int32ToUInt16Stream(indices2.data(), indices.data(), indices.size());
+        elapsed2 += now() - start;
+
+        result = memcmp(result1.data(), result2.data(), sizeof(vertex_t) * result1.size()) == 0 && indices1 == indices2;
+        if (!result) { break; }
+    }
+
+    printf("Test_InterleaveStream: %s\n", result ? "succeeded" : "failed");
+    printf("    Interleave() + memcpy: avg. %f ms\n", float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    InterleaveStream(): avg. %f ms\n", float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+
+static void Test_InterleaveLayout()
+{
+    auto points = GenerateTestData(NumTestData / 4, 0.1f, 1.0f);
+    auto normals = GenerateTestData(NumTestData / 4, 0.2f, 1.0f);
+    size_t num = points.size();
+    std::vector<float2> uvs(num), uv2(num);
+    std::vector<float4> tangents(num), colors(num);
+    std::vector<weights4> weights(num);
+    for (size_t i = 0; i < num; ++i) {
+        uvs[i] = { points[i].x, points[i].y };
+        uv2[i] = { normals[i].x, normals[i].y };
+        tangents[i] = { normals[i].x, normals[i].y, normals[i].z, 1.0f };
+        colors[i] = { points[i].x, points[i].y, points[i].z, 0.5f };
+        weights[i] = { { 0.4f, 0.3f, 0.2f, 0.1f }, { (int)i, (int)i + 1, (int)i + 2, (int)i + 3 } };
+    }
+
+    VertexSource src;
+    src.points = points.data();
+    src.normals = normals.data();
+    src.uvs = uvs.data();
+    src.tangents = tangents.data();
+    src.colors = colors.data();
+    src.uv2 = uv2.data();
+    src.weights = weights.data();
+
+    // all combinations: specialized kernels must match attribute-by-attribute copy
+    bool result = true;
+    std::vector<char> expected, result1, result2;
+    for (int attrs = 1; attrs <= VA_All && result; ++attrs) {
+        VertexLayout layout(attrs);
+        size_t size = layout.getStride() * num;
+        expected.assign(size, 0);
+        result1.assign(size, 0);
+        result2.assign(size, 0);
+        InterleavePartial(expected.data(), layout, VA_All, src, num);
+        Interleave(result1.data(), layout, src, num);
+        InterleaveStream(result2.data(), layout, src, num);
+        result = expected == result1 && expected == result2;
+    }
+
+    // common layout
+    VertexLayout layout(vertex_v3n3u2t4::attributes);
+    result1.resize(layout.getStride() * num);
+    result2.resize(layout.getStride() * num);
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    for (int i = 0; i < NumTry && result; ++i) {
+        auto start = now();
+        Interleave_Generic(result1.data(), layout, src, num);
+        elapsed1 += now() - start;
+
+#ifdef muEnableISPC
+        start = now();
+        Interleave_ISPC(result2.data(), layout, src, num);
+        elapsed2 += now() - start;
+#else
+        result2 = result1;
+#endif // muEnableISPC
+
+        result = result1 == result2;
+    }
+
+    printf("Test_InterleaveLayout: %s\n", result ? "succeeded" : "failed");
+    printf("    Interleave_Generic(): avg. %f ms\n", float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    Interleave_ISPC(): avg. %f ms\n", float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+
+static void Test_Lerp()
+{
+    auto data1 = GenerateTestData(NumTestData, 0.1f, 1.0f);
+    auto data2 = GenerateTestData(NumTestData, 0.2f, 2.0f);
+    std::vector<float3> result1(data1.size());
+    std::vector<float3> result2(data1.size());
+    auto w = 0.375f;
+
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    bool result = false;
+
+    for (int i = 0; i < NumTry; ++i) {
+        auto start = now();
+        Lerp_Generic((float*)result1.data(), (const float*)data1.data(), (const float*)data2.data(), data1.size() * 3, w);
+        elapsed1 += now() - start;
+
+#ifdef muEnableISPC
+        start = now();
+        Lerp_ISPC((float*)result2.data(), (const float*)data1.data(), (const float*)data2.data(), data1.size() * 3, w);
+        elapsed2 += now() - start;
+#endif // muEnableISPC
+
+        result = near_equal(result1, result2);
+        if (!result) { break; }
+    }
+
+    printf("Test_Lerp: %s\n", result ? "succeeded" : "failed");
+    printf("    Lerp_Generic(): avg. %f ms\n", float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    Lerp_ISPC(): avg. %f ms\n", float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+
+// baseline for conversion kernels: the path TConverterAttribute took before them.
+// TAssign() converted one vector at a time through constructors like GfVec3f(GfVec3h), and each component through GfHalf.
+// GfHalf converts half -> float by a 64K-entry table and float -> half by an out-of-line function. emulated here.
+// the emulation computes values arithmetically and doesn't share code with the kernels under test.
+struct half3 { uint16_t x, y, z; };
+struct double3 { double x, y, z; };
+
+static uint32_t FloatBits(float f) { uint32_t r; memcpy(&r, &f, 4); return r; }
+static float BitsToFloat(uint32_t b) { float r; memcpy(&r, &b, 4); return r; }
+
+static uint16_t TAssignHalf1(float f)
+{
+    uint16_t sign = (FloatBits(f) >> 16) & 0x8000;
+    if (std::isnan(f)) { return (uint16_t)(sign | 0x7e00); }
+    double a = std::fabs((double)f);
+    if (a < std::ldexp(1.0, -14)) {
+        // subnormal: units of 2^-24. nearbyint() rounds to nearest even. 0x400 is the smallest normal.
+        return (uint16_t)(sign | (uint16_t)std::nearbyint(a * std::ldexp(1.0, 24)));
+    }
+    if (std::isinf(f)) { return (uint16_t)(sign | 0x7c00); }
+
+    int e;
+    std::frexp(a, &e); // a = [0.5, 1) * 2^e
+    e -= 1;            // a = [1, 2) * 2^e
+    double m = std::nearbyint(a * std::ldexp(1.0, 10 - e)) - 1024.0;
+    if (m >= 1024.0) { m = 0.0; ++e; }
+    if (e + 15 >= 31) { return (uint16_t)(sign | 0x7c00); }
+    return (uint16_t)(sign | ((e + 15) << 10) | (uint16_t)m);
+}
+
+static float TAssignFloat1(uint16_t h)
+{
+    int e = (h >> 10) & 0x1f;
+    int m = h & 0x3ff;
+    double s = (h & 0x8000) ? -1.0 : 1.0;
+    if (e == 31) {
+        // inf, or NaN with the payload in the upper mantissa bits
+        return BitsToFloat(((uint32_t)(h & 0x8000) << 16) | 0x7f800000 | ((uint32_t)m << 13));
+    }
+    if (e == 0) { return (float)(s * std::ldexp((double)m, -24)); }
+    return (float)(s * std::ldexp(1024.0 + m, e - 25));
+}
+
+static const float* TAssignHalfTable()
+{
+    static std::vector<float> s_table;
+    if (s_table.empty()) {
+        s_table.resize(0x10000);
+        for (size_t i = 0; i < s_table.size(); ++i) { s_table[i] = TAssignFloat1((uint16_t)i); }
+    }
+    return s_table.data();
+}
+
+// known bit patterns: signed zeros, limits, subnormals, infinities, NaN and rounding ties
+static void Test_HalfKnownValues()
+{
+    struct FloatHalf { uint32_t f; uint16_t h; };
+    const FloatHalf to_half[] = {
+        { 0x00000000, 0x0000 }, { 0x80000000, 0x8000 }, { 0x3f800000, 0x3c00 }, { 0xc0000000, 0xc000 },
+        { 0x3dcccccd, 0x2e66 }, // 0.1
+        { 0x477fe000, 0x7bff }, // 65504: max
+        { 0x477fefff, 0x7bff }, // just below 65520: rounds down
+        { 0x477ff000, 0x7c00 }, // 65520: overflows to inf
+        { 0x7f800000, 0x7c00 }, { 0xff800000, 0xfc00 },
+        { 0x38800000, 0x0400 }, // 2^-14: min normal
+        { 0x387fc000, 0x03ff }, // max subnormal
+        { 0x33800000, 0x0001 }, // 2^-24: min subnormal
+        { 0x33000000, 0x0000 }, // 2^-25: tie, rounds to even (zero)
+        { 0x33400000, 0x0001 }, // 1.5 * 2^-25
+        { 0x3f801000, 0x3c00 }, // 1 + 2^-11: tie, rounds to even
+        { 0x3f803000, 0x3c02 }, // 1 + 3 * 2^-11: tie, rounds to even
+        { 0x3f801001, 0x3c01 }, // above the tie
+    };
+    const FloatHalf to_float[] = {
+        { 0x00000000, 0x0000 }, { 0x80000000, 0x8000 }, { 0x3eaaa000, 0x3555 }, { 0x477fe000, 0x7bff },
+        { 0x33800000, 0x0001 }, { 0x387fc000, 0x03ff }, { 0x38800000, 0x0400 },
+        { 0x7f800000, 0x7c00 }, { 0xff800000, 0xfc00 },
+    };
+
+    bool result = true;
+    for (auto& v : to_half) {
+        float f = BitsToFloat(v.f);
+        uint16_t h;
+        FloatToHalf_Generic(&h, &f, 1);
+        if (h != v.h || TAssignHalf1(f) != v.h) {
+            printf("    FloatToHalf(0x%08x): 0x%04x (baseline 0x%04x), expected 0x%04x\n", v.f, h, TAssignHalf1(f), v.h);
+            result = false;
+        }
+    }
+    for (auto& v : to_float) {
+        float f;
+        HalfToFloat_Generic(&f, &v.h, 1);
+        if (FloatBits(f) != v.f || FloatBits(TAssignFloat1(v.h)) != v.f) {
+            printf("    HalfToFloat(0x%04x): 0x%08x (baseline 0x%08x), expected 0x%08x\n", v.h, FloatBits(f), FloatBits(TAssignFloat1(v.h)), v.f);
+            result = false;
+        }
+    }
+
+    // all halves against the baseline, and back
+    for (uint32_t i = 0; i < 0x10000 && result; ++i) {
+        uint16_t h = (uint16_t)i, h2;
+        float f;
+        HalfToFloat_Generic(&f, &h, 1);
+        FloatToHalf_Generic(&h2, &f, 1);
+        bool nan = (h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0;
+        result = FloatBits(f) == FloatBits(TAssignFloat1(h)) && (nan || h2 == h);
+    }
+
+    // NaN stays NaN in both directions
+    {
+        float nan = BitsToFloat(0x7fc00000);
+        uint16_t h;
+        FloatToHalf_Generic(&h, &nan, 1);
+        float f;
+        uint16_t hnan = 0x7e00;
+        HalfToFloat_Generic(&f, &hnan, 1);
+        result = result && (h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0 && std::isnan(f);
+    }
+
+    printf("Test_HalfKnownValues: %s\n", result ? "succeeded" : "failed");
+    printf("\n");
+}
+
+template<class Dst, class Src, class Assign>
+static void TAssignArray(Dst *dst, const Src *src, size_t num, const Assign& assign)
+{
+    for (size_t i = 0; i < num; ++i) {
+        assign(dst[i], src[i]);
+    }
+}
+
+template<class T>
+static bool bitwise_equal(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0;
+}
+
+// run TAssign baseline, Generic and ISPC. results of Generic must be identical to the baseline, and ISPC near equal.
+template<class Dst, class Baseline, class Generic, class ISPC, class Equal>
+static void BenchmarkConversion(const char *name, std::vector<Dst>& result0, std::vector<Dst>& result1, std::vector<Dst>& result2,
+    const Baseline& baseline, const Generic& generic, const ISPC& ispc, const Equal& equal)
+{
+    ns elapsed0 = 0;
+    ns elapsed1 = 0;
+    ns elapsed2 = 0;
+    bool result = false;
+
+    for (int i = 0; i < NumTry; ++i) {
+        auto start = now();
+        baseline();
+        elapsed0 += now() - start;
+
+        start = now();
+        generic();
+        elapsed1 += now() - start;
+        result = bitwise_equal(result0, result1);
+
+#ifdef muEnableISPC
+        start = now();
+        ispc();
+        elapsed2 += now() - start;
+        result = result && equal(result1, result2);
+#else
+        (void)ispc; (void)equal; (void)result2;
+#endif // muEnableISPC
+        if (!result) { break; }
+    }
+
+    printf("Test_%s: %s\n", name, result ? "succeeded" : "failed");
+    printf("    per-element TAssign(): avg. %f ms\n", float(elapsed0 / NumTry) / 1000000.0f);
+    printf("    %s_Generic(): avg. %f ms\n", name, float(elapsed1 / NumTry) / 1000000.0f);
+    printf("    %s_ISPC(): avg. %f ms\n", name, float(elapsed2 / NumTry) / 1000000.0f);
+    printf("\n");
+}
+
+static void Test_FloatToHalf()
+{
+    auto data = GenerateTestData(NumTestData, 0.1f, 100.0f);
+    size_t num = data.size() * 3;
+    std::vector<half3> result0(data.size()), result1(data.size()), result2(data.size());
+
+    BenchmarkConversion("FloatToHalf", result0, result1, result2,
+        [&]() {
+            TAssignArray(result0.data(), data.data(), data.size(), [](half3& d, const float3& s) {
+                d = { TAssignHalf1(s.x), TAssignHalf1(s.y), TAssignHalf1(s.z) };
+            });
+        },
+        [&]() { FloatToHalf_Generic((uint16_t*)result1.data(), (const float*)data.data(), num); },
+        [&]() {
+#ifdef muEnableISPC
+            FloatToHalf_ISPC((uint16_t*)result2.data(), (const float*)data.data(), num);
+#endif // muEnableISPC
+        },
+        [](const std::vector<half3>& a, const std::vector<half3>& b) { return bitwise_equal(a, b); });
+}
+
+
+static void Test_HalfToFloat()
+{
+    auto data = GenerateTestData(NumTestData, 0.1f, 100.0f);
+    size_t num = data.size() * 3;
+    std::vector<half3> halves(data.size());
+    FloatToHalf_Generic((uint16_t*)halves.data(), (const float*)data.data(), num);
+    std::vector<float3> result0(data.size()), result1(data.size()), result2(data.size());
+    const float *table = TAssignHalfTable();
+
+    BenchmarkConversion("HalfToFloat", result0, result1, result2,
+        [&]() {
+            TAssignArray(result0.data(), halves.data(), halves.size(), [table](float3& d, const half3& s) {
+                d = { table[s.x], table[s.y], table[s.z] };
+            });
+        },
+        [&]() { HalfToFloat_Generic((float*)result1.data(), (const uint16_t*)halves.data(), num); },
+        [&]() {
+#ifdef muEnableISPC
+            HalfToFloat_ISPC((float*)result2.data(), (const uint16_t*)halves.data(), num);
+#endif // muEnableISPC
+        },
+        [](const std::vector<float3>& a, const std::vector<float3>& b) { return near_equal(a, b); });
+}
+
+
+static void Test_DoubleToFloat()
+{
+    auto data = GenerateTestData(NumTestData, 0.1f, 1.0f);
+    size_t num = data.size() * 3;
+    std::vector<double3> doubles(data.size());
+    FloatToDouble_Generic((double*)doubles.data(), (const float*)data.data(), num);
+    std::vector<float3> result0(data.size()), result1(data.size()), result2(data.size());
+
+    BenchmarkConversion("DoubleToFloat", result0, result1, result2,
+        [&]() {
+            TAssignArray(result0.data(), doubles.data(), doubles.size(), [](float3& d, const double3& s) {
+                d = { (float)s.x, (float)s.y, (float)s.z };
+            });
+        },
+        [&]() { DoubleToFloat_Generic((float*)result1.data(), (const double*)doubles.data(), num); },
+        [&]() {
+#ifdef muEnableISPC
+            DoubleToFloat_ISPC((float*)result2.data(), (const double*)doubles.data(), num);
+#endif // muEnableISPC
+        },
+        [](const std::vector<float3>& a, const std::vector<float3>& b) { return near_equal(a, b); });
+}
+
+
+static void Test_FloatToDouble()
+{
+    auto data = GenerateTestData(NumTestData, 0.1f, 1.0f);
+    size_t num = data.size() * 3;
+    std::vector<double3> result0(data.size()), result1(data.size()), result2(data.size());
+
+    BenchmarkConversion("FloatToDouble", result0, result1, result2,
+        [&]() {
+            TAssignArray(result0.data(), data.data(), data.size(), [](double3& d, const float3& s) {
+                d = { (double)s.x, (double)s.y, (double)s.z };
+            });
+        },
+        [&]() { FloatToDouble_Generic((double*)result1.data(), (const float*)data.data(), num); },
+        [&]() {
+#ifdef muEnableISPC
+            FloatToDouble_ISPC((double*)result2.data(), (const float*)data.data(), num);
+#endif // muEnableISPC
+        },
+        // float -> double is exact
+        [](const std::vector<double3>& a, const std::vector<double3>& b) { return bitwise_equal(a, b); });
+}
+
+
 static void Test_ComputeBounds()
 {
     auto data = GenerateTestData(NumTestData, 0.1f, 1.0f);
@@ -227,6 +756,17 @@ void MeshUtilsTest()
 {
     Test_InvertX();
     Test_Scale();
+    Test_MulCopy();
+    Test_ReverseWinding();
+    Test_UnpackWeights();
+    Test_InterleaveStream();
+    Test_InterleaveLayout();
+    Test_Lerp();
+    Test_HalfKnownValues();
+    Test_FloatToHalf();
+    Test_HalfToFloat();
+    Test_DoubleToFloat();
+    Test_FloatToDouble();
     Test_ComputeBounds();
     Test_Normalize();
     Test_CalculateNormals();
@@ -3,6 +3,8 @@
 #include <cmath>
 #include <vector>
 #include <string>
+#include <chrono>
+#include <thread>
 #include "../usdi/usdi.h"
 
 using usdi::float2;
@@ -116,6 +118,17 @@ static void TestAttributes(usdi::Schema *schema)
         const char *v[] = { "test_string0", "test_string1", "test_string2" };
         AddAttribute(schema, "string_array", usdi::AttributeType::StringArray, v);
     }
+    {
+        // signs of two elements flip in the 2nd sample. changes like this must not be hidden by hash collisions.
+        float v[2][4] = { { 1.0f, 2.0f, 3.0f, 4.0f }, { 1.0f, -2.0f, 3.0f, -4.0f } };
+        auto *attr = usdiPrimCreateAttribute(schema, "float_array_flip", usdi::AttributeType::FloatArray);
+        for (int i = 0; i < 2; ++i) {
+            usdi::AttributeData data;
+            data.data = v[i];
+            data.num_elements = 4;
+            usdiAttrWriteSample(attr, &data, 1.0 / 30.0 * i);
+        }
+    }
 }
 
 
@@ -291,3 +304,555 @@ void TestExportReference(const char *filename, const char *flatten)
 
     usdiDestroyContext(ctx);
 }
+
+// /Inst1 and /Inst2 are instances of /Proto at different positions
+void TestExportInstances(const char *filename)
+{
+    auto *ctx = usdiCreateContext();
+    usdiCreateStage(ctx, filename);
+    auto *root = usdiGetRoot(ctx);
+
+    usdi::XformData data;
+    auto *proto = usdiCreateXform(ctx, root, "Proto");
+    data.position = { 0.0f, 1.0f, 0.0f };
+    usdiXformWriteSample(usdiCreateXform(ctx, proto, "Child"), &data);
+
+    const float positions[] = { 1.0f, 100.0f };
+    const char *names[] = { "Inst1", "Inst2" };
+    for (int i = 0; i < 2; ++i) {
+        auto *inst = usdiCreateXform(ctx, root, names[i]);
+        data.position = { positions[i], 0.0f, 0.0f };
+        usdiXformWriteSample(inst, &data);
+        usdiPrimAddReference(inst, nullptr, "/Proto");
+        usdiPrimSetInstanceable(inst, true);
+    }
+
+    usdiSave(ctx);
+    usdiDestroyContext(ctx);
+}
+
+// records many small objects per frame and reports frames per second
+enum class RecordMode { Direct, WriteFrame, Recorder, Parallel };
+
+static double RecordFrames(const char *filename, RecordMode mode)
+{
+    const int num_objects = 2000;
+    const int num_frames = 30;
+    const int num_threads = 4;
+
+    auto *ctx = usdiCreateContext();
+    usdiCreateStage(ctx, filename);
+    auto *root = usdiGetRoot(ctx);
+
+    std::vector<usdi::Xform*> xforms;
+    std::vector<usdi::Mesh*> meshes;
+    char name[64];
+    for (int i = 0; i < num_objects; ++i) {
+        sprintf(name, "Object%d", i);
+        auto *xf = usdiCreateXform(ctx, root, name);
+        xforms.push_back(xf);
+        meshes.push_back(usdiCreateMesh(ctx, xf, "Mesh"));
+    }
+    if (mode == RecordMode::Parallel) { usdiBeginParallelExport(ctx, nullptr); }
+
+    int counts[] = { 4 };
+    int indices[] = { 0, 1, 2, 3 };
+
+    auto write_objects = [&](int frame, int begin, int end) {
+        usdi::Time t = 1.0 / 30.0 * frame;
+        float3 points[4];
+        for (int i = begin; i < end; ++i) {
+            float f = (float)(i + frame);
+            usdi::XformData xd;
+            xd.position = { f, 0.0f, 0.0f };
+
+            points[0] = { 0.0f, f, 0.0f };
+            points[1] = { 1.0f, f, 0.0f };
+            points[2] = { 1.0f, f, 1.0f };
+            points[3] = { 0.0f, f, 1.0f };
+            usdi::MeshData md;
+            md.points = points;
+            md.num_points = 4;
+            if (frame == 0) {
+                md.counts = counts;
+                md.num_counts = 1;
+                md.indices = indices;
+                md.num_indices = 4;
+            }
+
+            if (mode == RecordMode::Recorder) {
+                usdiRecorderWriteXform(ctx, xforms[i], &xd, t);
+                usdiRecorderWriteMesh(ctx, meshes[i], &md, t);
+            }
+            else {
+                usdiXformWriteSample(xforms[i], &xd, t);
+                usdiMeshWriteSample(meshes[i], &md, t);
+            }
+        }
+    };
+
+    auto write_frame = [&](int frame) {
+        if (mode == RecordMode::Parallel) {
+            // each thread writes its own range of top-level objects
+            std::vector<std::thread> threads;
+            for (int ti = 0; ti < num_threads; ++ti) {
+                int begin = num_objects * ti / num_threads;
+                int end = num_objects * (ti + 1) / num_threads;
+                threads.emplace_back([&, begin, end]() { write_objects(frame, begin, end); });
+            }
+            for (auto& th : threads) { th.join(); }
+            return;
+        }
+
+        if (mode == RecordMode::WriteFrame) { usdiBeginWriteFrame(ctx); }
+        write_objects(frame, 0, num_objects);
+        if (mode == RecordMode::WriteFrame) { usdiEndWriteFrame(ctx); }
+        if (mode == RecordMode::Recorder) { usdiRecorderEndFrame(ctx); }
+    };
+
+    // first frame creates attribute specs (from all threads in parallel mode). exclude it from the measurement.
+    write_frame(0);
+    if (mode == RecordMode::Recorder) { usdiRecorderFlush(ctx); }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int frame = 1; frame < num_frames; ++frame) {
+        write_frame(frame);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end - begin).count();
+
+    if (mode == RecordMode::Recorder) {
+        usdiRecorderFlush(ctx);
+        usdi::RecorderStats stats;
+        usdiRecorderGetStats(ctx, &stats);
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        printf("    recorder: %d frames written, %d stalls (%.2fms), peak queue depth %d, %.2f fps including flush\n",
+            stats.num_written_frames, stats.num_stalls, stats.stall_time, stats.max_queued_frames, (num_frames - 1) / total);
+    }
+    if (mode == RecordMode::Parallel) {
+        usdiEndParallelExport(ctx);
+    }
+    usdiSave(ctx);
+
+    usdiDestroyContext(ctx);
+    return (num_frames - 1) / elapsed;
+}
+
+// read samples written by RecordFrames() back from the file. they go through UsdAttribute::Get() and its type checks.
+static bool VerifyRecordedFrames(const char *filename)
+{
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, filename)) {
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    bool ret = true;
+    char path[64];
+    for (int i : { 0, 777, 1999 }) {
+        sprintf(path, "/Object%d", i);
+        auto *xf = usdiAsXform(usdiFindSchema(ctx, path));
+        sprintf(path, "/Object%d/Mesh", i);
+        auto *mesh = usdiAsMesh(usdiFindSchema(ctx, path));
+        ret = ret && xf && mesh;
+
+        for (int frame : { 0, 1, 15, 29 }) {
+            if (!ret) { break; }
+            usdi::Time t = 1.0 / 30.0 * frame;
+            float f = (float)(i + frame);
+
+            usdi::XformData xd;
+            usdi::MeshData md;
+            ret = usdiXformReadSample(xf, &xd, t) && xd.position.x == f && xd.position.y == 0.0f &&
+                usdiMeshReadSample(mesh, &md, t, false) && md.num_points == 4 &&
+                md.points[0].y == f && md.points[2].x == 1.0f && md.points[2].z == 1.0f;
+        }
+    }
+
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+void TestExportWriteFrame()
+{
+    printf("TestExportWriteFrame:\n");
+    double fps1 = RecordFrames("WriteFrame1.usda", RecordMode::Direct);
+    double fps2 = RecordFrames("WriteFrame2.usda", RecordMode::WriteFrame);
+    double fps3 = RecordFrames("WriteFrame3.usda", RecordMode::Recorder);
+    double fps4 = RecordFrames("WriteFrame4.usda", RecordMode::Parallel);
+    bool ret =
+        VerifyRecordedFrames("WriteFrame1.usda") &&
+        VerifyRecordedFrames("WriteFrame2.usda") &&
+        VerifyRecordedFrames("WriteFrame3.usda") &&
+        VerifyRecordedFrames("WriteFrame4.usda");
+    printf("    read back: %s\n", ret ? "succeeded" : "failed");
+    printf("    without write frame: %.2f fps\n", fps1);
+    printf("    with write frame: %.2f fps\n", fps2);
+    printf("    recorder (caller side): %.2f fps\n", fps3);
+    printf("    parallel export (4 threads): %.2f fps\n", fps4);
+    printf("\n");
+}
+
+// half of the objects never move. their samples should be authored only as default values.
+// odd objects move every frame, objects of multiple of 4 are static and the others hold the value for
+// a while between moves. the runs of held values test that the end of a run is kept for linear interpolation.
+// objects of 8n+6 flip their sign every frame. a change that keeps the data length must never be skipped.
+static float DeduplicateValue(int i, int frame)
+{
+    if (i % 2 == 1) { return (float)(i + frame); }
+    if (i % 4 == 0) { return (float)i; }
+    if (i % 8 == 6) { return frame % 2 == 0 ? (float)i : -(float)i; }
+    return (float)(i + std::min<int>(std::max<int>(frame, 10), 20));
+}
+
+static void WriteDeduplicateFrames(const char *filename, bool deduplicate, int num_objects, int num_frames)
+{
+    auto *ctx = usdiCreateContext();
+    usdiCreateStage(ctx, filename);
+
+    usdi::ExportSettings settings;
+    usdiGetExportSettings(ctx, &settings);
+    settings.deduplicate_samples = deduplicate;
+    usdiSetExportSettings(ctx, &settings);
+
+    auto *root = usdiGetRoot(ctx);
+    std::vector<usdi::Xform*> xforms;
+    std::vector<usdi::Mesh*> meshes;
+    char name[64];
+    for (int i = 0; i < num_objects; ++i) {
+        sprintf(name, "Object%d", i);
+        auto *xf = usdiCreateXform(ctx, root, name);
+        xforms.push_back(xf);
+        meshes.push_back(usdiCreateMesh(ctx, xf, "Mesh"));
+    }
+
+    int counts[] = { 4 };
+    int indices[] = { 0, 1, 2, 3 };
+    float3 points[4];
+    for (int frame = 0; frame < num_frames; ++frame) {
+        usdi::Time t = 1.0 / 30.0 * frame;
+        usdiBeginWriteFrame(ctx);
+        for (int i = 0; i < num_objects; ++i) {
+            float f = DeduplicateValue(i, frame);
+            usdi::XformData xd;
+            xd.position = { f, 0.0f, 0.0f };
+
+            points[0] = { 0.0f, f, 0.0f };
+            points[1] = { 1.0f, f, 0.0f };
+            points[2] = { 1.0f, f, 1.0f };
+            points[3] = { 0.0f, f, 1.0f };
+            usdi::MeshData md;
+            md.points = points;
+            md.num_points = 4;
+            md.counts = counts;
+            md.num_counts = 1;
+            md.indices = indices;
+            md.num_indices = 4;
+
+            usdiXformWriteSample(xforms[i], &xd, t);
+            usdiMeshWriteSample(meshes[i], &md, t);
+        }
+        usdiEndWriteFrame(ctx);
+    }
+
+    if (deduplicate) {
+        usdi::ExportStats stats;
+        usdiGetExportStats(ctx, &stats);
+        printf("    %d samples written, %d skipped, %d constant streams\n",
+            stats.num_written_samples, stats.num_skipped_samples, stats.num_constant_streams);
+        printf("    %.2fkb written, %.2fkb avoided\n",
+            (double)stats.bytes_written / 1024.0, (double)stats.bytes_avoided / 1024.0);
+    }
+
+    usdiSave(ctx);
+    usdiDestroyContext(ctx);
+}
+
+// every frame and every point between frames of the deduplicated file must equal the reference
+static bool CompareDeduplicatedFrames(const char *filename, const char *reference, usdi::InterpolationType interpolation,
+    int num_objects, int num_frames)
+{
+    usdi::Context *ctxs[2] = { usdiCreateContext(), usdiCreateContext() };
+    const char *paths[2] = { filename, reference };
+    bool ret = true;
+    for (int ci = 0; ci < 2; ++ci) {
+        usdi::ImportSettings settings;
+        usdiGetImportSettings(ctxs[ci], &settings);
+        settings.interpolation = interpolation;
+        usdiSetImportSettings(ctxs[ci], &settings);
+        ret = ret && usdiOpen(ctxs[ci], paths[ci]);
+    }
+
+    char path[64];
+    for (int i = 0; i < num_objects && ret; ++i) {
+        usdi::Xform *xfs[2];
+        usdi::Mesh *meshes[2];
+        for (int ci = 0; ci < 2; ++ci) {
+            sprintf(path, "/Object%d", i);
+            xfs[ci] = usdiAsXform(usdiFindSchema(ctxs[ci], path));
+            sprintf(path, "/Object%d/Mesh", i);
+            meshes[ci] = usdiAsMesh(usdiFindSchema(ctxs[ci], path));
+            ret = ret && xfs[ci] && meshes[ci];
+        }
+
+        for (int s = 0; s < num_frames * 2 && ret; ++s) {
+            usdi::Time t = 1.0 / 30.0 * (s * 0.5);
+            usdi::XformData xd[2];
+            usdi::MeshData md[2];
+            for (int ci = 0; ci < 2 && ret; ++ci) {
+                ret = usdiXformReadSample(xfs[ci], &xd[ci], t) &&
+                    usdiMeshReadSample(meshes[ci], &md[ci], t, false) && md[ci].num_points == 4;
+            }
+            if (!ret) { break; }
+
+            ret = xd[0].position.x == xd[1].position.x &&
+                md[0].num_counts == md[1].num_counts && md[0].num_indices == md[1].num_indices;
+            for (int pi = 0; pi < 4 && ret; ++pi) {
+                ret = md[0].points[pi].x == md[1].points[pi].x &&
+                    md[0].points[pi].y == md[1].points[pi].y &&
+                    md[0].points[pi].z == md[1].points[pi].z;
+            }
+            if (!ret) {
+                printf("    mismatch: /Object%d at %lf\n", i, t);
+            }
+        }
+    }
+
+    for (auto *ctx : ctxs) { usdiDestroyContext(ctx); }
+    return ret;
+}
+
+void TestExportDeduplicate(const char *filename, const char *reference)
+{
+    const int num_objects = 100;
+    const int num_frames = 30;
+
+    printf("TestExportDeduplicate:\n");
+    WriteDeduplicateFrames(filename, true, num_objects, num_frames);
+    WriteDeduplicateFrames(reference, false, num_objects, num_frames);
+
+    bool held = CompareDeduplicatedFrames(filename, reference, usdi::InterpolationType::None, num_objects, num_frames);
+    bool linear = CompareDeduplicatedFrames(filename, reference, usdi::InterpolationType::Linear, num_objects, num_frames);
+    printf("    held interpolation: %s\n", held ? "succeeded" : "failed");
+    printf("    linear interpolation: %s\n", linear ? "succeeded" : "failed");
+    printf("\n");
+}
+
+// long recording split into value clips. samples are read back through the clips.
+void TestExportClips(const char *filename)
+{
+    const int num_frames = 35;
+    const int frames_per_clip = 10;
+
+    {
+        auto *ctx = usdiCreateContext();
+        usdiCreateStage(ctx, filename);
+        auto *root = usdiGetRoot(ctx);
+        auto *xf = usdiCreateXform(ctx, root, "Child");
+        auto *mesh = usdiCreateMesh(ctx, xf, "Mesh");
+
+        usdi::ClipExportSettings settings;
+        settings.frames_per_clip = frames_per_clip;
+        settings.binary = false;
+        usdiBeginClipExport(ctx, &settings);
+
+        int counts[] = { 4 };
+        int indices[] = { 0, 1, 2, 3 };
+        float3 points[4];
+        for (int frame = 0; frame < num_frames; ++frame) {
+            usdi::Time t = (usdi::Time)frame;
+            float f = (float)frame;
+
+            usdi::XformData xd;
+            xd.position = { f, 0.0f, 0.0f };
+            usdiXformWriteSample(xf, &xd, t);
+
+            points[0] = { 0.0f, f, 0.0f };
+            points[1] = { 1.0f, f, 0.0f };
+            points[2] = { 1.0f, f, 1.0f };
+            points[3] = { 0.0f, f, 1.0f };
+            usdi::MeshData md;
+            md.points = points;
+            md.num_points = 4;
+            md.counts = counts;
+            md.num_counts = 1;
+            md.indices = indices;
+            md.num_indices = 4;
+            usdiMeshWriteSample(mesh, &md, t);
+        }
+        {
+            // older than the current clip. rejected.
+            usdi::XformData xd;
+            xd.position = { -1000.0f, 0.0f, 0.0f };
+            usdiXformWriteSample(xf, &xd, 5.0);
+        }
+
+        usdiEndClipExport(ctx);
+        usdiSave(ctx);
+        usdiDestroyContext(ctx);
+    }
+
+    {
+        auto *ctx = usdiCreateContext();
+        usdiOpen(ctx, filename);
+        auto *xf = usdiAsXform(usdiFindSchema(ctx, "/Child"));
+        auto *mesh = usdiAsMesh(usdiFindSchema(ctx, "/Child/Mesh"));
+        printf("TestExportClips:\n");
+        bool ret = xf && mesh;
+        // frames in the first, a middle and the last clip, around clip boundaries, and between the clips.
+        // interpolation is linear by default.
+        for (double t : { 0.0, 3.0, 5.0, 9.0, 9.5, 10.0, 11.0, 17.0, 19.5, 20.0, 29.5, 30.0, 34.0 }) {
+            if (!ret) { break; }
+            usdi::XformData xd;
+            usdi::MeshData md;
+            ret = usdiXformReadSample(xf, &xd, t) && xd.position.x == (float)t &&
+                usdiMeshReadSample(mesh, &md, t, false) && md.num_points == 4 && md.points[0].y == (float)t;
+            printf("    time %.1f: position.x = %.1f\n", t, xd.position.x);
+        }
+        printf("    %s\n", ret ? "succeeded" : "failed");
+        printf("\n");
+        usdiDestroyContext(ctx);
+    }
+}
+
+// recording continues while snapshots are written on a worker thread
+// the file saved asynchronously must have the frames written before the save and none written after it
+static bool VerifyAsyncSave(const char *filename, int num_objects, int num_saved_frames)
+{
+    auto *ctx = usdiCreateContext();
+    bool ret = usdiOpen(ctx, filename);
+
+    char path[64];
+    for (int i = 0; i < num_objects && ret; i += 33) {
+        sprintf(path, "/Points%d", i);
+        auto *points = usdiAsPoints(usdiFindSchema(ctx, path));
+        if (!points) {
+            ret = false;
+            break;
+        }
+
+        usdi::PointsSummary summary;
+        usdiPointsGetSummary(points, &summary);
+        ret = std::abs(summary.end - 1.0 / 30.0 * (num_saved_frames - 1)) < 1e-6;
+
+        // the last one is after the save. it must have the value of the last saved frame.
+        for (int frame : { 0, num_saved_frames / 2, num_saved_frames - 1, num_saved_frames + 5 }) {
+            if (!ret) { break; }
+            usdi::PointsData data;
+            ret = usdiPointsReadSample(points, &data, 1.0 / 30.0 * frame, false) && data.num_points > 0 &&
+                data.points[0].y == (float)(i + std::min<int>(frame, num_saved_frames - 1));
+        }
+    }
+
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+void TestExportAsyncSave(const char *filename, const char *flatten)
+{
+    const int num_objects = 100;
+    const int num_points = 10000;
+    const int num_frames = 30;
+
+    auto *ctx = usdiCreateContext();
+    usdiCreateStage(ctx, filename);
+    auto *root = usdiGetRoot(ctx);
+
+    std::vector<usdi::Points*> objects;
+    char name[64];
+    for (int i = 0; i < num_objects; ++i) {
+        sprintf(name, "Points%d", i);
+        objects.push_back(usdiCreatePoints(ctx, root, name));
+    }
+
+    std::vector<float3> points(num_points);
+    auto write_frame = [&](int frame) {
+        usdi::Time t = 1.0 / 30.0 * frame;
+        usdiBeginWriteFrame(ctx);
+        for (int i = 0; i < num_objects; ++i) {
+            for (int pi = 0; pi < num_points; ++pi) {
+                points[pi] = { (float)pi, (float)(i + frame), 0.0f };
+            }
+            usdi::PointsData data;
+            data.points = points.data();
+            data.num_points = num_points;
+            usdiPointsWriteSample(objects[i], &data, t);
+        }
+        usdiEndWriteFrame(ctx);
+    };
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point b) { return std::chrono::duration<double, std::milli>(Clock::now() - b).count(); };
+
+    for (int frame = 0; frame < num_frames / 2; ++frame) {
+        write_frame(frame);
+    }
+
+    auto begin = Clock::now();
+    usdiSave(ctx);
+    double sync_time = ms(begin);
+
+    begin = Clock::now();
+    auto *as1 = usdiSaveAsync(ctx);
+    auto *as2 = usdiSaveAsAsync(ctx, flatten);
+    double async_time = ms(begin);
+
+    // authoring goes on while the snapshots are written
+    for (int frame = num_frames / 2; frame < num_frames; ++frame) {
+        write_frame(frame);
+    }
+    bool r1 = usdiAsyncSaveWait(as1);
+    bool r2 = usdiAsyncSaveWait(as2);
+    usdiAsyncSaveRelease(as1);
+    usdiAsyncSaveRelease(as2);
+    usdiDestroyContext(ctx);
+
+    bool v1 = r1 && VerifyAsyncSave(filename, num_objects, num_frames / 2);
+    bool v2 = r2 && VerifyAsyncSave(flatten, num_objects, num_frames / 2);
+    printf("TestExportAsyncSave:\n");
+    printf("    usdiSave(): %.2fms\n", sync_time);
+    printf("    usdiSaveAsync() + usdiSaveAsAsync() (caller side): %.2fms\n", async_time);
+    printf("    results: %s, %s\n", r1 ? "succeeded" : "failed", r2 ? "succeeded" : "failed");
+    printf("    read back: %s, %s\n", v1 ? "succeeded" : "failed", v2 ? "succeeded" : "failed");
+    printf("\n");
+}
+
+// points and normals of every vertex move differently in each frame, for TestImportVertexAnimation()
+void TestExportVertexAnimation(const char *filename)
+{
+    auto *ctx = usdiCreateContext();
+    usdiCreateStage(ctx, filename);
+    auto *root = usdiGetRoot(ctx);
+
+    const int num_points = 10;
+    std::vector<float3> points(num_points), normals(num_points);
+    std::vector<int> counts, indices;
+    for (int i = 0; i + 2 < num_points; ++i) {
+        counts.push_back(3);
+        indices.push_back(i);
+        indices.push_back(i + 1);
+        indices.push_back(i + 2);
+    }
+
+    auto *mesh = usdiCreateMesh(ctx, root, "VertexAnimMesh");
+    for (int f = 0; f < 6; ++f) {
+        for (int i = 0; i < num_points; ++i) {
+            float a = 0.3f * f + 0.5f * i;
+            points[i] = { 0.1f * i, std::sin(a), 0.25f * f };
+            normals[i] = { std::sin(a), 0.0f, std::cos(a) };
+        }
+
+        usdi::MeshData data;
+        data.points = points.data();
+        data.normals = normals.data();
+        data.counts = counts.data();
+        data.indices = indices.data();
+        data.num_points = num_points;
+        data.num_counts = (usdi::uint)counts.size();
+        data.num_indices = (usdi::uint)indices.size();
+        usdiMeshWriteSample(mesh, &data, (1.0 / 30.0) * f);
+    }
+
+    usdiSave(ctx);
+    usdiDestroyContext(ctx);
+}
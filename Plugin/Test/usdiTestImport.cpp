@@ -1,7 +1,11 @@
 
 #include <cstdio>
+#include <cmath>
+#include <cstring>
 #include <vector>
 #include "../usdi/usdi.h"
+#include "../usdi/ext/usdiExt.h"
+#include "../MeshUtils/MeshUtils.h"
 
 typedef unsigned char byte;
 typedef unsigned int uint;
@@ -123,7 +127,7 @@ static void InspectRecursive(usdi::Schema *schema)
         printf(", instance of %s", usdiPrimGetPath(usdiPrimGetMaster(schema)));
     }
     if (usdiPrimIsMaster(schema)) {
-        printf(", master");
+        printf(", master (%d instances)", usdiPrimGetInstanceTransforms(schema, nullptr, 0, usdiDefaultTime()));
     }
     if (usdiPrimHasPayload(schema)) {
         printf(", payload");
@@ -167,3 +171,593 @@ bool TestImport(const char *path)
 
     return true;
 }
+
+bool TestImportVariantSwitch(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    bool ret = false;
+    auto *untouched = usdiFindSchema(ctx, "/Child");
+    auto *xf = usdiFindSchema(ctx, "/TestVariants");
+    if (untouched && xf) {
+        int untouched_id = usdiPrimGetID(untouched);
+        int iset = usdiPrimFindVariantSet(xf, "VariantSet1");
+
+        // switch to a variant that has no children. only /TestVariants should be rebuilt.
+        usdiPrimSetVariantSelection(xf, iset, usdiPrimFindVariant(xf, iset, "Variant1-2"));
+        usdiRebuildSchemaTree(ctx);
+        bool removed = usdiFindSchema(ctx, "/TestVariants/Variant1_1") == nullptr;
+
+        xf = usdiFindSchema(ctx, "/TestVariants");
+        usdiPrimSetVariantSelection(xf, iset, usdiPrimFindVariant(xf, iset, "Variant1-1"));
+        usdiRebuildSchemaTree(ctx);
+        bool restored = usdiFindSchema(ctx, "/TestVariants/Variant1_1/Hage/Hige") != nullptr;
+
+        bool stable = usdiFindSchema(ctx, "/Child") == untouched && usdiPrimGetID(untouched) == untouched_id;
+        ret = removed && restored && stable;
+    }
+    printf("TestImportVariantSwitch: %s\n", ret ? "succeeded" : "failed");
+
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportMaskedAndLazy(const char *path)
+{
+    if (!path) { return false; }
+
+    bool masked = false;
+    {
+        auto *ctx = usdiCreateContext();
+        const char *mask[] = { "/Child" };
+        if (usdiOpenMasked(ctx, path, mask, 1)) {
+            auto *root = usdiGetRoot(ctx);
+            masked = usdiPrimGetNumChildren(root) == 1 && usdiFindSchema(ctx, "/TestVariants") == nullptr;
+        }
+        usdiDestroyContext(ctx);
+    }
+
+    bool lazy = false;
+    {
+        auto *ctx = usdiCreateContext();
+        usdi::OpenSettings settings;
+        settings.lazy_schema_tree = true;
+        if (usdiOpenWithSettings(ctx, path, &settings)) {
+            auto *hige = usdiFindSchema(ctx, "/TestVariants/Variant1_1/Hage/Hige");
+            lazy = hige && usdiPrimGetParent(hige) == usdiFindSchema(ctx, "/TestVariants/Variant1_1/Hage");
+        }
+        usdiDestroyContext(ctx);
+    }
+
+    printf("TestImportMaskedAndLazy: masked %s, lazy %s\n", masked ? "succeeded" : "failed", lazy ? "succeeded" : "failed");
+    return masked && lazy;
+}
+
+bool TestImportAsync(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    auto *ao = usdiOpenAsync(ctx, path);
+
+    usdi::OpenProgress progress;
+    while (!usdiAsyncOpenIsFinished(ao)) {
+        usdiAsyncOpenGetProgress(ao, &progress);
+    }
+    bool ret = usdiAsyncOpenWait(ao);
+    usdiAsyncOpenGetProgress(ao, &progress);
+    usdiAsyncOpenRelease(ao);
+
+    ret = ret && progress.stage == usdi::OpenStage::Completed &&
+        usdiFindSchema(ctx, "/TestVariants/Variant1_1/Hage/Hige") != nullptr;
+    printf("TestImportAsync: %s (%d schemas)\n", ret ? "succeeded" : "failed", progress.num_schemas);
+
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportPathQueries(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    const char *paths[] = { "/Child", "/NotExist", "/TestVariants" };
+    usdi::Schema *found[3];
+    bool ret = usdiFindSchemas(ctx, paths, 3, found) == 2 && found[0] && !found[1] && found[2];
+
+    int num_subtree = usdiFindSchemasInSubtree(ctx, "/TestVariants", nullptr, 0);
+    std::vector<usdi::Schema*> subtree(num_subtree);
+    usdiFindSchemasInSubtree(ctx, "/TestVariants", subtree.data(), num_subtree);
+    ret = ret && num_subtree > 0 && subtree[0] == found[2];
+
+    int num_pattern = usdiFindSchemasByPattern(ctx, "/TestVariants/*/Hage/Hig?", nullptr, 0);
+    int num_any = usdiFindSchemasByPattern(ctx, "/**/Hige", nullptr, 0);
+    ret = ret && num_pattern == 1 && num_any == 1;
+
+    printf("TestImportPathQueries: %s (subtree: %d, pattern: %d)\n", ret ? "succeeded" : "failed", num_subtree, num_pattern);
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportAttributeBatch(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    auto *child = usdiFindSchema(ctx, "/Child");
+    auto *batch = usdiCreateAttributeBatch();
+    usdiAttrBatchAdd(batch, usdiPrimFindAttribute(child, "int_scalar"), 0, 1);
+    usdiAttrBatchAdd(batch, usdiPrimFindAttribute(child, "float_array"), 16, 3);
+    usdiAttrBatchAdd(batch, usdiPrimFindAttribute(child, "string_scalar"), 32, 1);
+    usdiAttrBatchAdd(batch, usdiPrimFindAttribute(child, "float_array_flip"), 48, 4);
+
+    char arena[64] = {};
+    usdi::uint changed = 0;
+    int num_elements[4] = {};
+    int num_changed1 = usdiAttrBatchRead(batch, arena, 0.0, &changed, num_elements);
+    bool ret = num_changed1 == 4 && changed == 15 && num_elements[1] == 3 &&
+        *(int*)&arena[0] == 123 && ((float*)&arena[16])[2] == 3.45f;
+
+    // same values at another time. only float_array_flip (signs of two elements flipped) should be reported as changed.
+    int num_changed2 = usdiAttrBatchRead(batch, arena, 1.0 / 30.0, &changed, num_elements);
+    ret = ret && num_changed2 == 1 && changed == 8 && ((float*)&arena[48])[3] == -4.0f;
+
+    printf("TestImportAttributeBatch: %s (changed: %d, %d)\n", ret ? "succeeded" : "failed", num_changed1, num_changed2);
+    usdiAttrBatchRelease(batch);
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportAttributeCache(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    auto *attr = usdiPrimFindAttribute(usdiFindSchema(ctx, "/Child"), "float_array");
+    bool ret = !usdiAttrEnableCache(attr, 16) && usdiAttrGetCacheSize(attr) == 0;
+    ret = ret && usdiAttrEnableCache(attr, 1024 * 1024) && usdiAttrGetCacheSize(attr) > 0;
+
+    // every sample has the same values. interpolated result must be the same.
+    float buf[3] = {};
+    usdi::AttributeData data;
+    data.data = buf;
+    data.num_elements = 3;
+    usdiAttrReadSample(attr, &data, 1.5 / 30.0, true);
+    ret = ret && data.num_elements == 3 && buf[0] == 1.23f && buf[2] == 3.45f;
+
+    // varying samples at t = 0, 1, 2: { 10 * t, 10 * t + 1, 10 * t + 2 }, and a default value
+    {
+        auto *varying = usdiPrimCreateAttribute(usdiFindSchema(ctx, "/Child"), "cache_test", usdi::AttributeType::FloatArray);
+        float values[3];
+        usdi::AttributeData src;
+        src.data = values;
+        src.num_elements = 3;
+        for (int t = 0; t < 3; ++t) {
+            for (int i = 0; i < 3; ++i) { values[i] = 10.0f * t + i; }
+            usdiAttrWriteSample(varying, &src, (double)t);
+        }
+        for (int i = 0; i < 3; ++i) { values[i] = -1.0f - i; }
+        usdiAttrWriteSample(varying, &src, usdiDefaultTime());
+        ret = ret && usdiAttrEnableCache(varying, 1024 * 1024);
+
+        // linear interpolation at fractional times, and clamping out of range
+        const double times[] = { 0.25, 1.75, 1.0, -1.0, 3.0 };
+        const float expected[] = { 2.5f, 17.5f, 10.0f, 0.0f, 20.0f };
+        for (int k = 0; k < 5; ++k) {
+            usdiAttrReadSample(varying, &data, times[k], true);
+            for (int i = 0; i < 3; ++i) {
+                ret = ret && std::abs(buf[i] - (expected[k] + i)) < 1e-5f;
+            }
+        }
+
+        // default time must return the default value, not a time sample
+        usdiAttrReadSample(varying, &data, usdiDefaultTime(), true);
+        ret = ret && buf[0] == -1.0f && buf[1] == -2.0f && buf[2] == -3.0f;
+    }
+
+    printf("TestImportAttributeCache: %s (%d bytes)\n", ret ? "succeeded" : "failed", (int)usdiAttrGetCacheSize(attr));
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportSampleHandle(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    auto *attr = usdiPrimFindAttribute(usdiFindSchema(ctx, "/Child"), "float_array");
+    usdi::AttributeData pinned;
+    auto *handle = usdiAttrAcquireSample(attr, &pinned, 0.0);
+    bool ret = handle && pinned.num_elements == 3 && ((float*)pinned.data)[0] == 1.23f;
+
+    // overwrite the sample. the pinned view must keep the old values.
+    float values[] = { 9.0f, 8.0f, 7.0f, 6.0f };
+    usdi::AttributeData src;
+    src.data = values;
+    src.num_elements = 4;
+    usdiAttrWriteSample(attr, &src, 0.0);
+
+    float buf[4] = {};
+    usdi::AttributeData data;
+    data.data = buf;
+    data.num_elements = 4;
+    // move to another time and back to make it re-read from USD
+    usdiAttrReadSample(attr, &data, 1.0 / 30.0, true);
+    usdiAttrReadSample(attr, &data, 0.0, true);
+    ret = ret && data.num_elements == 4 && buf[0] == 9.0f;
+    ret = ret && pinned.num_elements == 3 && ((float*)pinned.data)[0] == 1.23f && ((float*)pinned.data)[2] == 3.45f;
+    usdiSampleRelease(handle);
+
+    printf("TestImportSampleHandle: %s\n", ret ? "succeeded" : "failed");
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportScheduler(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    usdi::UpdateSchedulerSettings settings;
+    usdi::UpdateReport report;
+    auto *child = usdiFindSchema(ctx, "/Child");
+    usdiPrimSetUpdatePriority(child, settings.critical_priority);
+
+    // too small budget. only critical schemas are updated.
+    settings.time_budget = 0.000001;
+    usdiSchedulerSetSettings(ctx, &settings);
+    usdiSchedulerUpdate(ctx, 0.0, &report);
+    bool ret = report.num_updated > 0;
+    for (int i = 0; i < report.num_skipped; ++i) {
+        if (usdiSchedulerGetSkipped(ctx, i) == child) { ret = false; }
+    }
+    printf("  budget %lf: %d updated, %d skipped, %lfms\n", settings.time_budget, report.num_updated, report.num_skipped, report.elapsed);
+
+    // unlimited
+    settings.time_budget = 0.0;
+    usdiSchedulerSetSettings(ctx, &settings);
+    usdiSchedulerUpdate(ctx, 1.0, &report);
+    ret = ret && report.num_skipped == 0;
+    printf("  unlimited: %d updated, %d skipped, %lfms\n", report.num_updated, report.num_skipped, report.elapsed);
+
+    printf("TestImportScheduler: %s\n", ret ? "succeeded" : "failed");
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+// instances share the prim of the master but must be prioritized by their own positions
+bool TestImportSchedulerInstances(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    auto *near_child = usdiPrimGetChild(usdiFindSchema(ctx, "/Inst1"), 0);
+    auto *far_child = usdiPrimGetChild(usdiFindSchema(ctx, "/Inst2"), 0);
+
+    // view is at /Inst1/Child (x flipped by swap_handedness). only it is critical.
+    usdi::float3 view = { -1.0f, 1.0f, 0.0f };
+    usdi::UpdateSchedulerSettings settings;
+    settings.critical_priority = 1000.0f;
+    settings.time_budget = 0.000001;
+    usdiSchedulerSetSettings(ctx, &settings);
+    usdiSchedulerSetViewPosition(ctx, &view);
+
+    usdi::UpdateReport report;
+    usdiSchedulerUpdate(ctx, 0.0, &report);
+    bool near_skipped = false, far_skipped = false;
+    for (int i = 0; i < report.num_skipped; ++i) {
+        auto *s = usdiSchedulerGetSkipped(ctx, i);
+        if (s == near_child) { near_skipped = true; }
+        if (s == far_child) { far_skipped = true; }
+    }
+    bool ret = near_child && far_child && !near_skipped && far_skipped;
+
+    printf("TestImportSchedulerInstances: %s\n", ret ? "succeeded" : "failed");
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+bool TestImportInstances(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    auto *master = usdiGetNumMasters(ctx) == 1 ? usdiGetMaster(ctx, 0) : nullptr;
+    auto *master_child = master ? usdiPrimGetChild(master, 0) : nullptr;
+    auto *inst1 = usdiFindSchema(ctx, "/Inst1");
+    auto *inst2 = usdiFindSchema(ctx, "/Inst2");
+    bool ret = master && master_child && inst1 && inst2 &&
+        usdiPrimIsMaster(master) &&
+        !usdiPrimIsInstance(usdiFindSchema(ctx, "/Proto")) &&
+        usdiPrimIsInstance(inst1) && usdiPrimIsInstanceable(inst1) &&
+        usdiPrimIsInstance(inst2) && usdiPrimIsInstanceable(inst2) &&
+        usdiPrimGetMaster(usdiPrimGetChild(inst1, 0)) == master_child &&
+        usdiPrimGetMaster(usdiPrimGetChild(inst2, 0)) == master_child &&
+        usdiPrimGetNumInstances(master_child) == 2;
+
+    // (x, 1, 0) with x flipped by swap_handedness
+    usdi::float4x4 transforms[2];
+    ret = ret && usdiPrimGetInstanceTransforms(master_child, transforms, 2, 0.0) == 2;
+    for (int i = 0; ret && i < 2; ++i) {
+        auto *instance = usdiPrimGetInstance(master_child, i);
+        float x = usdiPrimGetParent(instance) == inst1 ? -1.0f : -100.0f;
+        const auto& t = transforms[i].v[3];
+        ret = t.x == x && t.y == 1.0f && t.z == 0.0f;
+    }
+
+    printf("TestImportInstances: %s\n", ret ? "succeeded" : "failed");
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+// texels as RGBA float regardless of half_precision
+static std::vector<float4> DecodeTexels(const std::vector<char>& src, const usdi::VertexAnimationInfo& info)
+{
+    std::vector<float4> ret((size_t)info.width * info.height);
+    if (info.half_precision) {
+        mu::HalfToFloat((float*)ret.data(), (const uint16_t*)src.data(), ret.size() * 4);
+    }
+    else {
+        memcpy(ret.data(), src.data(), src.size());
+    }
+    return ret;
+}
+
+// compare decoded points and normals of all frames with samples of the mesh
+static bool VerifyVertexAnimation(usdi::Mesh *mesh, const usdi::VertexAnimationInfo& info,
+    const std::vector<char>& points_texels, const std::vector<char>& normals_texels)
+{
+    auto points = DecodeTexels(points_texels, info);
+    auto normals = DecodeTexels(normals_texels, info);
+    auto decode = [](float t, float bmin, float bmax) { return bmin + (bmax - bmin) * t; };
+    float3 extents = {
+        info.bounds_max.x - info.bounds_min.x, info.bounds_max.y - info.bounds_min.y, info.bounds_max.z - info.bounds_min.z };
+    // half has 11 bit mantissa. encoded points are in [0, 1]
+    float eps = info.half_precision ? 1.0f / 1024.0f : 1e-5f;
+    auto nearly = [eps](float a, float b, float scale) { return std::abs(a - b) <= eps * (scale > 1.0f ? scale : 1.0f); };
+
+    bool ret = true;
+    for (int f = 0; ret && f < info.num_frames; ++f) {
+        usdi::MeshData data;
+        ret = usdiMeshReadSample(mesh, &data, info.start + info.interval * f, false) && data.normals;
+        for (int i = 0; ret && i < info.num_points; ++i) {
+            size_t ti = (size_t)(f * info.rows_per_frame + i / info.width) * info.width + i % info.width;
+            const auto& p = points[ti];
+            const auto& n = normals[ti];
+            ret =
+                nearly(decode(p.x, info.bounds_min.x, info.bounds_max.x), data.points[i].x, extents.x) &&
+                nearly(decode(p.y, info.bounds_min.y, info.bounds_max.y), data.points[i].y, extents.y) &&
+                nearly(decode(p.z, info.bounds_min.z, info.bounds_max.z), data.points[i].z, extents.z) &&
+                nearly(n.x, data.normals[i].x, 1.0f) && nearly(n.y, data.normals[i].y, 1.0f) && nearly(n.z, data.normals[i].z, 1.0f);
+        }
+    }
+    return ret;
+}
+
+// bake textures and upload them to the null device. textures created from va and overwritten by va_write must
+// have the texels of va_write.
+static bool TestVertexAnimationTextures(usdi::VertexAnimation *va, usdi::VertexAnimation *va_write)
+{
+    if (!usdiGfxCreateNullDevice(0.0, 0.0, false)) {
+        printf("  textures: skipped (graphics interface is not available)\n");
+        return true;
+    }
+
+    usdi::VertexAnimationInfo info;
+    usdiVtxAnimGetInfo(va_write, &info);
+    size_t size = (size_t)info.width * info.height * info.texel_size;
+    std::vector<char> expected_points(size), expected_normals(size), points(size), normals(size);
+    usdiVtxAnimReadTexels(va_write, expected_points.data(), expected_normals.data());
+
+    void *points_tex = nullptr, *normals_tex = nullptr;
+    bool ret =
+        usdiVtxAnimCreateTextures(va, &points_tex, &normals_tex) && points_tex && normals_tex &&
+        usdiVtxAnimWriteTextures(va_write, points_tex, normals_tex) &&
+        usdiGfxReadTexture(points.data(), points_tex, info.width, info.height, info.half_precision) &&
+        usdiGfxReadTexture(normals.data(), normals_tex, info.width, info.height, info.half_precision) &&
+        points == expected_points && normals == expected_normals;
+    usdiGfxReleaseTexture(points_tex);
+    usdiGfxReleaseTexture(normals_tex);
+    usdiGfxReleaseDevice();
+    printf("  textures: %s\n", ret ? "succeeded" : "failed");
+    return ret;
+}
+
+bool TestImportVertexAnimation(const char *path)
+{
+    if (!path) { return false; }
+
+    auto *ctx = usdiCreateContext();
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    bool ret = false;
+    auto *mesh = usdiAsMesh(usdiFindSchema(ctx, "/VertexAnimMesh"));
+    if (mesh) {
+        ret = true;
+        for (int half = 0; half < 2; ++half) {
+            // 10 points wrap into 3 rows per frame
+            usdi::VertexAnimationSettings settings;
+            settings.start = 0.0;
+            settings.end = 4.0 / 30.0;
+            settings.interval = 1.0 / 30.0;
+            settings.max_width = 4;
+            settings.half_precision = half != 0;
+            auto *va = usdiMeshBakeVertexAnimation(mesh, &settings);
+
+            usdi::VertexAnimationInfo info;
+            if (va) { usdiVtxAnimGetInfo(va, &info); }
+            bool baked =
+                va && info.num_frames == 5 && info.num_points == 10 && info.width == 4 && info.rows_per_frame == 3 &&
+                info.height == 15 && info.has_normals && info.half_precision == settings.half_precision &&
+                info.texel_size == (half ? (int)sizeof(uint16_t) * 4 : (int)sizeof(float4));
+            printf("  %s: %d frames, %d points, %dx%d texels\n", half ? "half" : "float",
+                info.num_frames, info.num_points, info.width, info.height);
+
+            bool verified = false;
+            if (baked) {
+                size_t size = (size_t)info.width * info.height * info.texel_size;
+                std::vector<char> points(size), normals(size);
+                verified =
+                    usdiVtxAnimReadTexels(va, points.data(), normals.data()) &&
+                    VerifyVertexAnimation(mesh, info, points, normals);
+            }
+
+            // same size, texels of the next frames
+            settings.start += settings.interval;
+            settings.end += settings.interval;
+            auto *va_write = baked ? usdiMeshBakeVertexAnimation(mesh, &settings) : nullptr;
+            bool textures = va_write && TestVertexAnimationTextures(va, va_write);
+
+            ret = ret && baked && verified && textures;
+            usdiVtxAnimRelease(va_write);
+            usdiVtxAnimRelease(va);
+        }
+    }
+
+    printf("TestImportVertexAnimation: %s\n", ret ? "succeeded" : "failed");
+    usdiDestroyContext(ctx);
+    return ret;
+}
+
+static void PumpStreamer(usdi::Context *ctx, int& num_loaded, int& num_unloaded)
+{
+    usdiStreamerWait(ctx);
+    usdiStreamerUpdate(ctx);
+    usdi::PayloadEvent ev;
+    while (usdiStreamerPopEvent(ctx, &ev)) {
+        if (ev.type == usdi::PayloadEvent::Type::Loaded) { ++num_loaded; }
+        else if (ev.type == usdi::PayloadEvent::Type::Unloaded) { ++num_unloaded; }
+    }
+}
+
+bool TestImportPayloadStreamer(const char *path)
+{
+    if (!path) { return false; }
+
+    // /A, /B, /C and /D have payloads of the same size in their own files. /E shares the payload file of /A.
+    {
+        const char *payloads[] = { "StreamerPayloadA.usda", "StreamerPayloadB.usda", "StreamerPayloadC.usda", "StreamerPayloadD.usda" };
+        for (auto *payload : payloads) {
+            auto *ctx = usdiCreateContext();
+            usdiCreateStage(ctx, payload);
+            auto *xf = usdiCreateXform(ctx, usdiGetRoot(ctx), "Payload");
+            usdiCreateXform(ctx, xf, "Child");
+            usdiSave(ctx);
+            usdiDestroyContext(ctx);
+        }
+
+        auto *ctx = usdiCreateContext();
+        usdiCreateStage(ctx, path);
+        const char *names[] = { "/A", "/B", "/C", "/D" };
+        for (int i = 0; i < 4; ++i) {
+            usdiPrimSetPayload(usdiCreateOverride(ctx, names[i]), payloads[i], "/Payload");
+        }
+        usdiPrimSetPayload(usdiCreateOverride(ctx, "/E"), payloads[0], "/Payload");
+        usdiSave(ctx);
+        usdiDestroyContext(ctx);
+    }
+
+    auto *ctx = usdiCreateContext();
+    usdi::PayloadStreamerSettings settings;
+    settings.max_loads_per_update = 4;
+    usdiStreamerSetSettings(ctx, &settings);
+    if (!usdiOpen(ctx, path)) {
+        printf("failed to load %s\n", path);
+        usdiDestroyContext(ctx);
+        return false;
+    }
+
+    // payloads must not be loaded by usdiOpen() if the streamer is in use
+    bool ret = usdiFindSchema(ctx, "/A/Child") == nullptr && usdiStreamerGetResidentSize(ctx) == 0;
+
+    int num_loaded = 0, num_unloaded = 0;
+    usdiStreamerRequestLoad(ctx, "/A", 1.0f);
+    PumpStreamer(ctx, num_loaded, num_unloaded);
+    size_t size = usdiStreamerGetResidentSize(ctx);
+    ret = ret && num_loaded == 1 && size > 0;
+
+    settings.memory_budget = size * 2;
+    usdiStreamerSetSettings(ctx, &settings);
+    usdiStreamerRequestLoad(ctx, "/B", 2.0f);
+    PumpStreamer(ctx, num_loaded, num_unloaded);
+    ret = ret && num_loaded == 2 && num_unloaded == 0;
+
+    // lower priority than all loaded ones. deferred without evicting anything and its prefetched layers are released.
+    usdiStreamerRequestLoad(ctx, "/C", 0.0f);
+    PumpStreamer(ctx, num_loaded, num_unloaded);
+    PumpStreamer(ctx, num_loaded, num_unloaded);
+    ret = ret && num_loaded == 2 && num_unloaded == 0 && usdiStreamerGetResidentSize(ctx) == size * 2;
+
+    // the layer is shared with /A. it costs nothing.
+    usdiStreamerRequestLoad(ctx, "/E", 0.5f);
+    PumpStreamer(ctx, num_loaded, num_unloaded);
+    ret = ret && num_loaded == 3 && num_unloaded == 0 && usdiStreamerGetResidentSize(ctx) == size * 2;
+
+    // higher priority. /E and /A (the lowest) are evicted. /E alone frees nothing.
+    usdiStreamerRequestUnload(ctx, "/C");
+    usdiStreamerRequestLoad(ctx, "/D", 3.0f);
+    PumpStreamer(ctx, num_loaded, num_unloaded);
+    ret = ret && num_loaded == 4 && num_unloaded == 2 && usdiStreamerGetResidentSize(ctx) <= settings.memory_budget;
+    printf("  %d loaded, %d unloaded, resident %d / %d\n", num_loaded, num_unloaded,
+        (int)usdiStreamerGetResidentSize(ctx), (int)settings.memory_budget);
+
+    usdiRebuildSchemaTree(ctx);
+    ret = ret && usdiFindSchema(ctx, "/A/Child") == nullptr && usdiFindSchema(ctx, "/D/Child") != nullptr;
+
+    printf("TestImportPayloadStreamer: %s\n", ret ? "succeeded" : "failed");
+    usdiDestroyContext(ctx);
+    return ret;
+}
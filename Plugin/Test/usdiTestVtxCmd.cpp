@@ -0,0 +1,311 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include "../usdi/usdi.h"
+#include "../usdi/ext/usdiExt.h"
+
+using usdi::float2;
+using usdi::float3;
+using usdi::float4;
+
+struct TestVertex
+{
+    float3 p;
+    float3 n;
+    float2 u;
+};
+
+struct TestMeshBuffer
+{
+    std::vector<float3> points;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    usdi::MeshData data;
+    void *vb = nullptr;
+    usdi::Handle cmd = 0;
+
+    TestMeshBuffer(int num_points, const char *name)
+    {
+        points.resize(num_points);
+        normals.resize(num_points);
+        uvs.resize(num_points);
+        for (int i = 0; i < num_points; ++i) {
+            points[i] = { (float)i, 0.0f, 0.0f };
+            normals[i] = { 0.0f, 1.0f, 0.0f };
+            uvs[i] = { (float)i / num_points, 0.5f };
+        }
+        data.points = points.data();
+        data.normals = normals.data();
+        data.uvs = uvs.data();
+        data.num_points = num_points;
+
+        vb = usdiGfxCreateVertexBuffer(sizeof(TestVertex) * num_points);
+        cmd = usdiVtxCmdCreate(name);
+    }
+
+    ~TestMeshBuffer()
+    {
+        usdiVtxCmdDestroy(cmd);
+        usdiGfxReleaseVertexBuffer(vb);
+    }
+
+    void animate(float t)
+    {
+        for (size_t i = 0; i < points.size(); ++i) {
+            points[i].y = t;
+        }
+    }
+
+    void update()
+    {
+        usdiVtxCmdUpdate(cmd, &data, vb, nullptr);
+    }
+
+    bool verify()
+    {
+        std::vector<TestVertex> vertices(points.size());
+        if (!usdiGfxReadVertexBuffer(vertices.data(), vb, sizeof(TestVertex) * vertices.size())) {
+            return false;
+        }
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            auto& v = vertices[i];
+            if (memcmp(&v.p, &points[i], sizeof(float3)) != 0 ||
+                memcmp(&v.n, &normals[i], sizeof(float3)) != 0 ||
+                memcmp(&v.u, &uvs[i], sizeof(float2)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+
+static bool TestVtxCmdUpload(bool upload_ring)
+{
+    if (!usdiGfxCreateNullDevice(0.0, 0.0, upload_ring)) {
+        return false;
+    }
+
+    bool ret = true;
+    {
+        TestMeshBuffer mesh(1000, "TestVtxCmd");
+
+        // first update writes all streams
+        mesh.update();
+        usdiVtxCmdProcess();
+        ret = ret && mesh.verify();
+
+        // only points changed. uvs and normals must be kept
+        mesh.animate(1.0f);
+        mesh.update();
+        usdiVtxCmdProcess();
+        ret = ret && mesh.verify();
+
+        // nothing changed
+        mesh.update();
+        usdiVtxCmdProcess();
+        ret = ret && mesh.verify();
+
+        // signs flip in pairs (y of even points and x of odd points are the upper halves of adjacent 8 byte words).
+        // the flipped bits cancel out in weak hashes and the change must not be missed
+        for (size_t i = 0; i + 1 < mesh.points.size(); i += 2) {
+            mesh.points[i].y = -mesh.points[i].y;
+            mesh.points[i + 1].x = -mesh.points[i + 1].x;
+        }
+        mesh.update();
+        usdiVtxCmdProcess();
+        ret = ret && mesh.verify();
+    }
+    usdiGfxReleaseDevice();
+    return ret;
+}
+
+// explicit layout with an attribute the mesh doesn't have. it must be written as zero.
+// colors have no source in usdi meshes and must not be in the vertex.
+static bool TestVtxCmdLayout()
+{
+    struct TangentVertex
+    {
+        float3 p;
+        float3 n;
+        float2 u;
+        float4 t;
+    };
+    const int VA_Points = 0x01, VA_Normals = 0x02, VA_UVs = 0x04, VA_Tangents = 0x08, VA_Colors = 0x10;
+
+    if (!usdiGfxCreateNullDevice(0.0, 0.0, true)) {
+        return false;
+    }
+
+    bool ret = true;
+    {
+        TestMeshBuffer mesh(1000, "TestVtxCmdLayout");
+        size_t num = mesh.points.size();
+        usdiGfxReleaseVertexBuffer(mesh.vb);
+        mesh.vb = usdiGfxCreateVertexBuffer(sizeof(TangentVertex) * num);
+        usdiVtxCmdSetVertexLayout(mesh.cmd, VA_Points | VA_Normals | VA_UVs | VA_Tangents | VA_Colors);
+
+        mesh.update();
+        usdiVtxCmdProcess();
+
+        std::vector<TangentVertex> vertices(num);
+        const float4 zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+        ret = usdiGfxReadVertexBuffer(vertices.data(), mesh.vb, sizeof(TangentVertex) * num);
+        for (size_t i = 0; ret && i < num; ++i) {
+            auto& v = vertices[i];
+            ret =
+                memcmp(&v.p, &mesh.points[i], sizeof(float3)) == 0 &&
+                memcmp(&v.n, &mesh.normals[i], sizeof(float3)) == 0 &&
+                memcmp(&v.u, &mesh.uvs[i], sizeof(float2)) == 0 &&
+                memcmp(&v.t, &zero, sizeof(float4)) == 0;
+        }
+    }
+    usdiGfxReleaseDevice();
+    return ret;
+}
+
+// dirty queue: only updated commands are processed, more than a batch (64) of commands go through, destroyed
+// commands are dropped from the queue and updates while process() is running are not lost.
+static bool TestVtxCmdQueue(bool upload_ring)
+{
+    const int num_meshes = 200;
+    const int num_points = 256;
+
+    // simulated latency and transfer make process() long enough for updates from the other thread to hit commands
+    // being processed
+    if (!usdiGfxCreateNullDevice(0.01, 1.0, upload_ring)) {
+        return false;
+    }
+
+    bool ret = true;
+    {
+        std::vector<std::unique_ptr<TestMeshBuffer>> meshes;
+        for (int i = 0; i < num_meshes; ++i) {
+            meshes.emplace_back(new TestMeshBuffer(num_points, "TestVtxCmdQueue"));
+        }
+
+        // multiple batches
+        for (auto& m : meshes) {
+            m->animate(1.0f);
+            m->update();
+        }
+        usdiVtxCmdProcess();
+        for (auto& m : meshes) { ret = ret && m->verify(); }
+
+        // sources of all meshes change, but only even ones are updated. odd ones must keep the contents of frame 1.
+        for (int i = 0; i < num_meshes; ++i) {
+            meshes[i]->animate(2.0f);
+            if (i % 2 == 0) { meshes[i]->update(); }
+        }
+        usdiVtxCmdProcess();
+        for (int i = 0; i < num_meshes; ++i) {
+            if (i % 2 != 0) { meshes[i]->animate(1.0f); }
+            ret = ret && meshes[i]->verify();
+        }
+
+        // destroy queued commands with their buffers. process() must skip them.
+        for (int i = 0; i < num_meshes; i += 3) {
+            meshes[i]->animate(3.0f);
+            meshes[i]->update();
+        }
+        for (int i = 0; i < num_meshes; i += 6) {
+            meshes[i].reset();
+        }
+        usdiVtxCmdProcess();
+        for (auto& m : meshes) {
+            if (m) { ret = ret && m->verify(); }
+        }
+
+        // update while another thread is processing. the last update of each command must be on the buffer at last.
+        // sources are not modified after update() as they may be read by process().
+        const int num_frames = 50;
+        std::vector<std::vector<float3>> frames(num_frames, std::vector<float3>(num_points));
+        for (int f = 0; f < num_frames; ++f) {
+            for (int i = 0; i < num_points; ++i) {
+                frames[f][i] = { (float)i, 10.0f + f, 0.0f };
+            }
+        }
+        std::atomic_bool done = { false };
+        std::thread processor([&done]() {
+            while (!done) { usdiVtxCmdProcess(); }
+        });
+        for (auto& points : frames) {
+            for (auto& m : meshes) {
+                if (!m) { continue; }
+                m->data.points = points.data();
+                m->update();
+            }
+            // spread updates over multiple process()
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        done = true;
+        processor.join();
+        usdiVtxCmdProcess();
+        for (auto& m : meshes) {
+            if (!m) { continue; }
+            m->points = frames.back();
+            m->data.points = m->points.data();
+            ret = ret && m->verify();
+        }
+    }
+    usdiGfxReleaseDevice();
+    return ret;
+}
+
+static void BenchmarkVtxCmd(const char *name, double map_latency_ms, double bandwidth_gb, bool upload_ring)
+{
+    const int num_meshes = 256;
+    const int num_points = 4096;
+    const int num_frames = 30;
+
+    if (!usdiGfxCreateNullDevice(map_latency_ms, bandwidth_gb, upload_ring)) {
+        return;
+    }
+    {
+        std::vector<std::unique_ptr<TestMeshBuffer>> meshes;
+        for (int i = 0; i < num_meshes; ++i) {
+            meshes.emplace_back(new TestMeshBuffer(num_points, name));
+        }
+
+        using namespace std::chrono;
+        auto start = steady_clock::now();
+        for (int f = 0; f < num_frames; ++f) {
+            for (auto& m : meshes) {
+                m->animate((float)f);
+                m->update();
+            }
+            usdiVtxCmdProcess();
+        }
+        auto elapsed = duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count();
+        printf("    %s: avg. %f ms / frame\n", name, elapsed / num_frames);
+    }
+    usdiGfxReleaseDevice();
+}
+
+bool TestVtxCmd()
+{
+    if (!usdiGfxCreateNullDevice(0.0, 0.0, true)) {
+        printf("TestVtxCmd: skipped (graphics interface is not available)\n");
+        return true;
+    }
+    usdiGfxReleaseDevice();
+
+    bool ring = TestVtxCmdUpload(true);
+    bool map = TestVtxCmdUpload(false);
+    bool layout = TestVtxCmdLayout();
+    bool queue = TestVtxCmdQueue(true) && TestVtxCmdQueue(false);
+    printf("TestVtxCmd: upload ring %s, map %s, layout %s, queue %s\n",
+        ring ? "succeeded" : "failed", map ? "succeeded" : "failed", layout ? "succeeded" : "failed",
+        queue ? "succeeded" : "failed");
+
+    // 256 meshes * 4096 vertices, simulated 20us round trip per map and 8 GB/s transfer
+    BenchmarkVtxCmd("upload ring", 0.02, 8.0, true);
+    BenchmarkVtxCmd("map / unmap", 0.02, 8.0, false);
+    printf("\n");
+    return ring && map && layout && queue;
+}
@@ -5,7 +5,26 @@ void MeshUtilsTest();
 void TestExport(const char *filename);
 void TestExportHighMesh(const char *filename);
 void TestExportReference(const char *filename, const char *flatten);
+void TestExportInstances(const char *filename);
+void TestExportWriteFrame();
+void TestExportDeduplicate(const char *filename, const char *reference);
+void TestExportClips(const char *filename);
+void TestExportAsyncSave(const char *filename, const char *flatten);
+void TestExportVertexAnimation(const char *filename);
 bool TestImport(const char *path);
+bool TestImportVariantSwitch(const char *path);
+bool TestImportMaskedAndLazy(const char *path);
+bool TestImportAsync(const char *path);
+bool TestImportPathQueries(const char *path);
+bool TestImportAttributeBatch(const char *path);
+bool TestImportAttributeCache(const char *path);
+bool TestImportSampleHandle(const char *path);
+bool TestImportScheduler(const char *path);
+bool TestImportInstances(const char *path);
+bool TestImportSchedulerInstances(const char *path);
+bool TestImportVertexAnimation(const char *path);
+bool TestImportPayloadStreamer(const char *path);
+bool TestVtxCmd();
 
 extern "C" {
 
@@ -18,9 +37,29 @@ testsAPI void TestMain(int argc, char *argv[])
     TestExportHighMesh("HighMesh.usda");
     TestExportHighMesh("HighMesh.usdc");
     TestExportReference("TestReference.usda", "Flatten.usda");
+    TestExportInstances("Instances.usda");
+    TestExportWriteFrame();
+    TestExportDeduplicate("Deduplicate.usda", "DeduplicateReference.usda");
+    TestExportClips("Clips.usda");
+    TestExportAsyncSave("AsyncSave.usdc", "AsyncSaveFlatten.usdc");
+    TestExportVertexAnimation("VertexAnimation.usda");
 
     TestImport("TestExport.usda");
     TestImport("TestReference.usda");
+    TestImportVariantSwitch("TestExport.usda");
+    TestImportMaskedAndLazy("TestExport.usda");
+    TestImportAsync("TestExport.usda");
+    TestImportPathQueries("TestExport.usda");
+    TestImportAttributeBatch("TestExport.usda");
+    TestImportAttributeCache("TestExport.usda");
+    TestImportSampleHandle("TestExport.usda");
+    TestImportScheduler("TestExport.usda");
+    TestImportInstances("Instances.usda");
+    TestImportSchedulerInstances("Instances.usda");
+    TestImportVertexAnimation("VertexAnimation.usda");
+    TestImportPayloadStreamer("Streamer.usda");
+
+    TestVtxCmd();
 }
 
 } // extern "C"
@@ -9,6 +9,7 @@
 #include "usdiMesh.h"
 #include "usdiPoints.h"
 #include "usdiContext.h"
+#include "usdiVertexAnimation.h"
 
 #include "etc/Mono.h"
 #include "usdiExt.h"
@@ -71,6 +72,14 @@ usdiAPI void usdiVtxCmdUpdateSub(usdi::Handle h, const usdi::SubmeshData *src, v
 #endif
 }
 
+usdiAPI void usdiVtxCmdSetVertexLayout(usdi::Handle h, int attributes)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    usdi::VertexCommandManager::getInstance().setVertexLayout(h, attributes);
+#endif
+}
+
 usdiAPI void usdiVtxCmdProcess()
 {
 #ifdef usdiEnableGraphicsInterface
@@ -90,6 +99,142 @@ usdiAPI void usdiVtxCmdWait()
 }
 
 
+usdiAPI bool usdiGfxCreateNullDevice(double map_latency_ms, double bandwidth_gb, bool upload_ring)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    gi::NullDeviceSettings settings;
+    settings.map_latency_ms = map_latency_ms;
+    settings.bandwidth_gb = bandwidth_gb;
+    settings.upload_ring = upload_ring;
+    gi::ReleaseGraphicsInterface();
+    return gi::CreateGraphicsInterface(gi::DeviceType::Null, &settings) != nullptr;
+#else
+    return false;
+#endif
+}
+
+usdiAPI void usdiGfxReleaseDevice()
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    gi::ReleaseGraphicsInterface();
+#endif
+}
+
+usdiAPI void* usdiGfxCreateVertexBuffer(size_t size)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs) { return nullptr; }
+
+    void *ret = nullptr;
+    ifs->createBuffer(&ret, size, gi::BufferType::Vertex, nullptr, gi::ResourceFlags::CPU_Write);
+    return ret;
+#else
+    return nullptr;
+#endif
+}
+
+usdiAPI void usdiGfxReleaseVertexBuffer(void *vb)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs || !vb) { return; }
+    ifs->releaseBuffer(vb);
+#endif
+}
+
+usdiAPI bool usdiGfxReadVertexBuffer(void *dst, void *vb, size_t size)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs || !vb) { return false; }
+    return ifs->readBuffer(dst, vb, size, gi::BufferType::Vertex) == gi::Result::OK;
+#else
+    return false;
+#endif
+}
+
+usdiAPI bool usdiVtxAnimCreateTextures(usdi::VertexAnimation *va, void **dst_points_tex, void **dst_normals_tex)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs || !va || !dst_points_tex || !va->getPointsTexels()) { return false; }
+
+    const auto& info = va->getInfo();
+    auto format = info.half_precision ? gi::TextureFormat::RGBAf16 : gi::TextureFormat::RGBAf32;
+    if (ifs->createTexture2D(dst_points_tex, info.width, info.height, format, va->getPointsTexels(), gi::ResourceFlags::None) != gi::Result::OK) {
+        return false;
+    }
+    if (dst_normals_tex) {
+        *dst_normals_tex = nullptr;
+        if (va->getNormalsTexels() &&
+            ifs->createTexture2D(dst_normals_tex, info.width, info.height, format, va->getNormalsTexels(), gi::ResourceFlags::None) != gi::Result::OK)
+        {
+            ifs->releaseTexture2D(*dst_points_tex);
+            *dst_points_tex = nullptr;
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+usdiAPI bool usdiVtxAnimWriteTextures(usdi::VertexAnimation *va, void *points_tex, void *normals_tex)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    usdiVTuneScope("usdiVtxAnimWriteTextures");
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs || !va || !va->getPointsTexels()) { return false; }
+
+    const auto& info = va->getInfo();
+    auto format = info.half_precision ? gi::TextureFormat::RGBAf16 : gi::TextureFormat::RGBAf32;
+    bool ret = true;
+    if (points_tex) {
+        ret = ifs->writeTexture2D(points_tex, info.width, info.height, format, va->getPointsTexels(), va->getTextureSize()) == gi::Result::OK;
+    }
+    if (ret && normals_tex && va->getNormalsTexels()) {
+        ret = ifs->writeTexture2D(normals_tex, info.width, info.height, format, va->getNormalsTexels(), va->getTextureSize()) == gi::Result::OK;
+    }
+    return ret;
+#else
+    return false;
+#endif
+}
+
+usdiAPI void usdiGfxReleaseTexture(void *tex)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs || !tex) { return; }
+    ifs->releaseTexture2D(tex);
+#endif
+}
+
+usdiAPI bool usdiGfxReadTexture(void *dst, void *tex, int width, int height, bool half_precision)
+{
+#ifdef usdiEnableGraphicsInterface
+    usdiTraceFunc();
+    auto ifs = gi::GetGraphicsInterface();
+    if (!ifs || !dst || !tex) { return false; }
+    auto format = half_precision ? gi::TextureFormat::RGBAf16 : gi::TextureFormat::RGBAf32;
+    size_t size = (size_t)width * height * (half_precision ? sizeof(uint16_t) * 4 : sizeof(float) * 4);
+    return ifs->readTexture2D(dst, size, tex, width, height, format) == gi::Result::OK;
+#else
+    return false;
+#endif
+}
+
+
 
 
 usdiAPI void usdiTaskDestroy(usdi::Task *t)
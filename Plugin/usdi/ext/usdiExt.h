@@ -18,9 +18,30 @@ usdiAPI usdi::Handle    usdiVtxCmdCreate(const char *dbg_name);
 usdiAPI void            usdiVtxCmdDestroy(usdi::Handle h);
 usdiAPI void            usdiVtxCmdUpdate(usdi::Handle h, const usdi::MeshData *src, void *vb, void *ib);
 usdiAPI void            usdiVtxCmdUpdateSub(usdi::Handle h, const usdi::SubmeshData *src, void *vb, void *ib);
+// attributes: combination of Points = 0x01, Normals = 0x02, UVs = 0x04, Tangents = 0x08, Weights4 = 0x40. other bits are ignored.
+// attributes are placed in this order in a vertex. 0: selected by the sample (points, normals [, uvs [, tangents]]).
+usdiAPI void            usdiVtxCmdSetVertexLayout(usdi::Handle h, int attributes);
 usdiAPI void            usdiVtxCmdProcess();
 usdiAPI void            usdiVtxCmdWait();
 
+// headless graphics device (buffers are in host memory) for tests and benchmarks of vertex commands.
+// map_latency_ms and bandwidth_gb simulate the cost of a real device (0: no cost). these replace the device given by Unity.
+usdiAPI bool            usdiGfxCreateNullDevice(double map_latency_ms, double bandwidth_gb, bool upload_ring);
+usdiAPI void            usdiGfxReleaseDevice();
+usdiAPI void*           usdiGfxCreateVertexBuffer(size_t size);
+usdiAPI void            usdiGfxReleaseVertexBuffer(void *vb);
+usdiAPI bool            usdiGfxReadVertexBuffer(void *dst, void *vb, size_t size);
+
+// textures of a baked vertex animation (usdiMeshBakeVertexAnimation()). RGBA float or half by VertexAnimationInfo::half_precision.
+// create: e.g. for Texture2D.CreateExternalTexture(). dst_normals_tex is set to null if normals are not baked.
+// textures are released by usdiGfxReleaseTexture().
+usdiAPI bool            usdiVtxAnimCreateTextures(usdi::VertexAnimation *va, void **dst_points_tex, void **dst_normals_tex);
+// write: into existing textures of same size and format (e.g. Texture.GetNativeTexturePtr()). call on the render thread.
+usdiAPI bool            usdiVtxAnimWriteTextures(usdi::VertexAnimation *va, void *points_tex, void *normals_tex);
+usdiAPI void            usdiGfxReleaseTexture(void *tex);
+// dst: width * height RGBA float or half texels (half_precision). for tests.
+usdiAPI bool            usdiGfxReadTexture(void *dst, void *tex, int width, int height, bool half_precision);
+
 usdiAPI void            usdiTaskDestroy(usdi::Task *t);
 usdiAPI void            usdiTaskRun(usdi::Task *t);
 usdiAPI bool            usdiTaskIsRunning(usdi::Task *t);
@@ -25,6 +25,28 @@ MonoThreadScope::~MonoThreadScope()
 
 
 #ifdef usdiEnableGraphicsInterface
+// zero filled memory for attributes in the vertex layout that the source doesn't have
+static const void* GetZeroBuffer(size_t size)
+{
+    static thread_local RawVector<char> s_zeros;
+    if (s_zeros.size() < size) {
+        s_zeros.resize(size);
+        memset(s_zeros.data(), 0, size);
+    }
+    return s_zeros.data();
+}
+
+// attributes that usdi::MeshData and usdi::SubmeshData have
+static const int SupportedVertexAttributes = VA_Points | VA_Normals | VA_UVs | VA_Tangents | VA_Weights4;
+
+template<class T>
+static inline void FillMissingSource(const T*& src, bool required, size_t num)
+{
+    if (required && !src) {
+        src = (const T*)GetZeroBuffer(sizeof(T) * num);
+    }
+}
+
 VertexUpdateCommand::VertexUpdateCommand(const char *dbg_name)
     : m_dbg_name(!dbg_name ? "" : dbg_name)
 {
@@ -35,6 +57,9 @@ VertexUpdateCommand::VertexUpdateCommand(const char *dbg_name)
     m_ctx_ib.mode = gi::MapMode::Write;
     m_ctx_ib.type = gi::BufferType::Vertex;
     m_ctx_ib.keep_staging_resource = true;
+
+    m_up_vb.type = gi::BufferType::Vertex;
+    m_up_ib.type = gi::BufferType::Vertex;
 }
 
 VertexUpdateCommand::~VertexUpdateCommand()
@@ -44,100 +69,235 @@ VertexUpdateCommand::~VertexUpdateCommand()
     ifs->releaseStagingResource(m_ctx_ib);
 }
 
-void VertexUpdateCommand::update(const usdi::MeshData *data, void *vb, void *ib)
+bool VertexUpdateCommand::update(const usdi::MeshData *data, void *vb, void *ib)
 {
-    m_src_points    = data->points;
-    m_src_normals   = data->normals;
-    m_src_uvs       = data->uvs;
-    m_src_tangents  = data->tangents;
+    m_src.points    = data->points;
+    m_src.normals   = data->normals;
+    m_src.uvs       = data->uvs;
+    m_src.tangents  = data->tangents;
+    m_src.weights   = data->max_bone_weights == 4 ? (const weights4*)data->weights4 : nullptr;
     m_src_indices   = data->indices_triangulated;
     m_num_points    = data->num_points;
     m_num_indices   = data->num_indices_triangulated;
 
-    m_ctx_vb.resource = vb;
-    m_ctx_ib.resource = ib;
-
-    m_dirty = true;
+    return updateChanges(vb, ib);
 }
 
-void VertexUpdateCommand::update(const usdi::SubmeshData *data, void *vb, void *ib)
+bool VertexUpdateCommand::update(const usdi::SubmeshData *data, void *vb, void *ib)
 {
-    m_src_points    = data->points;
-    m_src_normals   = data->normals;
-    m_src_uvs       = data->uvs;
-    m_src_tangents  = data->tangents;
+    m_src.points    = data->points;
+    m_src.normals   = data->normals;
+    m_src.uvs       = data->uvs;
+    m_src.tangents  = data->tangents;
+    // weights4 and weights8 share memory. 8 weights can't be interleaved as weights4
+    m_src.weights   = data->max_bone_weights == 4 ? (const weights4*)data->weights4 : nullptr;
     m_src_indices   = data->indices;
     m_num_points    = data->num_points;
     m_num_indices   = data->num_points; // num points == num indices on submesh
 
-    m_ctx_vb.resource = vb;
-    m_ctx_ib.resource = ib;
+    return updateChanges(vb, ib);
+}
+
+bool VertexUpdateCommand::updateChanges(void *vb, void *ib)
+{
+    // hash source streams to find what actually changed. this runs on the caller's (worker) thread, not on the render thread.
+    const void *data[NumStreams] = {
+        m_src.points, m_src.normals, m_src.uvs, m_src.tangents, m_src.colors, m_src.uv2, m_src.weights, m_src_indices };
+
+    // streams out of the layout are not written. don't waste time to hash them
+    auto layout = getVertexLayout();
+    int streams = layout.attributes | Stream_Indices;
+
+    int changed = 0;
+    for (int i = 0; i < NumStreams; ++i) {
+        int stream = 1 << i;
+        if ((streams & stream) == 0) { continue; }
+
+        size_t size = stream == Stream_Indices ?
+            sizeof(int) * m_num_indices : GetVertexAttributeSize(stream) * m_num_points;
+        uint64_t hash = data[i] ? Hash64(data[i], size) : 0;
+        if (hash != m_hashes[i]) {
+            m_hashes[i] = hash;
+            changed |= stream;
+        }
+    }
 
-    m_dirty = true;
+    // buffers or vertex layout changed: everything must be written
+    if (vb != m_ctx_vb.resource || ib != m_ctx_ib.resource ||
+        layout.attributes != m_prev_layout || m_num_points != m_prev_num_points)
+    {
+        changed = Stream_All;
+    }
+    m_prev_layout = layout.attributes;
+    m_prev_num_points = m_num_points;
+
+    m_ctx_vb.resource = m_up_vb.resource = vb;
+    m_ctx_ib.resource = m_up_ib.resource = ib;
+
+    if (changed) {
+        m_changed |= changed;
+        // only the first update after processing queues the command
+        return !m_dirty.exchange(true);
+    }
+    return false;
 }
 
-bool VertexUpdateCommand::isDirty() const
+void VertexUpdateCommand::setVertexLayout(int attributes)
 {
-    return m_dirty;
+    // updateChanges() sees the layout change and writes everything
+    m_layout = attributes & SupportedVertexAttributes;
 }
 
-void VertexUpdateCommand::map()
+VertexLayout VertexUpdateCommand::getVertexLayout() const
 {
-    auto ifs = gi::GetGraphicsInterface();
-    ifs->mapBuffer(m_ctx_vb);
-    if (m_src_indices) {
-        ifs->mapBuffer(m_ctx_ib);
+    int layout = m_layout;
+    if (layout != 0) {
+        return VertexLayout(layout);
     }
+
+    // vertex_v3n3, vertex_v3n3u2 or vertex_v3n3u2t4
+    int ret = VA_Points | VA_Normals;
+    if (m_src.uvs) {
+        ret |= VA_UVs;
+        if (m_src.tangents) {
+            ret |= VA_Tangents;
+        }
+    }
+    return VertexLayout(ret);
 }
 
-void VertexUpdateCommand::copy()
+size_t VertexUpdateCommand::getVertexBufferSize() const
 {
-    auto& buf = GetTemporaryBuffer();
+    return getVertexLayout().getStride() * m_num_points;
+}
 
-    if (m_ctx_vb.data_ptr) {
-        if (m_src_uvs) {
-            if (m_src_tangents) {
-                using vertex_t = vertex_v3n3u2t4;
-                vertex_t::source_t src = { m_src_points, m_src_normals, m_src_uvs, m_src_tangents };
-                InterleaveBuffered(buf, src, (size_t)m_num_points);
-            }
-            else {
-                using vertex_t = vertex_v3n3u2;
-                vertex_t::source_t src = { m_src_points, m_src_normals, m_src_uvs };
-                InterleaveBuffered(buf, src, (size_t)m_num_points);
-            }
+size_t VertexUpdateCommand::getIndexBufferSize() const
+{
+    return sizeof(uint16_t) * m_num_indices;
+}
+
+void VertexUpdateCommand::mapOrUpload(MapContext& mctx, UploadContext& uctx, size_t size)
+{
+    // sub-allocate in the upload ring if available. fall back to map the buffer itself.
+    auto ifs = gi::GetGraphicsInterface();
+    uctx.size = size;
+    if (size == 0 || ifs->beginUpload(uctx) != gi::Result::OK) {
+        uctx.data_ptr = nullptr;
+        ifs->mapBuffer(mctx);
+    }
+}
+
+void VertexUpdateCommand::unmapOrUpload(MapContext& mctx, UploadContext& uctx, size_t size)
+{
+    auto ifs = gi::GetGraphicsInterface();
+    if (uctx.data_ptr) {
+        if (ifs->endUpload(uctx) != gi::Result::OK) {
+            usdiLogError("VertexUpdateCommand::unmapOrUpload(): endUpload() failed (%s)\n", m_dbg_name.c_str());
         }
-        else {
-            using vertex_t = vertex_v3n3;
-            vertex_t::source_t src = { m_src_points, m_src_normals };
-            InterleaveBuffered(buf, src, (size_t)m_num_points);
+        // a stale slot must not be written by the next partial update
+        uctx.data_ptr = nullptr;
+    }
+    else if (mctx.data_ptr) {
+        // the buffer can be larger than the data
+        mctx.written_size = (unsigned int)size;
+        if (ifs->unmapBuffer(mctx) != gi::Result::OK) {
+            usdiLogError("VertexUpdateCommand::unmapOrUpload(): unmapBuffer() failed (%s)\n", m_dbg_name.c_str());
         }
-        memcpy(m_ctx_vb.data_ptr, buf.data(), buf.size());
+        mctx.data_ptr = nullptr;
+    }
+}
+
+void VertexUpdateCommand::map()
+{
+    m_processing = m_changed.exchange(0);
+
+    int layout_streams = getVertexLayout().attributes;
+    int vertex_streams = m_processing & layout_streams;
+    if (vertex_streams == layout_streams) {
+        mapOrUpload(m_ctx_vb, m_up_vb, getVertexBufferSize());
+    }
+    else if (vertex_streams != 0) {
+        // partial update. upload ring slots don't have the current contents, so map the buffer itself.
+        // copy() writes everything if the backend doesn't keep the contents.
+        gi::GetGraphicsInterface()->mapBuffer(m_ctx_vb);
+    }
+
+    if (m_src_indices && (m_processing & Stream_Indices)) {
+        mapOrUpload(m_ctx_ib, m_up_ib, getIndexBufferSize());
+    }
+
+    // retry in the next process() if mapping failed
+    if (vertex_streams != 0 && !m_up_vb.data_ptr && !m_ctx_vb.data_ptr) {
+        m_changed |= vertex_streams;
+    }
+    if (m_src_indices && (m_processing & Stream_Indices) && !m_up_ib.data_ptr && !m_ctx_ib.data_ptr) {
+        m_changed |= Stream_Indices;
+    }
+}
+
+void VertexUpdateCommand::copyVertices(void *dst, bool direct, bool partial)
+{
+    auto layout = getVertexLayout();
+    auto src = m_src;
+    size_t num = (size_t)m_num_points;
+    FillMissingSource(src.points, layout.has(VA_Points), num);
+    FillMissingSource(src.normals, layout.has(VA_Normals), num);
+    FillMissingSource(src.uvs, layout.has(VA_UVs), num);
+    FillMissingSource(src.tangents, layout.has(VA_Tangents), num);
+    FillMissingSource(src.weights, layout.has(VA_Weights4), num);
+
+    if (partial) {
+        InterleavePartial(dst, layout, m_processing, src, num);
+    }
+    else {
+        InterleaveMapped(dst, layout, src, num, direct);
     }
+}
 
-    if (m_ctx_ib.data_ptr && m_src_indices) {
+void VertexUpdateCommand::copy()
+{
+    void *dst_vb = m_up_vb.data_ptr ? m_up_vb.data_ptr : m_ctx_vb.data_ptr;
+    void *dst_ib = m_up_ib.data_ptr ? m_up_ib.data_ptr : m_ctx_ib.data_ptr;
+    // write straight into mapped memory unless the backend reports it can't be written in parallel
+    bool direct_vb = m_up_vb.data_ptr || !m_ctx_vb.write_combined;
+    bool direct_ib = m_up_ib.data_ptr || !m_ctx_ib.write_combined;
+
+    if (dst_vb && m_num_points > 0) {
+        int layout_streams = getVertexLayout().attributes;
+        bool partial =
+            !m_up_vb.data_ptr && m_ctx_vb.keeps_contents && direct_vb &&
+            (m_processing & layout_streams) != layout_streams;
+        copyVertices(dst_vb, direct_vb, partial);
+    }
+
+    if (dst_ib && m_src_indices) {
         // Unity's mesh index is 16 bit
         // convert 32 bit indices -> 16 bit indices
-        using index_t = uint16_t;
-        buf.resize(sizeof(index_t) * m_num_indices);
-        index_t *indices = (index_t*)buf.data();
-        for (size_t i = 0; i < m_num_indices; ++i) {
-            indices[i] = (index_t)m_src_indices[i];
+        if (direct_ib) {
+            Int32ToUInt16Stream((uint16_t*)dst_ib, m_src_indices, m_num_indices);
+        }
+        else {
+            // the temporary buffer is read by memcpy() right after. regular stores keep it in the cache.
+            auto& buf = GetTemporaryBuffer();
+            buf.resize(getIndexBufferSize());
+            Int32ToUInt16((uint16_t*)buf.data(), m_src_indices, m_num_indices);
+            memcpy(dst_ib, buf.data(), buf.size());
         }
-        memcpy(m_ctx_ib.data_ptr, buf.data(), buf.size());
     }
 }
 
 void VertexUpdateCommand::unmap()
 {
-    auto ifs = gi::GetGraphicsInterface();
-    ifs->unmapBuffer(m_ctx_vb);
-    ifs->unmapBuffer(m_ctx_ib);
+    unmapOrUpload(m_ctx_vb, m_up_vb, getVertexBufferSize());
+    unmapOrUpload(m_ctx_ib, m_up_ib, getIndexBufferSize());
 }
 
-void VertexUpdateCommand::clearDirty()
+bool VertexUpdateCommand::clearDirty()
 {
+    m_processing = 0;
     m_dirty = false;
+    // update() was called while processing. if update() saw m_dirty == false it has queued the command by itself
+    return m_changed != 0 && !m_dirty.exchange(true);
 }
 
 
@@ -164,52 +324,107 @@ void VertexCommandManager::destroyCommand(Handle h)
     if (h == 0) { return; }
 
     lock_t l(m_mutex_processing);
+    // the command may be in the dirty queue
+    collectDirty();
+    auto *cmd = get(h);
+    m_dirty_commands.erase(std::remove(m_dirty_commands.begin(), m_dirty_commands.end(), cmd), m_dirty_commands.end());
     m_commands.pull(h);
 }
 
 void VertexCommandManager::update(Handle h, const usdi::MeshData *src, void *vb, void *ib)
 {
     if (auto *cmd = get(h)) {
-        cmd->update(src, vb, ib);
+        if (cmd->update(src, vb, ib)) {
+            pushDirty(cmd);
+        }
     }
 }
 
 void VertexCommandManager::update(Handle h, const usdi::SubmeshData *src, void *vb, void *ib)
 {
     if (auto *cmd = get(h)) {
-        cmd->update(src, vb, ib);
+        if (cmd->update(src, vb, ib)) {
+            pushDirty(cmd);
+        }
+    }
+}
+
+void VertexCommandManager::setVertexLayout(Handle h, int attributes)
+{
+    lock_t l(m_mutex_processing);
+    if (auto *cmd = get(h)) {
+        cmd->setVertexLayout(attributes);
+    }
+}
+
+void VertexCommandManager::pushDirty(Command *cmd)
+{
+    auto *head = m_dirty_queue.load(std::memory_order_relaxed);
+    do {
+        cmd->m_next_dirty = head;
+    } while (!m_dirty_queue.compare_exchange_weak(head, cmd, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void VertexCommandManager::collectDirty()
+{
+    // the consumer takes the whole list at once. no ABA problem
+    auto *cmd = m_dirty_queue.exchange(nullptr, std::memory_order_acquire);
+    size_t begin = m_dirty_commands.size();
+    while (cmd) {
+        m_dirty_commands.push_back(cmd);
+        cmd = cmd->m_next_dirty;
     }
+    // the list is LIFO. process in the order of updates
+    std::reverse(m_dirty_commands.begin() + begin, m_dirty_commands.end());
 }
 
 void VertexCommandManager::process()
 {
     lock_t l(m_mutex_processing);
 
+    collectDirty();
     auto& dirty = m_dirty_commands;
-    for (auto& t : m_commands.getValues()) {
-        if (t && t->isDirty()) {
-            dirty.push_back(t.get());
-        }
-    }
+    if (dirty.empty()) { return; }
+
+    // pipeline: the render thread maps batch N+1 while worker threads copy batch N.
+    // map() and unmap() must be called on the render thread (OpenGL).
+    const size_t batch_size = 64;
+    const size_t num = dirty.size();
+    auto map_batch = [&dirty, num, batch_size](size_t begin) {
+        size_t end = std::min(begin + batch_size, num);
+        for (size_t i = begin; i < end; ++i) { dirty[i]->map(); }
+    };
 
-    if (!dirty.empty()) {
-        for (auto& t : dirty) { t->map(); }
+    map_batch(0);
+    for (size_t begin = 0; begin < num; begin += batch_size) {
+        size_t end = std::min(begin + batch_size, num);
 
 #ifdef usdiDbgForceSingleThread
-        for (auto& t : dirty) { t->copy(); }
+        for (size_t i = begin; i < end; ++i) { dirty[i]->copy(); }
+        if (end < num) { map_batch(end); }
 #else
-        size_t grain = std::max<size_t>(dirty.size()/32, 1);
-        using range_t = tbb::blocked_range<size_t>;
-        tbb::parallel_for(range_t(0, dirty.size(), grain), [&dirty](const range_t& r) {
-            for (size_t i = r.begin(); i != r.end(); ++i) {
-                dirty[i]->copy();
-            }
+        tbb::task_group copy_task;
+        copy_task.run([&dirty, begin, end]() {
+            using range_t = tbb::blocked_range<size_t>;
+            tbb::parallel_for(range_t(begin, end, 4), [&dirty](const range_t& r) {
+                for (size_t i = r.begin(); i != r.end(); ++i) {
+                    dirty[i]->copy();
+                }
+            });
         });
+        if (end < num) { map_batch(end); }
+        copy_task.wait();
 #endif
 
-        for (auto& t : dirty) { t->unmap(); t->clearDirty(); }
-        dirty.clear();
+        for (size_t i = begin; i < end; ++i) {
+            dirty[i]->unmap();
+            if (dirty[i]->clearDirty()) {
+                pushDirty(dirty[i]);
+            }
+        }
     }
+    dirty.clear();
+    gi::GetGraphicsInterface()->fenceUploads();
 }
 
 void VertexCommandManager::wait()
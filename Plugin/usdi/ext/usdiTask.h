@@ -4,6 +4,7 @@
 #ifdef usdiEnableGraphicsInterface
     #include "GraphicsInterface/GraphicsInterface.h"
 #endif // usdiEnableGraphicsInterface
+#include "MeshUtils/MeshUtils.h"
 #include "etc/HandleBasedVector.h"
 #include "etc/Allocator.h"
 #include "usdiExt.h"
@@ -20,40 +21,76 @@ public:
 
 #ifdef usdiEnableGraphicsInterface
 using MapContext = gi::MapContext;
+using UploadContext = gi::UploadContext;
 
+// uploads vertices (and indices) of a mesh to a native buffer on the render thread.
+// update() hashes the source streams and only streams that changed are written. if the mapped buffer keeps its
+// contents, unchanged attributes in the interleaved vertices are left as is (e.g. uvs and tangents of homogenous meshes).
 class VertexUpdateCommand
 {
 public:
     VertexUpdateCommand(const char *dbg_name);
     ~VertexUpdateCommand();
 
-    void update(const usdi::MeshData *data, void *vb, void *ib);
-    void update(const usdi::SubmeshData *data, void *vb, void *ib);
-    bool isDirty() const;
+    // return true if the command became dirty and must be pushed to the dirty queue
+    bool update(const usdi::MeshData *data, void *vb, void *ib);
+    bool update(const usdi::SubmeshData *data, void *vb, void *ib);
+    // attributes: combination of VertexAttribute. 0: selected by the sources (points, normals [, uvs [, tangents]]).
+    // attributes the source doesn't have are written as zero. VA_Colors and VA_UV2 are ignored as usdi meshes don't have them.
+    // must not be called while processing.
+    void setVertexLayout(int attributes);
 
     void map();
     void copy();
     void unmap();
-    void clearDirty();
+    // return true if update() was called while processing (or mapping failed) and the command must be queued again
+    bool clearDirty();
 
     usdiDefineCachedOperatorNew(VertexUpdateCommand, 256);
 
 private:
+    friend class VertexCommandManager;
+
     typedef tbb::spin_mutex::scoped_lock lock_t;
 
+    // vertex streams share bits with VertexAttribute
+    enum Stream
+    {
+        Stream_Vertices = VA_All,
+        Stream_Indices  = VA_End,
+        Stream_All      = Stream_Vertices | Stream_Indices,
+        NumStreams      = 8,
+    };
+
+    bool updateChanges(void *vb, void *ib);
+    VertexLayout getVertexLayout() const;
+    size_t getVertexBufferSize() const;
+    size_t getIndexBufferSize() const;
+    void mapOrUpload(MapContext& mctx, UploadContext& uctx, size_t size);
+    void unmapOrUpload(MapContext& mctx, UploadContext& uctx, size_t size);
+    void copyVertices(void *dst, bool direct, bool partial);
+
     std::string m_dbg_name;
 
-    const float3 *m_src_points = nullptr;
-    const float3 *m_src_normals = nullptr;
-    const float2 *m_src_uvs = nullptr;
-    const float4 *m_src_tangents = nullptr;
+    VertexSource m_src;
     const int    *m_src_indices = nullptr;
     int          m_num_points = 0;
     int          m_num_indices = 0;
+    std::atomic_int m_layout = { 0 }; // 0: selected by sources. set by any thread, read by updateChanges()
+
+    uint64_t     m_hashes[NumStreams] = {};
+    int          m_prev_layout = 0;
+    int          m_prev_num_points = 0;
+    std::atomic_int m_changed = { 0 };  // streams changed since the last process()
+    int          m_processing = 0;      // streams being written in the current process()
 
     MapContext m_ctx_vb;
     MapContext m_ctx_ib;
-    std::atomic_bool m_dirty;
+    // used instead of m_ctx_vb / m_ctx_ib if the backend has an upload ring
+    UploadContext m_up_vb;
+    UploadContext m_up_ib;
+    std::atomic_bool m_dirty = { false }; // true while in the dirty queue or being processed
+    VertexUpdateCommand *m_next_dirty = nullptr;
 };
 
 class VertexCommandManager
@@ -68,6 +105,7 @@ public:
     void destroyCommand(Handle h);
     void update(Handle h, const usdi::MeshData *src, void *vb, void *ib);
     void update(Handle h, const usdi::SubmeshData *src, void *vb, void *ib);
+    void setVertexLayout(Handle h, int attributes);
 
     void process();
     void wait();
@@ -76,9 +114,14 @@ private:
     typedef tbb::spin_mutex::scoped_lock lock_t;
 
     VertexUpdateCommand* get(Handle h);
+    // lock-free. can be called from any thread
+    void pushDirty(Command *cmd);
+    // move commands in the dirty queue to m_dirty_commands. must be called with m_mutex_processing locked
+    void collectDirty();
 
     tbb::spin_mutex                 m_mutex_processing;
     HandleBasedVector<CommandPtr>   m_commands;
+    std::atomic<Command*>           m_dirty_queue = { nullptr }; // intrusive list linked by Command::m_next_dirty
     std::vector<Command*>           m_dirty_commands;
 };
 #endif // usdiEnableGraphicsInterface
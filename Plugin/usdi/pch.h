@@ -28,13 +28,18 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <set>
+#include <deque>
 #include <memory>
 #include <algorithm>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <future>
 #include <functional>
 #include <atomic>
+#include <chrono>
 #include <cstdarg>
 #include <cmath>
 #include <cctype>
@@ -49,11 +54,16 @@
 #pragma warning(push)
 #pragma warning(disable:4100 4127 4244 4305)
 #include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/notice.h"
+#include "pxr/usd/usd/stagePopulationMask.h"
 #include "pxr/usd/usd/timeCode.h"
+#include "pxr/usd/usd/tokens.h"
 #include "pxr/usd/usd/treeIterator.h"
 #include "pxr/usd/usd/variantSets.h"
 #include "pxr/usd/usdGeom/xform.h"
 #include "pxr/usd/usdGeom/xformCommonAPI.h"
+#include "pxr/usd/usdGeom/xformCache.h"
+#include "pxr/usd/usdGeom/boundable.h"
 #include "pxr/usd/usdGeom/camera.h"
 #include "pxr/usd/usdGeom/mesh.h"
 #include "pxr/usd/usdGeom/points.h"
@@ -61,7 +71,12 @@
 #include "pxr/base/gf/matrix2f.h"
 #include "pxr/base/gf/matrix3f.h"
 #include "pxr/base/gf/matrix4f.h"
+#include "pxr/usd/sdf/layerUtils.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/primSpec.h"
+#include "pxr/usd/sdf/attributeSpec.h"
 #include "pxr/usd/ar/resolver.h"
+#include "pxr/base/tf/weakBase.h"
 #pragma warning(pop)
 
 namespace usdi {
@@ -72,6 +87,19 @@ namespace usdi {
     class Camera;
     class Mesh;
     class Points;
+    class PayloadStreamer;
+    class UpdateScheduler;
+    class Recorder;
+    class SchemaIndex;
+    class SampleDeduplicator;
+    class ClipWriter;
+    class PartitionWriter;
+    class AsyncOpen;
+    class AsyncSave;
+    class AsyncSaveQueue;
+    class AttributeBatch;
+    class SampleHandle;
+    class VertexAnimation;
 } // namespace usdi
 
 #pragma warning(disable:4201)
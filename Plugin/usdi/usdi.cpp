@@ -8,6 +8,14 @@
 #include "usdiMesh.h"
 #include "usdiPoints.h"
 #include "usdiContext.h"
+#include "usdiPayloadStreamer.h"
+#include "usdiUpdateScheduler.h"
+#include "usdiSampleDeduplicator.h"
+#include "usdiRecorder.h"
+#include "usdiAsyncOpen.h"
+#include "usdiAsyncSave.h"
+#include "usdiAttributeBatch.h"
+#include "usdiVertexAnimation.h"
 
 
 #ifdef _WIN32
@@ -102,6 +110,64 @@ usdiAPI bool usdiOpen(usdi::Context *ctx, const char *path)
     return ctx->open(path);
 }
 
+usdiAPI bool usdiOpenMasked(usdi::Context *ctx, const char *path, const char **mask_paths, int num_mask_paths)
+{
+    usdiTraceFunc();
+    if (!ctx || !path) return false;
+    usdi::OpenSettings settings;
+    settings.population_mask = mask_paths;
+    settings.num_population_mask = num_mask_paths;
+    return ctx->open(path, settings);
+}
+
+usdiAPI bool usdiOpenWithSettings(usdi::Context *ctx, const char *path, const usdi::OpenSettings *settings)
+{
+    usdiTraceFunc();
+    if (!ctx || !path || !settings) return false;
+    return ctx->open(path, *settings);
+}
+
+usdiAPI usdi::AsyncOpen* usdiOpenAsync(usdi::Context *ctx, const char *path, const usdi::OpenSettings *settings)
+{
+    usdiTraceFunc();
+    if (!ctx || !path) return nullptr;
+    return new usdi::AsyncOpen(ctx, path, settings);
+}
+
+usdiAPI bool usdiAsyncOpenIsFinished(usdi::AsyncOpen *ao)
+{
+    usdiTraceFunc();
+    if (!ao) return true;
+    return ao->isFinished();
+}
+
+usdiAPI bool usdiAsyncOpenWait(usdi::AsyncOpen *ao)
+{
+    usdiTraceFunc();
+    if (!ao) return false;
+    return ao->wait();
+}
+
+usdiAPI void usdiAsyncOpenGetProgress(usdi::AsyncOpen *ao, usdi::OpenProgress *dst)
+{
+    usdiTraceFunc();
+    if (!ao || !dst) return;
+    ao->getProgress(*dst);
+}
+
+usdiAPI void usdiAsyncOpenCancel(usdi::AsyncOpen *ao)
+{
+    usdiTraceFunc();
+    if (!ao) return;
+    ao->cancel();
+}
+
+usdiAPI void usdiAsyncOpenRelease(usdi::AsyncOpen *ao)
+{
+    usdiTraceFunc();
+    delete ao;
+}
+
 usdiAPI bool usdiCreateStage(usdi::Context *ctx, const char *path)
 {
     usdiTraceFunc();
@@ -123,6 +189,42 @@ usdiAPI bool usdiSaveAs(usdi::Context *ctx, const char *path)
     return ctx->saveAs(path);
 }
 
+usdiAPI usdi::AsyncSave* usdiSaveAsync(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return nullptr;
+    usdiVTuneScope("usdiSaveAsync");
+    return new usdi::AsyncSave(ctx, nullptr);
+}
+
+usdiAPI usdi::AsyncSave* usdiSaveAsAsync(usdi::Context *ctx, const char *path)
+{
+    usdiTraceFunc();
+    if (!ctx || !path) return nullptr;
+    usdiVTuneScope("usdiSaveAsAsync");
+    return new usdi::AsyncSave(ctx, path);
+}
+
+usdiAPI bool usdiAsyncSaveIsFinished(usdi::AsyncSave *as)
+{
+    usdiTraceFunc();
+    if (!as) return true;
+    return as->isFinished();
+}
+
+usdiAPI bool usdiAsyncSaveWait(usdi::AsyncSave *as)
+{
+    usdiTraceFunc();
+    if (!as) return false;
+    return as->wait();
+}
+
+usdiAPI void usdiAsyncSaveRelease(usdi::AsyncSave *as)
+{
+    usdiTraceFunc();
+    delete as;
+}
+
 usdiAPI void usdiSetImportSettings(usdi::Context *ctx, const usdi::ImportSettings *v)
 {
     usdiTraceFunc();
@@ -148,6 +250,13 @@ usdiAPI void usdiGetExportSettings(usdi::Context *ctx, usdi::ExportSettings *v)
     *v = ctx->getExportSettings();
 }
 
+usdiAPI void usdiGetExportStats(usdi::Context *ctx, usdi::ExportStats *dst)
+{
+    usdiTraceFunc();
+    if (!ctx || !dst) return;
+    ctx->getExportStats(*dst);
+}
+
 usdiAPI usdi::Schema* usdiGetRoot(usdi::Context *ctx)
 {
     usdiTraceFunc();
@@ -172,6 +281,34 @@ usdiAPI usdi::Schema* usdiFindSchema(usdi::Context *ctx, const char *prim_path)
     if (!ctx) return nullptr;
     return ctx->findSchema(prim_path);
 }
+usdiAPI int usdiFindSchemas(usdi::Context *ctx, const char **prim_paths, int num, usdi::Schema **dst)
+{
+    usdiTraceFunc();
+    if (!ctx) return 0;
+    return ctx->findSchemas(prim_paths, num, dst);
+}
+usdiAPI int usdiFindSchemasInSubtree(usdi::Context *ctx, const char *prim_path, usdi::Schema **dst, int max_dst)
+{
+    usdiTraceFunc();
+    if (!ctx) return 0;
+    std::vector<usdi::Schema*> tmp;
+    int n = ctx->findSchemasInSubtree(prim_path, tmp);
+    if (dst && max_dst > 0) {
+        std::copy(tmp.begin(), tmp.begin() + std::min<int>(n, max_dst), dst);
+    }
+    return n;
+}
+usdiAPI int usdiFindSchemasByPattern(usdi::Context *ctx, const char *pattern, usdi::Schema **dst, int max_dst)
+{
+    usdiTraceFunc();
+    if (!ctx) return 0;
+    std::vector<usdi::Schema*> tmp;
+    int n = ctx->findSchemasByPattern(pattern, tmp);
+    if (dst && max_dst > 0) {
+        std::copy(tmp.begin(), tmp.begin() + std::min<int>(n, max_dst), dst);
+    }
+    return n;
+}
 
 usdiAPI usdi::Schema* usdiCreateOverride(usdi::Context *ctx, const char *prim_path)
 {
@@ -211,6 +348,21 @@ usdiAPI void usdiFlatten(usdi::Context *ctx)
     ctx->flatten();
 }
 
+usdiAPI void usdiBeginWriteFrame(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return;
+    ctx->beginWriteFrame();
+}
+
+usdiAPI void usdiEndWriteFrame(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return;
+    usdiVTuneScope("usdiEndWriteFrame");
+    ctx->endWriteFrame();
+}
+
 usdiAPI void usdiNotifyForceUpdate(usdi::Context *ctx)
 {
     usdiTraceFunc();
@@ -234,6 +386,211 @@ usdiAPI void usdiRebuildSchemaTree(usdi::Context *ctx)
 }
 
 
+// Payload streaming interface
+
+usdiAPI void usdiStreamerSetSettings(usdi::Context *ctx, const usdi::PayloadStreamerSettings *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    ctx->getPayloadStreamer()->setSettings(*v);
+}
+
+usdiAPI void usdiStreamerGetSettings(usdi::Context *ctx, usdi::PayloadStreamerSettings *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    *v = ctx->getPayloadStreamer()->getSettings();
+}
+
+usdiAPI void usdiStreamerSetViewPosition(usdi::Context *ctx, const usdi::float3 *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    ctx->getPayloadStreamer()->setViewPosition(*v);
+}
+
+usdiAPI bool usdiStreamerRequestLoad(usdi::Context *ctx, const char *prim_path, float priority)
+{
+    usdiTraceFunc();
+    if (!ctx || !ctx->valid()) return false;
+    return ctx->getPayloadStreamer()->requestLoad(prim_path, priority);
+}
+
+usdiAPI bool usdiStreamerRequestUnload(usdi::Context *ctx, const char *prim_path)
+{
+    usdiTraceFunc();
+    if (!ctx || !ctx->valid()) return false;
+    return ctx->getPayloadStreamer()->requestUnload(prim_path);
+}
+
+usdiAPI int usdiStreamerUpdate(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx || !ctx->valid()) return 0;
+    return ctx->getPayloadStreamer()->update();
+}
+
+usdiAPI bool usdiStreamerPopEvent(usdi::Context *ctx, usdi::PayloadEvent *dst)
+{
+    usdiTraceFunc();
+    if (!ctx || !dst) return false;
+    return ctx->getPayloadStreamer()->popEvent(*dst);
+}
+
+usdiAPI size_t usdiStreamerGetResidentSize(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return 0;
+    return ctx->getPayloadStreamer()->getResidentSize();
+}
+
+usdiAPI void usdiStreamerWait(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return;
+    ctx->getPayloadStreamer()->wait();
+}
+
+usdiAPI void usdiSchedulerSetSettings(usdi::Context *ctx, const usdi::UpdateSchedulerSettings *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    ctx->getUpdateScheduler()->setSettings(*v);
+}
+
+usdiAPI void usdiSchedulerGetSettings(usdi::Context *ctx, usdi::UpdateSchedulerSettings *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    *v = ctx->getUpdateScheduler()->getSettings();
+}
+
+usdiAPI void usdiSchedulerSetViewPosition(usdi::Context *ctx, const usdi::float3 *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    ctx->getUpdateScheduler()->setViewPosition(*v);
+}
+
+usdiAPI void usdiSchedulerUpdate(usdi::Context *ctx, usdi::Time t, usdi::UpdateReport *report)
+{
+    usdiTraceFunc();
+    if (!ctx) return;
+    usdiVTuneScope("usdiSchedulerUpdate");
+    ctx->getUpdateScheduler()->update(t);
+    if (report) {
+        *report = ctx->getUpdateScheduler()->getReport();
+    }
+}
+
+usdiAPI usdi::Schema* usdiSchedulerGetSkipped(usdi::Context *ctx, int i)
+{
+    usdiTraceFunc();
+    if (!ctx) return nullptr;
+    return ctx->getUpdateScheduler()->getSkipped(i);
+}
+
+
+usdiAPI void usdiRecorderSetSettings(usdi::Context *ctx, const usdi::RecorderSettings *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    ctx->getRecorder()->setSettings(*v);
+}
+
+usdiAPI void usdiRecorderGetSettings(usdi::Context *ctx, usdi::RecorderSettings *v)
+{
+    usdiTraceFunc();
+    if (!ctx || !v) return;
+    *v = ctx->getRecorder()->getSettings();
+}
+
+usdiAPI bool usdiRecorderWriteXform(usdi::Context *ctx, usdi::Xform *xf, const usdi::XformData *src, usdi::Time t)
+{
+    usdiTraceFunc();
+    if (!ctx || !src) return false;
+    usdiVTuneScope("usdiRecorderWriteXform");
+    return ctx->getRecorder()->writeXform(xf, *src, t);
+}
+
+usdiAPI bool usdiRecorderWriteCamera(usdi::Context *ctx, usdi::Camera *cam, const usdi::CameraData *src, usdi::Time t)
+{
+    usdiTraceFunc();
+    if (!ctx || !src) return false;
+    usdiVTuneScope("usdiRecorderWriteCamera");
+    return ctx->getRecorder()->writeCamera(cam, *src, t);
+}
+
+usdiAPI bool usdiRecorderWriteMesh(usdi::Context *ctx, usdi::Mesh *mesh, const usdi::MeshData *src, usdi::Time t)
+{
+    usdiTraceFunc();
+    if (!ctx || !src) return false;
+    usdiVTuneScope("usdiRecorderWriteMesh");
+    return ctx->getRecorder()->writeMesh(mesh, *src, t);
+}
+
+usdiAPI bool usdiRecorderWritePoints(usdi::Context *ctx, usdi::Points *points, const usdi::PointsData *src, usdi::Time t)
+{
+    usdiTraceFunc();
+    if (!ctx || !src) return false;
+    usdiVTuneScope("usdiRecorderWritePoints");
+    return ctx->getRecorder()->writePoints(points, *src, t);
+}
+
+usdiAPI void usdiRecorderEndFrame(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return;
+    usdiVTuneScope("usdiRecorderEndFrame");
+    ctx->getRecorder()->endFrame();
+}
+
+usdiAPI void usdiRecorderFlush(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return;
+    usdiVTuneScope("usdiRecorderFlush");
+    ctx->getRecorder()->flush();
+}
+
+usdiAPI void usdiRecorderGetStats(usdi::Context *ctx, usdi::RecorderStats *dst)
+{
+    usdiTraceFunc();
+    if (!ctx || !dst) return;
+    ctx->getRecorder()->getStats(*dst);
+}
+
+usdiAPI bool usdiBeginClipExport(usdi::Context *ctx, const usdi::ClipExportSettings *settings)
+{
+    usdiTraceFunc();
+    if (!ctx) return false;
+    return ctx->beginClipExport(settings ? *settings : usdi::ClipExportSettings());
+}
+
+usdiAPI bool usdiEndClipExport(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return false;
+    usdiVTuneScope("usdiEndClipExport");
+    return ctx->endClipExport();
+}
+
+usdiAPI bool usdiBeginParallelExport(usdi::Context *ctx, const usdi::ParallelExportSettings *settings)
+{
+    usdiTraceFunc();
+    if (!ctx) return false;
+    return ctx->beginParallelExport(settings ? *settings : usdi::ParallelExportSettings());
+}
+
+usdiAPI bool usdiEndParallelExport(usdi::Context *ctx)
+{
+    usdiTraceFunc();
+    if (!ctx) return false;
+    usdiVTuneScope("usdiEndParallelExport");
+    return ctx->endParallelExport();
+}
+
+
 // Schema interface
 
 usdiAPI int usdiPrimGetID(usdi::Schema *schema)
@@ -280,6 +637,27 @@ usdiAPI usdi::Schema* usdiPrimGetInstance(usdi::Schema *schema, int i)
     return schema->getInstance(i);
 }
 
+usdiAPI int usdiPrimGetInstanceTransforms(usdi::Schema *schema, usdi::float4x4 *dst, int max_instances, usdi::Time t)
+{
+    usdiTraceFunc();
+    if (!schema) { return 0; }
+    return schema->getInstanceTransforms(dst, max_instances, t);
+}
+
+usdiAPI float usdiPrimGetUpdatePriority(usdi::Schema *schema)
+{
+    usdiTraceFunc();
+    if (!schema) { return -1.0f; }
+    return schema->getUpdatePriority();
+}
+
+usdiAPI void usdiPrimSetUpdatePriority(usdi::Schema *schema, float v)
+{
+    usdiTraceFunc();
+    if (!schema) { return; }
+    schema->setUpdatePriority(v);
+}
+
 usdiAPI bool usdiPrimIsInstance(usdi::Schema *schema)
 {
     usdiTraceFunc();
@@ -581,6 +959,56 @@ usdiAPI bool usdiMeshWriteSample(usdi::Mesh *mesh, const usdi::MeshData *src, us
 }
 
 
+// Vertex animation texture interface
+
+usdiAPI usdi::VertexAnimation* usdiMeshBakeVertexAnimation(usdi::Mesh *mesh, const usdi::VertexAnimationSettings *settings)
+{
+    usdiTraceFunc();
+    if (!mesh) return nullptr;
+    usdiVTuneScope("usdiMeshBakeVertexAnimation");
+    auto *ret = new usdi::VertexAnimation();
+    if (!ret->bake(mesh, settings ? *settings : usdi::VertexAnimationSettings())) {
+        delete ret;
+        return nullptr;
+    }
+    return ret;
+}
+
+usdiAPI void usdiVtxAnimRelease(usdi::VertexAnimation *va)
+{
+    usdiTraceFunc();
+    delete va;
+}
+
+usdiAPI void usdiVtxAnimGetInfo(usdi::VertexAnimation *va, usdi::VertexAnimationInfo *dst)
+{
+    usdiTraceFunc();
+    if (!va || !dst) return;
+    *dst = va->getInfo();
+}
+
+usdiAPI bool usdiVtxAnimReadTexels(usdi::VertexAnimation *va, void *dst_points, void *dst_normals)
+{
+    usdiTraceFunc();
+    if (!va) return false;
+    if (dst_points) {
+        memcpy(dst_points, va->getPointsTexels(), va->getTextureSize());
+    }
+    if (dst_normals && va->getNormalsTexels()) {
+        memcpy(dst_normals, va->getNormalsTexels(), va->getTextureSize());
+    }
+    return true;
+}
+
+usdiAPI bool usdiVtxAnimWriteFile(usdi::VertexAnimation *va, const char *path)
+{
+    usdiTraceFunc();
+    if (!va || !path) return false;
+    usdiVTuneScope("usdiVtxAnimWriteFile");
+    return va->writeFile(path);
+}
+
+
 // Points interface
 
 usdiAPI usdi::Points* usdiAsPoints(usdi::Schema *schema)
@@ -658,4 +1086,81 @@ usdiAPI bool usdiAttrWriteSample(usdi::Attribute *attr, const usdi::AttributeDat
     return attr->writeSample(*src, t);
 }
 
+usdiAPI bool usdiAttrEnableCache(usdi::Attribute *attr, size_t max_bytes)
+{
+    usdiTraceFunc();
+    if (!attr) { return false; }
+    return attr->enableCache(max_bytes);
+}
+
+usdiAPI void usdiAttrDisableCache(usdi::Attribute *attr)
+{
+    usdiTraceFunc();
+    if (!attr) { return; }
+    attr->disableCache();
+}
+
+usdiAPI size_t usdiAttrGetCacheSize(usdi::Attribute *attr)
+{
+    usdiTraceFunc();
+    if (!attr) { return 0; }
+    return attr->getCacheSize();
+}
+
+usdiAPI usdi::SampleHandle* usdiAttrAcquireSample(usdi::Attribute *attr, usdi::AttributeData *dst, usdi::Time t)
+{
+    usdiTraceFunc();
+    if (!attr || !dst) { return nullptr; }
+    usdiVTuneScope("usdiAttrAcquireSample");
+    return attr->acquireSample(*dst, t);
+}
+
+usdiAPI void usdiSampleRetain(usdi::SampleHandle *handle)
+{
+    usdiTraceFunc();
+    if (!handle) { return; }
+    handle->retain();
+}
+
+usdiAPI void usdiSampleRelease(usdi::SampleHandle *handle)
+{
+    usdiTraceFunc();
+    if (!handle) { return; }
+    handle->release();
+}
+
+usdiAPI usdi::AttributeBatch* usdiCreateAttributeBatch()
+{
+    usdiTraceFunc();
+    return new usdi::AttributeBatch();
+}
+
+usdiAPI void usdiAttrBatchRelease(usdi::AttributeBatch *batch)
+{
+    usdiTraceFunc();
+    delete batch;
+}
+
+usdiAPI int usdiAttrBatchAdd(usdi::AttributeBatch *batch, usdi::Attribute *attr, size_t offset, int capacity)
+{
+    usdiTraceFunc();
+    if (!batch) { return -1; }
+    return batch->add(attr, offset, capacity);
+}
+
+usdiAPI void usdiAttrBatchClear(usdi::AttributeBatch *batch)
+{
+    usdiTraceFunc();
+    if (!batch) { return; }
+    batch->clear();
+}
+
+usdiAPI int usdiAttrBatchRead(usdi::AttributeBatch *batch, void *arena, usdi::Time t, usdi::uint *changed_mask, int *num_elements)
+{
+    usdiTraceFunc();
+    if (!batch) { return 0; }
+    usdiVTuneScope("usdiAttrBatchRead");
+    return batch->read(arena, t, changed_mask, num_elements);
+}
+
 } // extern "C"
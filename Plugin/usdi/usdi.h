@@ -29,6 +29,11 @@ typedef unsigned int uint;
     class Camera : public Xform {};
     class Mesh : public Xform {};
     class Points : public Xform {};
+    class AsyncOpen {};
+    class AsyncSave {};
+    class AttributeBatch {};
+    class SampleHandle {};
+    class VertexAnimation {};
 
     struct float2 { float x, y; };
     struct float3 { float x, y, z; };
@@ -112,12 +117,50 @@ struct ImportSettings
     bool double_buffering = true;
 };
 
+struct OpenSettings
+{
+    // prim paths to populate. only these prims, their ancestors and descendants are composed. null: populate all.
+    const char  **population_mask = nullptr;
+    int         num_population_mask = 0;
+    // if true, child schemas are created on first usdiPrimGetNumChildren() / usdiPrimGetChild() / usdiFindSchema()
+    // call them from the main thread. population waits for usdiUpdateAllSamples() / usdiSchedulerUpdate() running on other threads.
+    bool        lazy_schema_tree = false;
+};
+
+enum class OpenStage
+{
+    OpeningLayer,
+    Composing,
+    BuildingSchemas,
+    Completed,
+    Failed,
+    Cancelled,
+};
+
+struct OpenProgress
+{
+    OpenStage   stage = OpenStage::OpeningLayer;
+    float       progress = 0.0f; // progress of the stage. 0.0 - 1.0
+    int         num_schemas = 0;
+};
+
 struct ExportSettings
 {
     float scale = 1.0f;
     bool swap_handedness = true;
     bool swap_faces = true;
     bool instanceable_by_default = false;
+    bool deduplicate_samples = false;   // skip samples identical to the previous one. see usdiGetExportStats()
+};
+
+
+struct ExportStats
+{
+    int     num_written_samples = 0;
+    int     num_skipped_samples = 0;    // identical to the previous sample and not authored
+    int     num_constant_streams = 0;   // attributes authored only as default value because they never changed
+    size_t  bytes_written = 0;          // raw size of authored values (strings and other non-POD values are not counted)
+    size_t  bytes_avoided = 0;          // raw size of skipped values
 };
 
 
@@ -206,6 +249,7 @@ struct SubmeshData
         Weights8 *weights8;
     };
     uint        num_points = 0; // num_points == num_indices in submeshes
+    uint        max_bone_weights = 0; // same as MeshData::max_bone_weights. tells weights4 or weights8 is valid
 
     float3  center = { 0.0f, 0.0f, 0.0f };
     float3  extents = { 0.0f, 0.0f, 0.0f };
@@ -277,6 +321,98 @@ struct AttributeData
     int     num_elements = 0;
 };
 
+
+struct PayloadStreamerSettings
+{
+    size_t  memory_budget = 0;          // on-disk bytes of payload layers (shared layers count once). 0: unlimited
+    float   load_distance = 0.0f;       // payloads closer than this to view position are loaded automatically. 0: disabled
+    float   unload_distance = 0.0f;     // automatically loaded payloads farther than this are unloaded. 0: disabled
+    int     max_loads_per_update = 1;   // number of prefetched payloads composed into the stage per usdiStreamerUpdate()
+};
+
+struct PayloadEvent
+{
+    enum class Type {
+        Loaded,
+        Unloaded,
+        Failed,
+    };
+
+    Type        type = Type::Loaded;
+    const char  *path = nullptr; // valid until next usdiStreamerPopEvent()
+    size_t      resident_size = 0;
+};
+
+struct UpdateSchedulerSettings
+{
+    double  time_budget = 0.0;              // in milliseconds. 0: unlimited
+    float   field_of_view = 60.0f;          // vertical, in degree. used to estimate screen size of schemas
+    float   screen_height = 1080.0f;        // in pixels
+    float   critical_priority = 1000000.0f; // schemas with priority >= this are updated even if the budget is exceeded
+    float   aging = 16.0f;                  // added to priority per skipped frame. prevents starvation of low priority schemas
+    int     bounds_update_interval = 8;     // in frames. world space bounds are recomputed with this interval
+};
+
+struct UpdateReport
+{
+    int     num_updated = 0;
+    int     num_skipped = 0;
+    double  elapsed = 0.0;  // in milliseconds
+};
+
+struct RecorderSettings
+{
+    int     max_queued_frames = 4;      // usdiRecorderEndFrame() blocks while this many frames are waiting to be written
+    bool    use_write_frame = true;     // write each frame in a write frame. see usdiBeginWriteFrame()
+};
+
+struct RecorderStats
+{
+    int     num_queued_frames = 0;      // frames waiting to be written or being written
+    int     max_queued_frames = 0;      // peak queue depth
+    int     num_written_frames = 0;
+    int     num_stalls = 0;             // number of times usdiRecorderEndFrame() blocked because the queue was full
+    double  stall_time = 0.0;           // total blocked time in milliseconds
+    double  write_time = 0.0;           // total time the worker spent on writing in milliseconds
+    size_t  pooled_bytes = 0;           // snapshot buffers kept for reuse
+};
+
+struct ClipExportSettings
+{
+    int     frames_per_clip = 300;      // number of sample times in each clip layer
+    bool    binary = true;              // write clips as .usdc. .usda otherwise
+    const char *directory = nullptr;    // where clips are written. null: next to the root layer. required if the root layer is anonymous
+};
+
+struct ParallelExportSettings
+{
+    int     num_partitions = 8;         // number of layers top-level prims are distributed to. should be >= number of writer threads
+};
+
+struct VertexAnimationSettings
+{
+    Time    start = 0.0, end = 0.0;     // start == end: time range of the mesh
+    Time    interval = 1.0 / 30.0;      // time between frames
+    int     max_width = 4096;           // points of a frame wrap into multiple rows if there are more than this
+    bool    half_precision = false;     // RGBA half textures. RGBA float otherwise
+    bool    bake_normals = true;
+};
+
+struct VertexAnimationInfo
+{
+    Time    start = 0.0;
+    Time    interval = 0.0;
+    int     num_points = 0;
+    int     num_frames = 0;
+    int     width = 0, height = 0;      // size of textures
+    int     rows_per_frame = 0;
+    int     texel_size = 0;             // in byte. 16 (RGBA float) or 8 (RGBA half)
+    bool    half_precision = false;
+    bool    has_normals = false;
+    float3  bounds_min = { 0.0f, 0.0f, 0.0f };  // of points in all frames
+    float3  bounds_max = { 0.0f, 0.0f, 0.0f };
+};
+
 } // namespace usdi
 
 extern "C" {
@@ -299,31 +435,126 @@ usdiAPI void             usdiFixedFree(size_t size, void *addr);
 usdiAPI usdi::Context*   usdiCreateContext();
 usdiAPI void             usdiDestroyContext(usdi::Context *ctx);
 usdiAPI bool             usdiOpen(usdi::Context *ctx, const char *path);
+usdiAPI bool             usdiOpenMasked(usdi::Context *ctx, const char *path, const char **mask_paths, int num_mask_paths);
+usdiAPI bool             usdiOpenWithSettings(usdi::Context *ctx, const char *path, const usdi::OpenSettings *settings);
+// open stage and build schema tree on a worker thread. settings can be null.
+// ctx must not be used until the returned object is finished.
+usdiAPI usdi::AsyncOpen* usdiOpenAsync(usdi::Context *ctx, const char *path, const usdi::OpenSettings *settings = nullptr);
+usdiAPI bool             usdiAsyncOpenIsFinished(usdi::AsyncOpen *ao);
+// block until finished. return true if the stage is opened successfully
+usdiAPI bool             usdiAsyncOpenWait(usdi::AsyncOpen *ao);
+usdiAPI void             usdiAsyncOpenGetProgress(usdi::AsyncOpen *ao, usdi::OpenProgress *dst);
+usdiAPI void             usdiAsyncOpenCancel(usdi::AsyncOpen *ao);
+// cancel if not finished and wait, then destroy
+usdiAPI void             usdiAsyncOpenRelease(usdi::AsyncOpen *ao);
 usdiAPI bool             usdiCreateStage(usdi::Context *ctx, const char *path);
 usdiAPI void             usdiFlatten(usdi::Context *ctx);
 usdiAPI bool             usdiSave(usdi::Context *ctx);
 // path must *not* be same as identifier (parameter of usdiOpen() or usdiCreateStage())
 usdiAPI bool             usdiSaveAs(usdi::Context *ctx, const char *path);
+// take a snapshot of the root layer and write it on a worker thread. authoring can continue right after these return.
+// usdiSaveAsAsync() flattens the snapshot on the worker. async saves of a context are written in the order of the calls.
+usdiAPI usdi::AsyncSave* usdiSaveAsync(usdi::Context *ctx);
+usdiAPI usdi::AsyncSave* usdiSaveAsAsync(usdi::Context *ctx, const char *path);
+usdiAPI bool             usdiAsyncSaveIsFinished(usdi::AsyncSave *as);
+// block until finished. return true if the file is written successfully
+usdiAPI bool             usdiAsyncSaveWait(usdi::AsyncSave *as);
+// wait and destroy
+usdiAPI void             usdiAsyncSaveRelease(usdi::AsyncSave *as);
 usdiAPI void             usdiSetImportSettings(usdi::Context *ctx, const usdi::ImportSettings *v);
 usdiAPI void             usdiGetImportSettings(usdi::Context *ctx, usdi::ImportSettings *v);
 usdiAPI void             usdiSetExportSettings(usdi::Context *ctx, const usdi::ExportSettings *v);
 usdiAPI void             usdiGetExportSettings(usdi::Context *ctx, usdi::ExportSettings *v);
+// deduplication stats since the stage is created or opened. valid if ExportSettings::deduplicate_samples is set.
+usdiAPI void             usdiGetExportStats(usdi::Context *ctx, usdi::ExportStats *dst);
 
 usdiAPI usdi::Schema*    usdiGetRoot(usdi::Context *ctx);
 usdiAPI int              usdiGetNumMasters(usdi::Context *ctx);
 usdiAPI usdi::Schema*    usdiGetMaster(usdi::Context *ctx, int i);
 usdiAPI usdi::Schema*    usdiFindSchema(usdi::Context *ctx, const char *prim_path);
+// dst must have num elements. not found paths are null. return number of found schemas.
+usdiAPI int              usdiFindSchemas(usdi::Context *ctx, const char **prim_paths, int num, usdi::Schema **dst);
+// schemas are stored in sorted path order. dst can be null. return number of all matched schemas (can be > max_dst).
+usdiAPI int              usdiFindSchemasInSubtree(usdi::Context *ctx, const char *prim_path, usdi::Schema **dst, int max_dst);
+// pattern: '*' matches any string within a path element, '?' any single character, "**" zero or more elements.
+// e.g. "/World/Props/*/Mesh"
+usdiAPI int              usdiFindSchemasByPattern(usdi::Context *ctx, const char *pattern, usdi::Schema **dst, int max_dst);
 
 usdiAPI usdi::Schema*    usdiCreateOverride(usdi::Context *ctx, const char *prim_path);
 usdiAPI usdi::Xform*     usdiCreateXform(usdi::Context *ctx, usdi::Schema *parent, const char *name);
 usdiAPI usdi::Camera*    usdiCreateCamera(usdi::Context *ctx, usdi::Schema *parent, const char *name);
 usdiAPI usdi::Mesh*      usdiCreateMesh(usdi::Context *ctx, usdi::Schema *parent, const char *name);
 usdiAPI usdi::Points*    usdiCreatePoints(usdi::Context *ctx, usdi::Schema *parent, const char *name);
+// all writes between begin and end are merged into one change notification.
+// samples of already authored attributes are written to the edit target layer directly. can be nested.
+usdiAPI void             usdiBeginWriteFrame(usdi::Context *ctx);
+usdiAPI void             usdiEndWriteFrame(usdi::Context *ctx);
 
 usdiAPI void             usdiNotifyForceUpdate(usdi::Context *ctx);
 usdiAPI void             usdiUpdateAllSamples(usdi::Context *ctx, usdi::Time t);
 usdiAPI void             usdiRebuildSchemaTree(usdi::Context *ctx);
 
+// Payload streaming interface
+// layers of payloads are opened on a worker thread. composing them into the stage is done in usdiStreamerUpdate().
+// call usdiRebuildSchemaTree() after Loaded / Unloaded events to reflect them to the schema tree.
+// if the streamer is in use (any usdiStreamer*() is called) before usdiOpen(), the stage is opened with all payloads unloaded.
+usdiAPI void             usdiStreamerSetSettings(usdi::Context *ctx, const usdi::PayloadStreamerSettings *v);
+usdiAPI void             usdiStreamerGetSettings(usdi::Context *ctx, usdi::PayloadStreamerSettings *v);
+usdiAPI void             usdiStreamerSetViewPosition(usdi::Context *ctx, const usdi::float3 *v);
+// priority < 0: distance to view position is used
+usdiAPI bool             usdiStreamerRequestLoad(usdi::Context *ctx, const char *prim_path, float priority = -1.0f);
+usdiAPI bool             usdiStreamerRequestUnload(usdi::Context *ctx, const char *prim_path);
+// return number of events available
+usdiAPI int              usdiStreamerUpdate(usdi::Context *ctx);
+// non-blocking. return false if there is no event
+usdiAPI bool             usdiStreamerPopEvent(usdi::Context *ctx, usdi::PayloadEvent *dst);
+usdiAPI size_t           usdiStreamerGetResidentSize(usdi::Context *ctx);
+usdiAPI void             usdiStreamerWait(usdi::Context *ctx);
+
+// Update scheduler interface
+// alternative to usdiUpdateAllSamples(). updates schemas in order of priority until time_budget is used up.
+// skipped schemas keep previous samples and are deferred to the next usdiSchedulerUpdate() with raised priority.
+// priority is usdiPrimSetUpdatePriority() if set, otherwise estimated size on screen in pixels.
+usdiAPI void             usdiSchedulerSetSettings(usdi::Context *ctx, const usdi::UpdateSchedulerSettings *v);
+usdiAPI void             usdiSchedulerGetSettings(usdi::Context *ctx, usdi::UpdateSchedulerSettings *v);
+usdiAPI void             usdiSchedulerSetViewPosition(usdi::Context *ctx, const usdi::float3 *v);
+// report can be null
+usdiAPI void             usdiSchedulerUpdate(usdi::Context *ctx, usdi::Time t, usdi::UpdateReport *report);
+// schemas skipped by last usdiSchedulerUpdate(). i < report->num_skipped
+usdiAPI usdi::Schema*    usdiSchedulerGetSkipped(usdi::Context *ctx, int i);
+
+// Recorder interface
+// alternative to usdi*WriteSample(). data is copied into pooled buffers and written on a worker thread in order.
+// schemas must not be created or destroyed while recording. call usdiRecorderFlush() before that.
+usdiAPI void             usdiRecorderSetSettings(usdi::Context *ctx, const usdi::RecorderSettings *v);
+usdiAPI void             usdiRecorderGetSettings(usdi::Context *ctx, usdi::RecorderSettings *v);
+usdiAPI bool             usdiRecorderWriteXform(usdi::Context *ctx, usdi::Xform *xf, const usdi::XformData *src, usdi::Time t = usdiDefaultTime());
+usdiAPI bool             usdiRecorderWriteCamera(usdi::Context *ctx, usdi::Camera *cam, const usdi::CameraData *src, usdi::Time t = usdiDefaultTime());
+usdiAPI bool             usdiRecorderWriteMesh(usdi::Context *ctx, usdi::Mesh *mesh, const usdi::MeshData *src, usdi::Time t = usdiDefaultTime());
+usdiAPI bool             usdiRecorderWritePoints(usdi::Context *ctx, usdi::Points *points, const usdi::PointsData *src, usdi::Time t = usdiDefaultTime());
+// pass samples recorded so far to the worker. blocks while max_queued_frames frames are waiting.
+usdiAPI void             usdiRecorderEndFrame(usdi::Context *ctx);
+// block until all recorded samples are written
+usdiAPI void             usdiRecorderFlush(usdi::Context *ctx);
+usdiAPI void             usdiRecorderGetStats(usdi::Context *ctx, usdi::RecorderStats *dst);
+
+// Value clip export interface
+// time samples are written to clip layers ("<root layer>.clip0000.usdc", ...) instead of the root layer.
+// each clip is saved and released from memory when it has frames_per_clip sample times. the root layer keeps prims and
+// default values, and "<root layer>.manifest.usda" and clip metadata on top-level prims stitch the clips together.
+// samples must be written in time order: a sample older than the current clip fails. usdiSave() writes the current clip too.
+// settings can be null, but ClipExportSettings::directory is required if the root layer is anonymous.
+usdiAPI bool             usdiBeginClipExport(usdi::Context *ctx, const usdi::ClipExportSettings *settings);
+usdiAPI bool             usdiEndClipExport(usdi::Context *ctx);
+
+// Parallel export interface
+// writes are authored to partition layers ("<root layer>.part0.usdc", ...) instead of the root layer, and
+// usdi*WriteSample() of schemas under different top-level prims can be called from multiple threads concurrently.
+// the partitions are sublayered to the root layer in fixed order by usdiSave() and usdiEndParallelExport().
+// schemas must not be created or destroyed while writing. settings can be null. fails if the root layer is anonymous.
+usdiAPI bool             usdiBeginParallelExport(usdi::Context *ctx, const usdi::ParallelExportSettings *settings);
+usdiAPI bool             usdiEndParallelExport(usdi::Context *ctx);
+
 // Prim interface
 usdiAPI int              usdiPrimGetID(usdi::Schema *schema);
 usdiAPI const char*      usdiPrimGetPath(usdi::Schema *schema);
@@ -333,6 +564,12 @@ usdiAPI const char*      usdiPrimGetUsdTypeName(usdi::Schema *schema);
 usdiAPI usdi::Schema*    usdiPrimGetMaster(usdi::Schema *schema);
 usdiAPI int              usdiPrimGetNumInstances(usdi::Schema *schema);
 usdiAPI usdi::Schema*    usdiPrimGetInstance(usdi::Schema *schema, int i);
+// world space transforms of all instances of the master. can be passed to Graphics.DrawMeshInstanced() as Matrix4x4[].
+// dst can be null. return number of instances.
+usdiAPI int              usdiPrimGetInstanceTransforms(usdi::Schema *schema, usdi::float4x4 *dst, int max_instances, usdi::Time t);
+// priority < 0: estimated by usdiSchedulerUpdate()
+usdiAPI float            usdiPrimGetUpdatePriority(usdi::Schema *schema);
+usdiAPI void             usdiPrimSetUpdatePriority(usdi::Schema *schema, float v);
 usdiAPI bool             usdiPrimIsInstance(usdi::Schema *schema);
 usdiAPI bool             usdiPrimIsInstanceable(usdi::Schema *schema);
 usdiAPI bool             usdiPrimIsMaster(usdi::Schema *schema);
@@ -395,6 +632,18 @@ usdiAPI void             usdiMeshGetSummary(usdi::Mesh *mesh, usdi::MeshSummary
 usdiAPI bool             usdiMeshReadSample(usdi::Mesh *mesh, usdi::MeshData *dst, usdi::Time t, bool copy);
 usdiAPI bool             usdiMeshWriteSample(usdi::Mesh *mesh, const usdi::MeshData *src, usdi::Time t = usdiDefaultTime());
 
+// Vertex animation texture interface
+// bake points (and normals) of each frame into rows of textures. see usdiVertexAnimation.cginc for the layout.
+// the mesh is left at the last frame. topology must be constant and the mesh must not be split into multiple submeshes.
+// return null if failed.
+usdiAPI usdi::VertexAnimation* usdiMeshBakeVertexAnimation(usdi::Mesh *mesh, const usdi::VertexAnimationSettings *settings);
+usdiAPI void             usdiVtxAnimRelease(usdi::VertexAnimation *va);
+usdiAPI void             usdiVtxAnimGetInfo(usdi::VertexAnimation *va, usdi::VertexAnimationInfo *dst);
+// dst_points, dst_normals: width * height * texel_size bytes each (e.g. for Texture2D.LoadRawTextureData()). either can be null.
+usdiAPI bool             usdiVtxAnimReadTexels(usdi::VertexAnimation *va, void *dst_points, void *dst_normals);
+// raw file: 'UVAT', int version, VertexAnimationInfo, points texels, normals texels (if has_normals)
+usdiAPI bool             usdiVtxAnimWriteFile(usdi::VertexAnimation *va, const char *path);
+
 // Points interface
 usdiAPI usdi::Points*    usdiAsPoints(usdi::Schema *schema); // dynamic cast to Points
 usdiAPI void             usdiPointsGetSummary(usdi::Points *points, usdi::PointsSummary *dst);
@@ -408,6 +657,28 @@ usdiAPI const char*      usdiAttrGetTypeName(usdi::Attribute *attr);
 usdiAPI void             usdiAttrGetSummary(usdi::Attribute *attr, usdi::AttributeSummary *dst);
 usdiAPI bool             usdiAttrReadSample(usdi::Attribute *attr, usdi::AttributeData *dst, usdi::Time t, bool copy);
 usdiAPI bool             usdiAttrWriteSample(usdi::Attribute *attr, const usdi::AttributeData *src, usdi::Time t = usdiDefaultTime());
+// pre-read all authored samples of an array attribute and interpolate them in usdi.
+// return false (and keep reading from USD) if samples take more than max_bytes.
+usdiAPI bool             usdiAttrEnableCache(usdi::Attribute *attr, size_t max_bytes);
+usdiAPI void             usdiAttrDisableCache(usdi::Attribute *attr);
+usdiAPI size_t           usdiAttrGetCacheSize(usdi::Attribute *attr);
+// zero-copy read. dst points to a pinned sample that stays valid until usdiSampleRelease() even if the attribute moves to other times.
+// return null if failed.
+usdiAPI usdi::SampleHandle* usdiAttrAcquireSample(usdi::Attribute *attr, usdi::AttributeData *dst, usdi::Time t);
+usdiAPI void             usdiSampleRetain(usdi::SampleHandle *handle);
+usdiAPI void             usdiSampleRelease(usdi::SampleHandle *handle);
+
+// Attribute batch interface
+// register (attribute, offset in arena) pairs once, then read all of them into one buffer per frame.
+usdiAPI usdi::AttributeBatch* usdiCreateAttributeBatch();
+usdiAPI void             usdiAttrBatchRelease(usdi::AttributeBatch *batch);
+// offset: in byte. capacity: number of elements arena can hold at offset. return index of the entry, -1 if failed.
+usdiAPI int              usdiAttrBatchAdd(usdi::AttributeBatch *batch, usdi::Attribute *attr, size_t offset, int capacity);
+usdiAPI void             usdiAttrBatchClear(usdi::AttributeBatch *batch);
+// changed_mask: bit i is set if entry i changed since last read. ((num_entries + 31) / 32) elements. can be null.
+// num_elements: actual number of elements of each entry (can be > capacity). num_entries elements. can be null.
+// return number of changed entries.
+usdiAPI int              usdiAttrBatchRead(usdi::AttributeBatch *batch, void *arena, usdi::Time t, usdi::uint *changed_mask, int *num_elements);
 
 } // extern "C"
 
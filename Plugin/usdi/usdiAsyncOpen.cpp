@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiContext.h"
+#include "usdiAsyncOpen.h"
+
+namespace usdi {
+
+AsyncOpen::AsyncOpen(Context *ctx, const char *path, const OpenSettings *settings)
+    : m_ctx(ctx)
+    , m_path(path)
+{
+    if (settings) {
+        m_settings = *settings;
+        // settings may be temporary. keep copy of mask paths.
+        if (m_settings.population_mask) {
+            for (int i = 0; i < m_settings.num_population_mask; ++i) {
+                if (m_settings.population_mask[i]) {
+                    m_mask.push_back(m_settings.population_mask[i]);
+                }
+            }
+            for (auto& m : m_mask) { m_mask_ptrs.push_back(m.c_str()); }
+            m_settings.population_mask = m_mask_ptrs.data();
+            m_settings.num_population_mask = (int)m_mask_ptrs.size();
+        }
+    }
+
+    m_task.run([this]() {
+        m_result = m_ctx->open(m_path.c_str(), m_settings, &m_state);
+        m_finished = true;
+    });
+}
+
+AsyncOpen::~AsyncOpen()
+{
+    if (!m_finished) {
+        cancel();
+    }
+    m_task.wait();
+}
+
+bool AsyncOpen::isFinished() const
+{
+    return m_finished;
+}
+
+bool AsyncOpen::wait()
+{
+    m_task.wait();
+    return m_result;
+}
+
+void AsyncOpen::cancel()
+{
+    m_state.cancel = true;
+}
+
+void AsyncOpen::getProgress(OpenProgress& dst) const
+{
+    dst.stage = (OpenStage)m_state.stage.load();
+    dst.num_schemas = m_state.num_schemas;
+    switch (dst.stage) {
+    case OpenStage::BuildingSchemas:
+    {
+        int num_prims = m_state.num_prims;
+        dst.progress = num_prims > 0 ? std::min<float>((float)dst.num_schemas / (float)num_prims, 1.0f) : 0.0f;
+        break;
+    }
+    case OpenStage::Completed:
+        dst.progress = 1.0f;
+        break;
+    default:
+        dst.progress = 0.0f;
+        break;
+    }
+}
+
+} // namespace usdi
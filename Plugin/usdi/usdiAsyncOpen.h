@@ -0,0 +1,30 @@
+#pragma once
+
+namespace usdi {
+
+// runs Context::open() on a worker thread.
+class AsyncOpen
+{
+public:
+    AsyncOpen(Context *ctx, const char *path, const OpenSettings *settings);
+    ~AsyncOpen();
+
+    bool    isFinished() const;
+    bool    wait();
+    void    cancel();
+    void    getProgress(OpenProgress& dst) const;
+
+private:
+    Context                     *m_ctx = nullptr;
+    std::string                 m_path;
+    OpenSettings                m_settings;
+    std::vector<std::string>    m_mask;
+    std::vector<const char*>    m_mask_ptrs;
+
+    OpenState                   m_state;
+    std::atomic_bool            m_finished = { false };
+    std::atomic_bool            m_result = { false };
+    tbb::task_group             m_task;
+};
+
+} // namespace usdi
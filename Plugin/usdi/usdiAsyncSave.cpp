@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiContext.h"
+#include "usdiAsyncSave.h"
+
+namespace usdi {
+
+AsyncSaveQueue::AsyncSaveQueue()
+{
+    m_worker = std::thread([this]() { workerMain(); });
+}
+
+AsyncSaveQueue::~AsyncSaveQueue()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void AsyncSaveQueue::push(const Job& job)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobs.push_back(job);
+    }
+    m_cond.notify_one();
+}
+
+void AsyncSaveQueue::workerMain()
+{
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            // queued jobs are finished even if stopped
+            if (m_jobs.empty()) { break; }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+
+AsyncSave::AsyncSave(Context *ctx, const char *path)
+    : m_flatten(path != nullptr)
+{
+    m_snapshot = ctx->takeSnapshot();
+    if (path) {
+        m_path = path;
+    }
+    else if (m_snapshot) {
+        m_path = ctx->getUsdStage()->GetRootLayer()->GetRealPath();
+    }
+    if (!m_snapshot || m_path.empty()) {
+        usdiLogError("AsyncSave::AsyncSave(): nothing to save\n");
+        m_finished = true;
+        return;
+    }
+    if (m_flatten) {
+        // the snapshot is composed the same as the stage
+        auto stage = ctx->getUsdStage();
+        m_mask = stage->GetPopulationMask();
+        m_load_set = stage->GetLoadSet();
+    }
+
+    ctx->getAsyncSaveQueue()->push([this]() { run(); });
+}
+
+AsyncSave::~AsyncSave()
+{
+    // the snapshot is written even if the caller doesn't wait
+    wait();
+}
+
+void AsyncSave::run()
+{
+    SdfLayerRefPtr layer = m_snapshot;
+    if (m_flatten) {
+        // composition and flattening are the heavy part of saveAs(). other layers of the stage (sublayers, references)
+        // are read as they are on disk or in the layer registry.
+        auto stage = UsdStage::OpenMasked(m_snapshot, m_mask, UsdStage::LoadNone);
+        if (stage) {
+            stage->LoadAndUnload(m_load_set, SdfPathSet());
+            layer = stage->Flatten();
+        }
+        else {
+            layer = SdfLayerRefPtr();
+        }
+    }
+
+    bool result = layer && layer->Export(m_path);
+    if (result) {
+        usdiLogInfo("AsyncSave: %s\n", m_path.c_str());
+    }
+    else {
+        usdiLogError("AsyncSave: failed to write %s\n", m_path.c_str());
+    }
+    layer = SdfLayerRefPtr();
+    m_snapshot = SdfLayerRefPtr();
+
+    // notify under the lock. the waiter may destroy this right after wait() returns.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_result = result;
+    m_finished = true;
+    m_cond.notify_all();
+}
+
+bool AsyncSave::isFinished() const
+{
+    return m_finished;
+}
+
+bool AsyncSave::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]() { return (bool)m_finished; });
+    return m_result;
+}
+
+} // namespace usdi
@@ -0,0 +1,57 @@
+#pragma once
+
+namespace usdi {
+
+// writes AsyncSave jobs of a context one by one on a dedicated thread, in the order they are pushed.
+// owned by Context. the destructor finishes all pushed jobs.
+class AsyncSaveQueue
+{
+public:
+    using Job = std::function<void()>;
+
+    AsyncSaveQueue();
+    ~AsyncSaveQueue();
+    void    push(const Job& job);
+
+private:
+    void    workerMain();
+
+private:
+    std::thread             m_worker;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Job>         m_jobs;
+    bool                    m_stop = false;
+};
+
+// writes a snapshot of the stage on the AsyncSaveQueue of the context.
+// the snapshot (a copy of the root layer) is taken in the constructor (Context::takeSnapshot()). authoring can continue
+// right after that. saveAs composes and flattens the snapshot on the worker too.
+// async saves of a context are written in the order they are created, so the newest snapshot is on the file at last.
+class AsyncSave
+{
+public:
+    // path == nullptr: save the root layer to its own file (Context::save()). otherwise flatten and export (Context::saveAs()).
+    AsyncSave(Context *ctx, const char *path);
+    ~AsyncSave();
+
+    bool    isFinished() const;
+    bool    wait();
+
+private:
+    void    run();
+
+private:
+    SdfLayerRefPtr              m_snapshot;
+    std::string                 m_path;
+    bool                        m_flatten = false;
+    UsdStagePopulationMask      m_mask;
+    SdfPathSet                  m_load_set;
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond;
+    std::atomic_bool            m_finished = { false };
+    bool                        m_result = false;
+};
+
+} // namespace usdi
@@ -3,6 +3,7 @@
 #include "usdiContext.h"
 #include "usdiSchema.h"
 #include "usdiAttribute.h"
+#include "usdiUtils.h"
 
 namespace usdi {
 
@@ -88,6 +89,60 @@ DefTraits(VtArray<GfMatrix4f>, AttributeType::Float4x4Array)
 #undef DefTraits
 
 
+size_t GetElementSize(AttributeType type)
+{
+    if ((int)type & (int)AttributeType::UnknownArray) {
+        type = (AttributeType)((int)type & ~(int)AttributeType::UnknownArray);
+    }
+
+    switch (type) {
+    case AttributeType::Bool:       return sizeof(bool);
+    case AttributeType::Byte:       return sizeof(byte);
+    case AttributeType::Int:        return sizeof(int);
+    case AttributeType::UInt:       return sizeof(uint);
+    case AttributeType::Half:       return sizeof(half);
+    case AttributeType::Half2:      return sizeof(GfVec2h);
+    case AttributeType::Half3:      return sizeof(GfVec3h);
+    case AttributeType::Half4:      return sizeof(GfVec4h);
+    case AttributeType::QuatH:      return sizeof(GfQuath);
+    case AttributeType::Float:      return sizeof(float);
+    case AttributeType::Float2:     return sizeof(GfVec2f);
+    case AttributeType::Float3:     return sizeof(GfVec3f);
+    case AttributeType::Float4:     return sizeof(GfVec4f);
+    case AttributeType::QuatF:      return sizeof(GfQuatf);
+    case AttributeType::Double:     return sizeof(double);
+    case AttributeType::Double2:    return sizeof(GfVec2d);
+    case AttributeType::Double3:    return sizeof(GfVec3d);
+    case AttributeType::Double4:    return sizeof(GfVec4d);
+    case AttributeType::QuatD:      return sizeof(GfQuatd);
+    case AttributeType::Float2x2:   return sizeof(GfMatrix2f);
+    case AttributeType::Float3x3:   return sizeof(GfMatrix3f);
+    case AttributeType::Float4x4:   return sizeof(GfMatrix4f);
+    case AttributeType::Double2x2:  return sizeof(GfMatrix2d);
+    case AttributeType::Double3x3:  return sizeof(GfMatrix3d);
+    case AttributeType::Double4x4:  return sizeof(GfMatrix4d);
+    // string types are read as const char* (or const char** for arrays)
+    case AttributeType::String:     // 
+    case AttributeType::Token:      // fall through
+    case AttributeType::Asset:      return sizeof(const char*);
+    default: return 0;
+    }
+}
+
+bool IsStringType(AttributeType type)
+{
+    switch (type) {
+    case AttributeType::String:         // 
+    case AttributeType::Token:          // 
+    case AttributeType::Asset:          // 
+    case AttributeType::StringArray:    // 
+    case AttributeType::TokenArray:     // fall through
+    case AttributeType::AssetArray:     return true;
+    default: return false;
+    }
+}
+
+
 Attribute::Attribute(Schema *parent, UsdAttribute usdattr)
     : m_parent(parent), m_usdattr(usdattr)
 {
@@ -113,6 +168,7 @@ const char*     Attribute::getName() const          { return m_usdattr.GetName()
 const char*     Attribute::getTypeName() const      { return m_usdattr.GetTypeName().GetAsToken().GetText(); }
 AttributeType   Attribute::getType() const          { return m_type; }
 bool            Attribute::isConstant() const       { return !m_usdattr.ValueMightBeTimeVarying(); }
+size_t          Attribute::getElementSize() const   { return GetElementSize(m_type); }
 bool            Attribute::hasValue() const         { return m_usdattr.HasValue(); }
 size_t          Attribute::getNumSamples() const    { return m_usdattr.GetNumTimeSamples(); }
 
@@ -159,6 +215,94 @@ void Attribute::addConverter(Attribute *attr)
     m_converters.push_back(AttributePtr(attr));
 }
 
+bool Attribute::enableCache(size_t max_bytes) { return false; }
+void Attribute::disableCache() {}
+size_t Attribute::getCacheSize() const { return 0; }
+
+bool Attribute::setSample(const VtValue& v, Time t)
+{
+    return m_parent->getContext()->setSample(m_usdattr, v, UsdTimeCode(t));
+}
+
+SampleHandle* Attribute::acquireSample(AttributeData& dst, Time t)
+{
+    usdiLogError("Attribute::acquireSample(): %s (%s) is not supported\n", getName(), getTypeName());
+    return nullptr;
+}
+
+
+SampleHandle::SampleHandle() : m_ref_count(1) {}
+SampleHandle::~SampleHandle() {}
+const AttributeData& SampleHandle::getData() const { return m_data; }
+void SampleHandle::retain() { ++m_ref_count; }
+
+void SampleHandle::release()
+{
+    if (--m_ref_count == 0) {
+        delete this;
+    }
+}
+
+using SampleLock = std::lock_guard<std::recursive_mutex>;
+
+// holds a copy of the sample. VtArray copies share the buffer and later writes to the attribute detach it.
+template<class T>
+class TSampleHandle : public SampleHandle
+{
+public:
+    TSampleHandle(const T& v) : m_sample(v)
+    {
+        m_data.data = &m_sample;
+        m_data.num_elements = 1;
+    }
+
+private:
+    T m_sample;
+};
+
+template<class T>
+class TSampleHandle<VtArray<T>> : public SampleHandle
+{
+public:
+    TSampleHandle(const VtArray<T>& v) : m_sample(v)
+    {
+        m_data.data = (void*)m_sample.cdata();
+        m_data.num_elements = (int)m_sample.size();
+    }
+
+private:
+    VtArray<T> m_sample;
+};
+
+
+// linear interpolation of array samples. types without specialization are held.
+template<class T>
+struct SampleLerp
+{
+    static const bool enabled = false;
+    static void apply(T *dst, const T *a, const T *b, size_t num, double w) {}
+};
+#define LerpF(T)\
+    template<> struct SampleLerp<T> {\
+        static const bool enabled = true;\
+        static void apply(T *dst, const T *a, const T *b, size_t num, double w) {\
+            mu::Lerp((float*)dst, (const float*)a, (const float*)b, num * (sizeof(T) / sizeof(float)), (float)w);\
+        }\
+    };
+#define LerpD(T)\
+    template<> struct SampleLerp<T> {\
+        static const bool enabled = true;\
+        static void apply(T *dst, const T *a, const T *b, size_t num, double w) {\
+            auto *d = (double*)dst; auto *da = (const double*)a; auto *db = (const double*)b;\
+            size_t n = num * (sizeof(T) / sizeof(double));\
+            for (size_t i = 0; i < n; ++i) { d[i] = da[i] + (db[i] - da[i]) * w; }\
+        }\
+    };
+LerpF(float) LerpF(GfVec2f) LerpF(GfVec3f) LerpF(GfVec4f)
+LerpD(GfVec2d) LerpD(GfVec3d) LerpD(GfVec4d)
+#undef LerpD
+#undef LerpF
+
 struct ConverterFactoryBase
 {
     using Creator = std::function<Attribute* (Attribute*)>;
@@ -217,6 +361,7 @@ public:
 
     void updateSample(Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         if (t == m_time_prev) { return; }
         m_time_prev = t;
         m_usdattr.Get(&m_sample, t);
@@ -224,6 +369,7 @@ public:
 
     bool readSample(AttributeData& dst, Time t, bool copy) override
     {
+        SampleLock lock(m_sample_mutex);
         updateSample(t);
 
         dst.num_elements = 1;
@@ -240,8 +386,9 @@ public:
 
     bool writeSample(const AttributeData& src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         m_sample = *(const rep_t*)src.data;
-        m_usdattr.Set(m_sample, t);
+        setSample(VtValue(m_sample), t);
         return true;
     }
 
@@ -252,7 +399,16 @@ public:
 
     bool setImmediate(const void *src, Time t) override
     {
-        return m_usdattr.Set(*(const rep_t*)src, t);
+        return setSample(VtValue(*(const rep_t*)src), t);
+    }
+
+    SampleHandle* acquireSample(AttributeData& dst, Time t) override
+    {
+        SampleLock lock(m_sample_mutex);
+        updateSample(t);
+        auto *ret = new TSampleHandle<rep_t>(m_sample);
+        dst = ret->getData();
+        return ret;
     }
 
     Attribute* findOrCreateConverter(AttributeType external_type) override
@@ -287,33 +443,44 @@ public:
 
     void updateSample(Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         if (t == m_time_prev) { return; }
         m_time_prev = t;
-        m_usdattr.Get(&m_sample, t);
+        if (m_cache) {
+            evaluateCache(t);
+        }
+        else {
+            m_usdattr.Get(&m_sample, t);
+        }
     }
 
     bool readSample(AttributeData& dst, Time t, bool copy) override
     {
+        SampleLock lock(m_sample_mutex);
         updateSample(t);
 
-        dst.num_elements = (int)m_sample.size();
         if (copy) {
+            // dst.num_elements is the capacity of dst.data
             if (dst.data) {
                 size_t n = std::min<size_t>(m_sample.size(), (size_t)dst.num_elements);
                 memcpy(dst.data, m_sample.cdata(), sizeof(T)*n);
             }
         }
         else {
-            dst.data = m_sample.data();
+            // m_sample may share data with cached samples. non-const data() would make a copy.
+            dst.data = (void*)m_sample.cdata();
         }
+        dst.num_elements = (int)m_sample.size();
         return true;
     }
 
     bool writeSample(const AttributeData& src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
+        m_cache.reset();
         m_sample.resize(src.num_elements);
         memcpy(m_sample.data(), src.data, sizeof(T)*src.num_elements);
-        m_usdattr.Set(m_sample, t);
+        setSample(VtValue(m_sample), t);
         return true;
     }
 
@@ -324,7 +491,17 @@ public:
 
     bool setImmediate(const void *src, Time t) override
     {
-        return m_usdattr.Set(*(const rep_t*)src, t);
+        m_cache.reset();
+        return setSample(VtValue(*(const rep_t*)src), t);
+    }
+
+    SampleHandle* acquireSample(AttributeData& dst, Time t) override
+    {
+        SampleLock lock(m_sample_mutex);
+        updateSample(t);
+        auto *ret = new TSampleHandle<rep_t>(m_sample);
+        dst = ret->getData();
+        return ret;
     }
 
     Attribute* findOrCreateConverter(AttributeType external_type) override
@@ -332,8 +509,94 @@ public:
         return ConverterFactory<this_t>()(this, external_type);
     }
 
+    bool enableCache(size_t max_bytes) override
+    {
+        SampleLock lock(m_sample_mutex);
+        std::unique_ptr<SampleCache> cache(new SampleCache());
+        // default value is kept apart from time samples. its time (NaN) can't be searched.
+        cache->has_default = m_usdattr.Get(&cache->default_sample, UsdTimeCode::Default());
+        cache->size += sizeof(T) * cache->default_sample.size();
+        m_usdattr.GetTimeSamples(&cache->times);
+
+        cache->samples.resize(cache->times.size());
+        for (size_t i = 0; i < cache->times.size(); ++i) {
+            auto& s = cache->samples[i];
+            m_usdattr.Get(&s, cache->times[i]);
+            cache->size += sizeof(T) * s.size();
+            if (cache->size > max_bytes) {
+                usdiLogInfo("TAttribute::enableCache(): %s exceeds %d bytes. fall back to USD.\n", getName(), (int)max_bytes);
+                return false;
+            }
+        }
+
+        m_cache = std::move(cache);
+        m_time_prev = usdiInvalidTime;
+        return true;
+    }
+
+    void disableCache() override
+    {
+        SampleLock lock(m_sample_mutex);
+        m_cache.reset();
+        m_time_prev = usdiInvalidTime;
+    }
+
+    size_t getCacheSize() const override
+    {
+        return m_cache ? m_cache->size : 0;
+    }
+
 private:
+    struct SampleCache
+    {
+        std::vector<double> times;
+        std::vector<rep_t> samples;
+        rep_t default_sample;
+        bool has_default = false;
+        size_t size = 0;
+    };
+
+    void evaluateCache(Time t)
+    {
+        const auto& times = m_cache->times;
+        const auto& samples = m_cache->samples;
+        if (std::isnan(t) || times.empty()) {
+            // same as UsdAttribute::Get(): default time or not animated. m_sample is kept if there is no default value.
+            if (m_cache->has_default) {
+                m_sample = m_cache->default_sample;
+            }
+            return;
+        }
+        if (times.size() == 1 || t <= times.front()) {
+            m_sample = samples.front();
+            return;
+        }
+        if (t >= times.back()) {
+            m_sample = samples.back();
+            return;
+        }
+
+        size_t i1 = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+        size_t i0 = i1 - 1;
+        const auto& s0 = samples[i0];
+        const auto& s1 = samples[i1];
+        bool linear = SampleLerp<T>::enabled &&
+            m_parent->getImportSettings().interpolation == InterpolationType::Linear &&
+            times[i0] != t && s0.size() == s1.size();
+        if (!linear) {
+            // held. no copy as VtArray shares the data.
+            m_sample = s0;
+            return;
+        }
+
+        double w = (t - times[i0]) / (times[i1] - times[i0]);
+        rep_t tmp(s0.size());
+        SampleLerp<T>::apply(tmp.data(), s0.cdata(), s1.cdata(), s0.size(), w);
+        m_sample.swap(tmp);
+    }
+
     rep_t m_sample;
+    std::unique_ptr<SampleCache> m_cache;
 };
 
 
@@ -344,6 +607,42 @@ template<> const char* cstr(const std::string& v) { return v.c_str(); }
 template<> const char* cstr(const TfToken& v) { return v.GetText(); }
 template<> const char* cstr(const SdfAssetPath& v) { return v.GetAssetPath().c_str(); }
 
+// data is const char* for scalar, const char** (null terminated) for arrays.
+template<class T>
+class TStringSampleHandle : public SampleHandle
+{
+public:
+    TStringSampleHandle(const T& v) : m_sample(v)
+    {
+        m_data.data = (void*)cstr(m_sample);
+        m_data.num_elements = 1;
+    }
+
+private:
+    T m_sample;
+};
+
+template<class T>
+class TStringSampleHandle<VtArray<T>> : public SampleHandle
+{
+public:
+    TStringSampleHandle(const VtArray<T>& v) : m_sample(v)
+    {
+        // cdata(): non-const access would detach the shared buffer
+        m_pointers.resize(m_sample.size());
+        for (size_t i = 0; i < m_sample.size(); ++i) {
+            m_pointers[i] = cstr(m_sample.cdata()[i]);
+        }
+        m_pointers.push_back(nullptr);
+        m_data.data = m_pointers.data();
+        m_data.num_elements = (int)m_sample.size();
+    }
+
+private:
+    VtArray<T> m_sample;
+    std::vector<const char*> m_pointers;
+};
+
 template<class T>
 class TStringAttribute : public Attribute
 {
@@ -365,6 +664,7 @@ public:
 
     void updateSample(Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         if (t == m_time_prev) { return; }
         m_time_prev = t;
         m_usdattr.Get(&m_sample, t);
@@ -372,6 +672,7 @@ public:
 
     bool readSample(AttributeData& dst, Time t, bool copy) override
     {
+        SampleLock lock(m_sample_mutex);
         updateSample(t);
 
         dst.num_elements = 1;
@@ -381,8 +682,9 @@ public:
 
     bool writeSample(const AttributeData& src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         m_sample = rep_t((const char*)src.data);
-        m_usdattr.Set(m_sample, t);
+        setSample(VtValue(m_sample), t);
         return true;
     }
 
@@ -393,7 +695,16 @@ public:
 
     bool setImmediate(const void *src, Time t) override
     {
-        return m_usdattr.Set(*(const rep_t*)src, t);
+        return setSample(VtValue(*(const rep_t*)src), t);
+    }
+
+    SampleHandle* acquireSample(AttributeData& dst, Time t) override
+    {
+        SampleLock lock(m_sample_mutex);
+        updateSample(t);
+        auto *ret = new TStringSampleHandle<rep_t>(m_sample);
+        dst = ret->getData();
+        return ret;
     }
 
 private:
@@ -421,6 +732,7 @@ public:
 
     void updateSample(Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         if (t == m_time_prev) { return; }
         m_time_prev = t;
         m_usdattr.Get(&m_sample, t);
@@ -434,6 +746,7 @@ public:
 
     bool readSample(AttributeData& dst, Time t, bool copy) override
     {
+        SampleLock lock(m_sample_mutex);
         updateSample(t);
 
         dst.num_elements = (int)m_sample.size();
@@ -443,11 +756,12 @@ public:
 
     bool writeSample(const AttributeData& src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         m_sample.resize(src.num_elements);
         for (int i = 0; i < src.num_elements; ++i) {
             m_sample[i] = T(((const char**)src.data)[i]);
         }
-        m_usdattr.Set(m_sample, t);
+        setSample(VtValue(m_sample), t);
         return true;
     }
 
@@ -458,7 +772,16 @@ public:
 
     bool setImmediate(const void *src, Time t) override
     {
-        return m_usdattr.Set(*(const rep_t*)src, t);
+        return setSample(VtValue(*(const rep_t*)src), t);
+    }
+
+    SampleHandle* acquireSample(AttributeData& dst, Time t) override
+    {
+        SampleLock lock(m_sample_mutex);
+        updateSample(t);
+        auto *ret = new TStringSampleHandle<rep_t>(m_sample);
+        dst = ret->getData();
+        return ret;
     }
 
 private:
@@ -517,6 +840,7 @@ public:
 
     void updateSample(Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         if (t == m_time_prev) { return; }
         m_time_prev = t;
         m_usdattr.Get(&m_tmp, t);
@@ -525,6 +849,7 @@ public:
 
     bool readSample(AttributeData& dst, Time t, bool copy) override
     {
+        SampleLock lock(m_sample_mutex);
         updateSample(t);
 
         dst.num_elements = 1;
@@ -541,13 +866,15 @@ public:
 
     bool writeSample(const AttributeData& src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         TAssign(m_tmp, *(const T*)src.data);
-        m_usdattr.Set(m_tmp, t);
+        setSample(VtValue(m_tmp), t);
         return true;
     }
 
     bool getImmediate(void *dst, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         m_usdattr.Get(&m_tmp, t);
         TAssign(*(external_t*)dst, m_tmp);
         return true;
@@ -555,8 +882,18 @@ public:
 
     bool setImmediate(const void *src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         TAssign(m_tmp, *(const external_t*)src);
-        return m_usdattr.Set(m_tmp, t);
+        return setSample(VtValue(m_tmp), t);
+    }
+
+    SampleHandle* acquireSample(AttributeData& dst, Time t) override
+    {
+        SampleLock lock(m_sample_mutex);
+        updateSample(t);
+        auto *ret = new TSampleHandle<external_t>(m_sample);
+        dst = ret->getData();
+        return ret;
     }
 
 private:
@@ -564,6 +901,59 @@ private:
     external_t m_sample;
 };
 
+// scalar type and number of components of array elements.
+// elements that have the same number of components and bulk-convertible scalar types are converted by SIMD kernels.
+template<class T> struct ElementTraits { using scalar_t = void; static const int num_components = 0; };
+#define Def(T, S, N) template<> struct ElementTraits<T> { using scalar_t = S; static const int num_components = N; };
+Def(half, half, 1) Def(float, float, 1) Def(double, double, 1)
+Def(GfVec2h, half, 2) Def(GfVec2f, float, 2) Def(GfVec2d, double, 2)
+Def(GfVec3h, half, 3) Def(GfVec3f, float, 3) Def(GfVec3d, double, 3)
+Def(GfVec4h, half, 4) Def(GfVec4f, float, 4) Def(GfVec4d, double, 4)
+Def(GfMatrix2f, float, 4) Def(GfMatrix2d, double, 4)
+Def(GfMatrix3f, float, 9) Def(GfMatrix3d, double, 9)
+Def(GfMatrix4f, float, 16) Def(GfMatrix4d, double, 16)
+#undef Def
+
+template<class Dst, class Src> struct BulkConvert { static const bool enabled = false; };
+#define Def(Dst, Src, F) template<> struct BulkConvert<Dst, Src> {\
+    static const bool enabled = true;\
+    static void convert(Dst *dst, const Src *src, size_t n) { F; }\
+};
+Def(float, double, mu::DoubleToFloat(dst, src, n))
+Def(double, float, mu::FloatToDouble(dst, src, n))
+Def(float, half, mu::HalfToFloat(dst, (const uint16_t*)src, n))
+Def(half, float, mu::FloatToHalf((uint16_t*)dst, src, n))
+#undef Def
+
+template<class Dst, class Src, bool Bulk>
+struct TConvertElements
+{
+    void operator()(Dst *dst, const Src *src, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) { TAssign(dst[i], src[i]); }
+    }
+};
+template<class Dst, class Src>
+struct TConvertElements<Dst, Src, true>
+{
+    void operator()(Dst *dst, const Src *src, size_t n)
+    {
+        using dst_s = typename ElementTraits<Dst>::scalar_t;
+        using src_s = typename ElementTraits<Src>::scalar_t;
+        BulkConvert<dst_s, src_s>::convert((dst_s*)dst, (const src_s*)src, n * ElementTraits<Dst>::num_components);
+    }
+};
+
+template<class Dst, class Src>
+inline void ConvertElements(Dst *dst, const Src *src, size_t n)
+{
+    const bool bulk =
+        ElementTraits<Dst>::num_components > 0 &&
+        ElementTraits<Dst>::num_components == ElementTraits<Src>::num_components &&
+        BulkConvert<typename ElementTraits<Dst>::scalar_t, typename ElementTraits<Src>::scalar_t>::enabled;
+    TConvertElements<Dst, Src, bulk>()(dst, src, n);
+}
+
 template<class T, class U>
 struct TConvert
 {
@@ -571,24 +961,24 @@ struct TConvert
     {
         size_t n = src.size();
         dst.resize(n);
-        for (size_t i = 0; i < n; ++i) { TAssign(dst[i], src[i]); }
+        ConvertElements(dst.data(), src.cdata(), n);
     }
     void operator()(T* dst, size_t dst_len, const VtArray<T>& src)
     {
         size_t n = std::min<size_t>(dst_len, src.size());
-        for (size_t i = 0; i < n; ++i) { dst[i] = src[i]; }
+        std::copy_n(src.cdata(), n, dst);
     }
     void operator()(VtArray<U>& dst, const VtArray<T>& src)
     {
         size_t n = src.size();
         dst.resize(n);
-        for (size_t i = 0; i < n; ++i) { TAssign(dst[i], src[i]); }
+        ConvertElements(dst.data(), src.cdata(), n);
     }
     void operator()(VtArray<U>& dst, const T *src, size_t src_len)
     {
         size_t n = src_len;
         dst.resize(n);
-        for (size_t i = 0; i < n; ++i) { TAssign(dst[i], src[i]); }
+        ConvertElements(dst.data(), src, n);
     }
 };
 
@@ -617,6 +1007,7 @@ public:
 
     void updateSample(Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         if (t == m_time_prev) { return; }
         m_time_prev = t;
         m_usdattr.Get(&m_tmp, t);
@@ -625,29 +1016,33 @@ public:
 
     bool readSample(AttributeData& dst, Time t, bool copy) override
     {
+        SampleLock lock(m_sample_mutex);
         updateSample(t);
 
-        dst.num_elements = (int)m_sample.size();
         if (copy) {
+            // dst.num_elements is the capacity of dst.data
             if (dst.data) {
                 Convert()((external_v*)dst.data, (size_t)dst.num_elements, m_sample);
             }
         }
         else {
-            dst.data = &m_sample;
+            dst.data = (void*)m_sample.cdata();
         }
+        dst.num_elements = (int)m_sample.size();
         return true;
     }
 
     bool writeSample(const AttributeData& src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         Convert()(m_tmp, (const external_v*)src.data, (size_t)src.num_elements);
-        m_usdattr.Set(m_tmp, t);
+        setSample(VtValue(m_tmp), t);
         return true;
     }
 
     bool getImmediate(void *dst, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         m_usdattr.Get(&m_tmp, t);
         Convert()(*(external_t*)dst, m_tmp);
         return true;
@@ -655,8 +1050,18 @@ public:
 
     bool setImmediate(const void *src, Time t) override
     {
+        SampleLock lock(m_sample_mutex);
         Convert()(m_tmp, *(external_t*)src);
-        return m_usdattr.Set(m_tmp, t);
+        return setSample(VtValue(m_tmp), t);
+    }
+
+    SampleHandle* acquireSample(AttributeData& dst, Time t) override
+    {
+        SampleLock lock(m_sample_mutex);
+        updateSample(t);
+        auto *ret = new TSampleHandle<external_t>(m_sample);
+        dst = ret->getData();
+        return ret;
     }
 
 private:
@@ -683,6 +1088,9 @@ static struct InitConverterFactory
         // make vector attributes convertible
         // (this maybe overkill... /bigobj is required because of this)
 
+        MakeConvertible(half, Add(float));
+        MakeConvertible(float, Add(half));
+
         MakeConvertible(GfVec2h, Add(GfVec2f) Add(GfVec2d) Add(GfVec3h) Add(GfVec3f) Add(GfVec3d) Add(GfVec4h) Add(GfVec4f) Add(GfVec4d));
         MakeConvertible(GfVec2f, Add(GfVec2h) Add(GfVec2d) Add(GfVec3h) Add(GfVec3f) Add(GfVec3d) Add(GfVec4h) Add(GfVec4f) Add(GfVec4d));
         MakeConvertible(GfVec2d, Add(GfVec2h) Add(GfVec2f) Add(GfVec3h) Add(GfVec3f) Add(GfVec3d) Add(GfVec4h) Add(GfVec4f) Add(GfVec4d));
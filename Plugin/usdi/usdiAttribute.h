@@ -2,6 +2,23 @@
 
 namespace usdi {
 
+// pinned view of an attribute sample. data stays valid until the last release() even if the attribute moves to other samples.
+// array samples share the buffer with the attribute (VtArray is copy-on-write), so acquiring one doesn't copy elements.
+class SampleHandle
+{
+public:
+    const AttributeData& getData() const;
+    void    retain();
+    void    release(); // delete this when the reference count reaches 0
+
+protected:
+    SampleHandle();
+    virtual ~SampleHandle();
+
+    AttributeData m_data;
+    std::atomic_int m_ref_count;
+};
+
 class Attribute
 {
 public:
@@ -14,6 +31,8 @@ public:
     const char*     getTypeName() const;
     AttributeType   getType() const;
     bool            isConstant() const;
+    // size of an element in byte. 0 if unknown.
+    size_t          getElementSize() const;
     bool            hasValue() const;
     size_t          getNumSamples() const;
     bool            getTimeRange(Time& start, Time& end);
@@ -24,12 +43,24 @@ public:
     virtual bool    writeSample(const AttributeData& src, Time t) = 0;
     virtual bool    getImmediate(void *dst, Time t) = 0;
     virtual bool    setImmediate(const void *src, Time t) = 0;
+    // zero-copy & thread safe read. dst points to the pinned sample. return null if failed.
+    virtual SampleHandle* acquireSample(AttributeData& dst, Time t);
+
+    // pre-read all authored samples and evaluate them in usdi instead of USD.
+    // return false and keep reading from USD if the samples take more than max_bytes or the type is not supported.
+    virtual bool    enableCache(size_t max_bytes);
+    virtual void    disableCache();
+    // 0 if cache is disabled
+    virtual size_t  getCacheSize() const;
 
     Attribute*          findConverter(AttributeType external_type);
     virtual Attribute*  findOrCreateConverter(AttributeType external_type);
     void                addConverter(Attribute *attr); // internal
 
 protected:
+    // write values through Context::setSample() so that write frames can batch them
+    bool setSample(const VtValue& v, Time t);
+
     using AttributePtr = std::unique_ptr<Attribute>;
     using Attributes = std::vector<AttributePtr>;
 
@@ -40,6 +71,8 @@ protected:
     Time m_time_end = usdiInvalidTime;
     Time m_time_prev = usdiInvalidTime;
     Attributes m_converters;
+    // guards the current sample. readSample() & acquireSample() can be called from multiple threads.
+    std::recursive_mutex m_sample_mutex;
 
 #ifdef usdiDebug
     const char *m_dbg_name = nullptr;
@@ -47,6 +80,9 @@ protected:
 #endif
 };
 
+size_t GetElementSize(AttributeType type);
+bool IsStringType(AttributeType type);
+
 Attribute* WrapExistingAttribute(Schema *parent, UsdAttribute usd);
 Attribute* WrapExistingAttribute(Schema *parent, const char *name);
 
@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiAttribute.h"
+#include "usdiAttributeBatch.h"
+#include "usdiUtils.h"
+
+namespace usdi {
+
+AttributeBatch::AttributeBatch()
+{
+    usdiLogTrace("AttributeBatch::AttributeBatch()\n");
+}
+
+AttributeBatch::~AttributeBatch()
+{
+    usdiLogTrace("AttributeBatch::~AttributeBatch()\n");
+}
+
+int AttributeBatch::add(Attribute *attr, size_t offset, int capacity)
+{
+    if (!attr || capacity <= 0) {
+        usdiLogError("AttributeBatch::add(): invalid parameter\n");
+        return -1;
+    }
+
+    Entry e;
+    e.attr = attr;
+    e.offset = offset;
+    e.capacity = capacity;
+    e.element_size = attr->getElementSize();
+    e.is_string = IsStringType(attr->getType());
+    e.constant = attr->isConstant();
+    if (e.element_size == 0) {
+        usdiLogError("AttributeBatch::add(): %s has unknown type\n", attr->getName());
+        return -1;
+    }
+    if (e.is_string) {
+        // string attributes write only a pointer
+        e.capacity = 1;
+    }
+
+    int index = (int)m_entries.size();
+    m_entries.push_back(e);
+
+    auto g = m_group_indices.find(attr);
+    if (g != m_group_indices.end()) {
+        m_groups[g->second].push_back(index);
+    }
+    else {
+        m_group_indices[attr] = (int)m_groups.size();
+        m_groups.push_back({ index });
+    }
+    return index;
+}
+
+void AttributeBatch::clear()
+{
+    m_entries.clear();
+    m_groups.clear();
+    m_group_indices.clear();
+    m_arena_prev = nullptr;
+}
+
+int AttributeBatch::getNumEntries() const
+{
+    return (int)m_entries.size();
+}
+
+void AttributeBatch::readEntry(Entry& e, char *arena, Time t, bool same_arena)
+{
+    // constant attributes are read only once as long as the arena is the same
+    if (e.constant && e.has_value && same_arena) {
+        e.changed = false;
+        return;
+    }
+
+    char *dst = arena + e.offset;
+    AttributeData data;
+    data.data = dst;
+    data.num_elements = e.capacity;
+    if (!e.attr->readSample(data, t, true)) {
+        e.changed = false;
+        return;
+    }
+
+    uint64_t hash = 0;
+    if (e.is_string) {
+        if (e.attr->getType() < AttributeType::UnknownArray) {
+            auto *str = *(const char**)dst;
+            hash = Hash64(str, strlen(str));
+        }
+        else {
+            auto *strs = *(const char***)dst;
+            for (int i = 0; i < data.num_elements; ++i) {
+                hash = Hash64(strs[i], strlen(strs[i]), hash);
+            }
+        }
+    }
+    else {
+        size_t n = std::min<size_t>(data.num_elements, e.capacity);
+        hash = Hash64(dst, e.element_size * n);
+    }
+
+    e.changed = !e.has_value || hash != e.hash || data.num_elements != e.num_elements;
+    e.has_value = true;
+    e.hash = hash;
+    e.num_elements = data.num_elements;
+}
+
+int AttributeBatch::read(void *arena_, Time t, uint *changed_mask, int *num_elements)
+{
+    if (!arena_) {
+        usdiLogError("AttributeBatch::read(): arena is null\n");
+        return 0;
+    }
+
+    auto *arena = (char*)arena_;
+    bool same_arena = arena_ == m_arena_prev;
+    m_arena_prev = arena_;
+
+#ifdef usdiDbgForceSingleThread
+    for (auto& g : m_groups) {
+        for (int i : g) { readEntry(m_entries[i], arena, t, same_arena); }
+    }
+#else
+    size_t grain = std::max<size_t>(m_groups.size() / 32, 1);
+    using range_t = tbb::blocked_range<size_t>;
+    tbb::parallel_for(range_t(0, m_groups.size(), grain), [&](const range_t& r) {
+        for (size_t gi = r.begin(); gi != r.end(); ++gi) {
+            for (int i : m_groups[gi]) { readEntry(m_entries[i], arena, t, same_arena); }
+        }
+    });
+#endif
+
+    int num_changed = 0;
+    int n = (int)m_entries.size();
+    if (changed_mask) {
+        memset(changed_mask, 0, sizeof(uint) * ((n + 31) / 32));
+    }
+    for (int i = 0; i < n; ++i) {
+        const auto& e = m_entries[i];
+        if (e.changed) {
+            ++num_changed;
+            if (changed_mask) { changed_mask[i / 32] |= 1u << (i % 32); }
+        }
+        if (num_elements) { num_elements[i] = e.num_elements; }
+    }
+    return num_changed;
+}
+
+} // namespace usdi
@@ -0,0 +1,55 @@
+#pragma once
+
+namespace usdi {
+
+// reads many attributes at once into a caller-provided buffer (arena).
+// entries are registered once with add(), then read() fills the arena for all of them in parallel.
+class AttributeBatch
+{
+public:
+    AttributeBatch();
+    ~AttributeBatch();
+
+    // offset: position in the arena in byte. capacity: number of elements the arena can hold at offset.
+    // return index of the entry. -1 if failed.
+    int     add(Attribute *attr, size_t offset, int capacity);
+    void    clear();
+    int     getNumEntries() const;
+
+    // changed_mask: bit i is set if the value of entry i differs from the last read(). ((num_entries + 31) / 32) elements.
+    // num_elements: actual number of elements of each entry. can be > capacity. num_entries elements.
+    // both can be null. return number of changed entries.
+    int     read(void *arena, Time t, uint *changed_mask, int *num_elements);
+
+private:
+    struct Entry
+    {
+        Attribute   *attr = nullptr;
+        size_t      offset = 0;
+        int         capacity = 0;
+        size_t      element_size = 0;
+        bool        is_string = false;
+        bool        constant = false;
+
+        // state of the last read
+        bool        has_value = false;
+        bool        changed = false;
+        int         num_elements = 0;
+        uint64_t    hash = 0;
+    };
+    using Entries = std::vector<Entry>;
+    using Group = std::vector<int>;
+    using Groups = std::vector<Group>;
+
+    void    readEntry(Entry& e, char *arena, Time t, bool same_arena);
+
+private:
+    Entries m_entries;
+    // entries that share the same attribute are read serially in one group.
+    // attributes are not thread safe, but different attributes can be read in parallel.
+    Groups  m_groups;
+    std::map<Attribute*, int> m_group_indices;
+    void    *m_arena_prev = nullptr;
+};
+
+} // namespace usdi
@@ -77,7 +77,7 @@ void Camera::updateSample(Time t_)
 
 bool Camera::readSample(CameraData& dst, Time t)
 {
-    if (t != m_time_prev) { updateSample(t); }
+    updateSampleIfNeeded(t);
 
     dst = m_sample;
     return true;
@@ -87,9 +87,20 @@ bool Camera::writeSample(const CameraData& src, Time t_)
 {
     auto t = UsdTimeCode(t_);
 
+    // looking up attributes reads the stage. in parallel export other threads may be adding attributes to it.
+    UsdAttribute attr_range, attr_focal_length, attr_focus_distance, attr_vaperture, attr_haperture;
+    {
+        auto lock = m_ctx->lockStage();
+        attr_range = m_cam.GetClippingRangeAttr();
+        attr_focal_length = m_cam.GetFocalLengthAttr();
+        attr_focus_distance = m_cam.GetFocusDistanceAttr();
+        attr_vaperture = m_cam.GetVerticalApertureAttr();
+        attr_haperture = m_cam.GetHorizontalApertureAttr();
+    }
+
     {
         auto range = GfVec2f(src.near_clipping_plane, src.far_clipping_plane);
-        m_cam.GetClippingRangeAttr().Set(range, t);
+        setSample(attr_range, VtValue(range), t);
     }
 
     {
@@ -98,10 +109,10 @@ bool Camera::writeSample(const CameraData& src, Time t_)
             focal_length = src.aperture / std::tan(src.field_of_view * Deg2Rad / 2.0f) / 2.0f;
         }
 
-        m_cam.GetFocalLengthAttr().Set(focal_length, t);
-        m_cam.GetFocusDistanceAttr().Set(src.focus_distance, t);
-        m_cam.GetVerticalApertureAttr().Set(src.aperture, t);
-        m_cam.GetHorizontalApertureAttr().Set(src.aperture * src.aspect_ratio, t);
+        setSample(attr_focal_length, VtValue(focal_length), t);
+        setSample(attr_focus_distance, VtValue(src.focus_distance), t);
+        setSample(attr_vaperture, VtValue(src.aperture), t);
+        setSample(attr_haperture, VtValue(src.aperture * src.aspect_ratio), t);
     }
 
     return true;
@@ -0,0 +1,227 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiContext.h"
+#include "usdiClipWriter.h"
+#include "usdiUtils.h"
+
+namespace usdi {
+
+ClipWriter::ClipWriter(Context *ctx, const ClipExportSettings& settings)
+    : m_ctx(ctx)
+    , m_settings(settings)
+{
+    m_settings.frames_per_clip = std::max<int>(m_settings.frames_per_clip, 1);
+
+    // clips are placed next to the root layer unless a directory is given
+    std::string ext;
+    SplitLayerPath(m_ctx->getUsdStage()->GetRootLayer(), m_dir, m_basename, ext);
+    if (m_basename.empty()) {
+        m_basename = "clip";
+    }
+    if (m_settings.directory && m_settings.directory[0]) {
+        // asset paths are absolute. they can't be relative to a root layer that may be saved anywhere.
+        m_dir = m_settings.directory;
+        if (m_dir.back() != '/' && m_dir.back() != '\\') {
+            m_dir += '/';
+        }
+        m_asset_dir = m_dir;
+    }
+    // not kept. copied to m_dir
+    m_settings.directory = nullptr;
+    m_manifest_path = makeAssetPath(".manifest.usda");
+
+    usdiLogTrace("ClipWriter::ClipWriter()\n");
+}
+
+ClipWriter::~ClipWriter()
+{
+    usdiLogTrace("ClipWriter::~ClipWriter()\n");
+}
+
+const ClipExportSettings& ClipWriter::getSettings() const
+{
+    return m_settings;
+}
+
+int ClipWriter::getNumClips() const
+{
+    return (int)m_clips.size();
+}
+
+std::string ClipWriter::makeAssetPath(const std::string& suffix) const
+{
+    return m_asset_dir + m_basename + suffix;
+}
+
+std::string ClipWriter::makeFilePath(const std::string& asset_path) const
+{
+    if (asset_path.compare(0, 2, "./") != 0) { return asset_path; }
+    // strip "./"
+    return m_dir + asset_path.substr(2);
+}
+
+void ClipWriter::beginClip(Time t)
+{
+    char suffix[64];
+    sprintf(suffix, ".clip%04d.%s", (int)m_clips.size(), m_settings.binary ? "usdc" : "usda");
+
+    Clip c;
+    c.asset_path = makeAssetPath(suffix);
+    c.start = c.end = t;
+    m_clips.push_back(c);
+
+    // anonymous. the format is decided by the extension on Export()
+    m_layer = SdfLayer::CreateAnonymous();
+    m_num_frames = 1;
+}
+
+bool ClipWriter::endPreviousClip()
+{
+    if (!m_prev_layer) { return true; }
+
+    bool ret = saveClip(m_prev_layer, m_clips[m_clips.size() - 2]);
+    // this is the only reference. samples of the clip are freed here.
+    m_prev_layer = SdfLayerRefPtr();
+    return ret;
+}
+
+bool ClipWriter::saveClip(const SdfLayerRefPtr& layer, const Clip& clip)
+{
+    if (!layer) { return true; }
+
+    auto path = makeFilePath(clip.asset_path);
+    if (!layer->Export(path)) {
+        usdiLogError("ClipWriter::saveClip(): failed to write %s\n", path.c_str());
+        return false;
+    }
+    usdiLogInfo("ClipWriter::saveClip(): %s\n", path.c_str());
+    return true;
+}
+
+bool ClipWriter::writeSample(const SdfLayerRefPtr& layer, const UsdAttribute& attr, const VtValue& v, Time t)
+{
+    const auto& path = attr.GetPath();
+    if (!layer->GetAttributeAtPath(path)) {
+        auto prim = SdfCreatePrimInLayer(layer, path.GetPrimPath());
+        if (!prim || !SdfAttributeSpec::New(prim, path.GetName(), attr.GetTypeName())) {
+            usdiLogError("ClipWriter::write(): failed to create spec %s\n", path.GetText());
+            return false;
+        }
+        m_attributes[path] = attr.GetTypeName();
+    }
+    layer->SetTimeSample(SdfAbstractDataSpecId(&path), t, v);
+    return true;
+}
+
+bool ClipWriter::write(const UsdAttribute& attr, const VtValue& v, Time t)
+{
+    if (!m_clips.empty() && t < m_clips.back().start) {
+        if (m_clips.size() > 1) {
+            // the clip for this time is already saved and released
+            usdiLogError("ClipWriter::write(): %s: time %lf is before the current clip (%lf). samples must be written in time order\n",
+                attr.GetPath().GetText(), t, m_clips.back().start);
+            return false;
+        }
+        // the first clip is active for all times before the second one. it just starts earlier.
+        m_clips.back().start = t;
+        ++m_num_frames;
+    }
+
+    bool ret = true;
+    if (!m_layer) {
+        beginClip(t);
+    }
+    else if (t > m_clips.back().end && m_num_frames >= m_settings.frames_per_clip) {
+        ret = endPreviousClip();
+        m_prev_layer = m_layer;
+        beginClip(t);
+    }
+    else if (m_prev_layer && t > m_clips.back().start) {
+        // the first frame of the current clip is complete
+        ret = endPreviousClip();
+    }
+
+    auto& clip = m_clips.back();
+    if (t > clip.end) {
+        clip.end = t;
+        ++m_num_frames;
+    }
+
+    ret = writeSample(m_layer, attr, v, t) && ret;
+    if (m_prev_layer && t == clip.start) {
+        // the first frame of a clip is written to the previous clip too. value resolution doesn't look into other clips,
+        // so times between the last frame of a clip and the next clip interpolate to it.
+        m_clips[m_clips.size() - 2].end = t;
+        ret = writeSample(m_prev_layer, attr, v, t) && ret;
+    }
+    return ret;
+}
+
+bool ClipWriter::writeManifest()
+{
+    // declares all attributes that have samples in clips. value resolution consults clips only for these.
+    auto layer = SdfLayer::CreateAnonymous();
+    for (auto& kvp : m_attributes) {
+        const auto& path = kvp.first;
+        auto prim = SdfCreatePrimInLayer(layer, path.GetPrimPath());
+        if (prim) {
+            SdfAttributeSpec::New(prim, path.GetName(), kvp.second);
+        }
+    }
+
+    auto path = makeFilePath(m_manifest_path);
+    if (!layer->Export(path)) {
+        usdiLogError("ClipWriter::writeManifest(): failed to write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void ClipWriter::writeClipMetadata()
+{
+    VtArray<SdfAssetPath> asset_paths;
+    VtVec2dArray active, times;
+    for (size_t i = 0; i < m_clips.size(); ++i) {
+        const auto& c = m_clips[i];
+        asset_paths.push_back(SdfAssetPath(c.asset_path));
+        active.push_back(GfVec2d(c.start, (double)i));
+        // clips are not retimed
+        times.push_back(GfVec2d(c.start, c.start));
+        if (c.end != c.start) {
+            times.push_back(GfVec2d(c.end, c.end));
+        }
+    }
+    SdfAssetPath manifest(m_manifest_path);
+
+    // clip metadata applies to the prim and its descendants. top-level prims cover all written attributes.
+    std::set<SdfPath> roots;
+    for (auto& kvp : m_attributes) {
+        roots.insert(kvp.first.GetPrefixes().front());
+    }
+
+    auto stage = m_ctx->getUsdStage();
+    for (auto& root : roots) {
+        auto prim = stage->GetPrimAtPath(root);
+        if (!prim) { continue; }
+        prim.SetMetadata(UsdTokens->clipAssetPaths, asset_paths);
+        prim.SetMetadata(UsdTokens->clipPrimPath, root.GetString());
+        prim.SetMetadata(UsdTokens->clipActive, active);
+        prim.SetMetadata(UsdTokens->clipTimes, times);
+        prim.SetMetadata(UsdTokens->clipManifestAssetPath, manifest);
+    }
+}
+
+bool ClipWriter::flush()
+{
+    if (m_clips.empty()) { return true; }
+
+    bool ret = saveClip(m_layer, m_clips.back());
+    if (m_prev_layer) {
+        ret = saveClip(m_prev_layer, m_clips[m_clips.size() - 2]) && ret;
+    }
+    ret = writeManifest() && ret;
+    writeClipMetadata();
+    return ret;
+}
+
+} // namespace usdi
@@ -0,0 +1,59 @@
+#pragma once
+
+namespace usdi {
+
+// streams time samples into value clip layers instead of the root layer. owned by Context between
+// beginClipExport() and endClipExport(), and used by Context::authorSample() for non-default times.
+// each clip holds frames_per_clip sample times. when it is full it is saved next to the root layer (or to
+// ClipExportSettings::directory) and released, so memory usage doesn't grow with the length of the recording.
+// a clip also has the first frame of the next one, so that times between them interpolate. samples older than the
+// current clip are rejected. the root layer keeps prims and default values, and flush() writes
+// a manifest layer and value clip metadata on the top-level prims that stitch the clips together.
+class ClipWriter
+{
+public:
+    ClipWriter(Context *ctx, const ClipExportSettings& settings);
+    ~ClipWriter();
+
+    const ClipExportSettings& getSettings() const;
+    bool    write(const UsdAttribute& attr, const VtValue& v, Time t);
+    // save the current clip (it stays open) and the manifest, and update clip metadata in the edit target layer
+    bool    flush();
+    int     getNumClips() const;
+
+private:
+    struct Clip
+    {
+        std::string asset_path; // relative to the root layer
+        Time        start = 0.0;
+        Time        end = 0.0;
+    };
+    using Clips = std::vector<Clip>;
+    // sorted. deterministic manifest and metadata
+    using Attributes = std::map<SdfPath, SdfValueTypeName>;
+
+    std::string makeAssetPath(const std::string& suffix) const;
+    std::string makeFilePath(const std::string& asset_path) const;
+    void    beginClip(Time t);
+    bool    endPreviousClip();
+    bool    saveClip(const SdfLayerRefPtr& layer, const Clip& clip);
+    bool    writeSample(const SdfLayerRefPtr& layer, const UsdAttribute& attr, const VtValue& v, Time t);
+    bool    writeManifest();
+    void    writeClipMetadata();
+
+private:
+    Context             *m_ctx = nullptr;
+    ClipExportSettings  m_settings;
+    std::string         m_dir;      // directory of clips, with trailing separator
+    std::string         m_asset_dir = "./"; // prefix of asset paths of clips and the manifest
+    std::string         m_basename; // file name of the root layer without extension
+    std::string         m_manifest_path;
+
+    SdfLayerRefPtr      m_layer;    // current clip
+    SdfLayerRefPtr      m_prev_layer; // previous clip. kept until the first frame of the current clip is written to it too
+    int                 m_num_frames = 0; // sample times in the current clip
+    Clips               m_clips;
+    Attributes          m_attributes;
+};
+
+} // namespace usdi
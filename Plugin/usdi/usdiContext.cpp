@@ -6,6 +6,15 @@
 #include "usdiMesh.h"
 #include "usdiPoints.h"
 #include "usdiContext.h"
+#include "usdiPayloadStreamer.h"
+#include "usdiUpdateScheduler.h"
+#include "usdiRecorder.h"
+#include "usdiSchemaIndex.h"
+#include "usdiSampleDeduplicator.h"
+#include "usdiClipWriter.h"
+#include "usdiPartitionWriter.h"
+#include "usdiAsyncSave.h"
+#include "usdiUtils.h"
 
 void mDetachAllThreads();
 
@@ -20,6 +29,8 @@ static int g_ctx_count;
 
 
 Context::Context()
+    : m_schema_index(new SchemaIndex())
+    , m_sample_dedup(new SampleDeduplicator(this))
 {
     ++g_ctx_count;
     if (g_ctx_count == 1) {
@@ -35,6 +46,8 @@ Context::Context()
 Context::~Context()
 {
     initialize();
+    // finish pending async saves
+    m_async_save_queue.reset();
     usdiLogTrace("Context::~Context()\n");
     --g_ctx_count;
 
@@ -53,6 +66,20 @@ bool Context::valid() const
 
 void Context::initialize()
 {
+    // writes all pending samples
+    m_recorder.reset();
+    m_clip_writer.reset();
+    m_partition_writer.reset();
+    m_sample_dedup->clear();
+    {
+        tbb::spin_mutex::scoped_lock lock(m_write_frame_mutex);
+        m_write_frames.clear();
+    }
+    m_payload_streamer.reset();
+    m_update_scheduler.reset();
+    TfNotice::Revoke(m_notice_key);
+    m_resynced_paths.clear();
+
     if (m_stage) {
         m_stage->Close();
     }
@@ -61,7 +88,12 @@ void Context::initialize()
     // delete USD objects in reverse order
     for (auto i = m_schemas.rbegin(); i != m_schemas.rend(); ++i) { i->reset(); }
     m_schemas.clear();
+    m_schema_index->clear();
+    m_masters.clear();
+    m_root = nullptr;
+    ++m_tree_revision;
 
+    m_lazy_schema_tree = false;
     m_id_seed = 0;
     m_start_time = 0.0;
     m_end_time = 0.0;
@@ -117,25 +149,102 @@ void Context::applyImportConfig()
 
 bool Context::open(const char *path)
 {
+    return open(path, OpenSettings());
+}
+
+bool Context::open(const char *path, const OpenSettings& settings)
+{
+    return open(path, settings, nullptr);
+}
+
+bool Context::open(const char *path, const OpenSettings& settings, OpenState *state)
+{
+    // if the payload streamer is in use, it owns load state of payloads. open without loading them.
+    bool streaming = m_payload_streamer != nullptr;
+    PayloadStreamerSettings streamer_settings;
+    if (streaming) {
+        streamer_settings = m_payload_streamer->getSettings();
+    }
+
     initialize();
+    if (streaming) {
+        getPayloadStreamer()->setSettings(streamer_settings);
+    }
 
     usdiLogInfo( "Context::open(): %s\n", path);
 
-    m_stage = UsdStage::Open(path);
-    if (!m_stage) {
+    auto cancelled = [state]() { return state && state->cancel; };
+    auto set_stage = [state](OpenStage s) { if (state) { state->stage = (int)s; } };
+
+    set_stage(OpenStage::OpeningLayer);
+    auto layer = SdfLayer::FindOrOpen(path);
+    if (!layer) {
         // first try to open .abc often fails (likely Windows-only problem)
         // try again for workaround.
-        m_stage = UsdStage::Open(path);
-        if (!m_stage) {
+        layer = SdfLayer::FindOrOpen(path);
+        if (!layer) {
             usdiLogWarning("Context::open(): failed to load %s\n", path);
+            set_stage(OpenStage::Failed);
             return false;
         }
     }
+    if (cancelled()) {
+        set_stage(OpenStage::Cancelled);
+        return false;
+    }
+
+    set_stage(OpenStage::Composing);
+    auto load = streaming ? UsdStage::LoadNone : UsdStage::LoadAll;
+    if (settings.population_mask && settings.num_population_mask > 0) {
+        UsdStagePopulationMask mask;
+        for (int i = 0; i < settings.num_population_mask; ++i) {
+            if (settings.population_mask[i]) {
+                mask.Add(SdfPath(settings.population_mask[i]));
+            }
+        }
+        m_stage = UsdStage::OpenMasked(layer, mask, load);
+    }
+    else {
+        m_stage = UsdStage::Open(layer, load);
+    }
+    if (!m_stage) {
+        usdiLogWarning("Context::open(): failed to compose %s\n", path);
+        set_stage(OpenStage::Failed);
+        return false;
+    }
+    if (cancelled()) {
+        initialize();
+        set_stage(OpenStage::Cancelled);
+        return false;
+    }
 
+    m_lazy_schema_tree = settings.lazy_schema_tree;
     applyImportConfig();
     m_start_time = m_stage->GetStartTimeCode();
     m_end_time = m_stage->GetEndTimeCode();
+
+    set_stage(OpenStage::BuildingSchemas);
+    if (state && !m_lazy_schema_tree) {
+        // count prims to report progress
+        int n = 0;
+        for (auto& m : m_stage->GetMasters()) {
+            for (auto p : UsdTreeIterator::AllPrims(m)) { ++n; (void)p; }
+        }
+        for (auto p : UsdTreeIterator::AllPrims(m_stage->GetPseudoRoot())) { ++n; (void)p; }
+        state->num_prims = n;
+    }
+    m_open_state = state;
     rebuildSchemaTree();
+    m_open_state = nullptr;
+    if (cancelled()) {
+        initialize();
+        set_stage(OpenStage::Cancelled);
+        return false;
+    }
+
+    // track resyncs (variant switch, payload load/unload, etc) for incremental rebuild
+    m_notice_key = TfNotice::Register(TfCreateWeakPtr(this), &Context::onObjectsChanged, UsdStageWeakPtr(m_stage));
+    set_stage(OpenStage::Completed);
     return true;
 }
 
@@ -145,6 +254,7 @@ bool Context::save() const
         usdiLogError("Context::save(): m_stage is null\n");
         return false;
     }
+    flushPendingWrites();
 
     usdiLogInfo( "Context::save():\n");
     return m_stage->GetRootLayer()->Save();
@@ -156,6 +266,7 @@ bool Context::saveAs(const char *path) const
         usdiLogError("Context::saveAs(): m_stage is null\n");
         return false;
     }
+    flushPendingWrites();
 
     {
         // UsdStage::Export() fail if dst file is not exist. workaround for it 
@@ -169,6 +280,57 @@ bool Context::saveAs(const char *path) const
     return m_stage->Export(path);
 }
 
+void Context::flushPendingWrites() const
+{
+    if (m_recorder) {
+        // write pending recorded samples
+        m_recorder->flush();
+    }
+    if (m_clip_writer) {
+        // clips are referred by paths relative to the root layer. saveAs() doesn't copy them.
+        m_clip_writer->flush();
+    }
+    if (m_partition_writer) {
+        // UsdStage::Export() flattens the layer stack. saveAs() merges partitions into the output.
+        m_partition_writer->flush();
+    }
+}
+
+SdfLayerRefPtr Context::takeSnapshot()
+{
+    if (!m_stage) {
+        usdiLogError("Context::takeSnapshot(): m_stage is null\n");
+        return SdfLayerRefPtr();
+    }
+    flushPendingWrites();
+
+    auto root = m_stage->GetRootLayer();
+    SdfLayerRefPtr ret;
+    if (!root->IsAnonymous()) {
+        static std::atomic_int s_seed = { 0 };
+        std::string dir, basename, ext;
+        SplitLayerPath(root, dir, basename, ext);
+        char suffix[64];
+        sprintf(suffix, ".snapshot%d.usda", s_seed++);
+        ret = SdfLayer::New(SdfFileFormat::FindByExtension("usda"), dir + basename + suffix);
+    }
+    if (!ret) {
+        ret = SdfLayer::CreateAnonymous();
+    }
+    // values are VtValue copies. arrays share their buffers with the root layer (copy on write), so this is cheap
+    // compared to serialization.
+    ret->TransferContent(root);
+    return ret;
+}
+
+AsyncSaveQueue* Context::getAsyncSaveQueue()
+{
+    if (!m_async_save_queue) {
+        m_async_save_queue.reset(new AsyncSaveQueue());
+    }
+    return m_async_save_queue.get();
+}
+
 const ImportSettings& Context::getImportSettings() const
 {
     return m_import_settings;
@@ -215,15 +377,98 @@ Schema* Context::getMaster(int i) const
     return m_masters[i];
 }
 
-Schema* Context::findSchema(const char *path) const
+int Context::getNumSchemas() const
+{
+    return (int)m_schemas.size();
+}
+
+Schema* Context::getSchema(int i) const
+{
+    return m_schemas[i].get();
+}
+
+int Context::getTreeRevision() const
+{
+    return m_tree_revision;
+}
+
+Schema* Context::findSchema(const char *path)
+{
+    if (!path) { return nullptr; }
+
+    if (m_lazy_schema_tree) {
+        SdfPath spath(path);
+        if (spath.IsEmpty()) { return nullptr; }
+        return findSchemaInTree(spath);
+    }
+
+    std::unique_lock<tbb::spin_mutex> lock(m_schemas_mutex);
+    return m_schema_index->find(path);
+}
+
+int Context::findSchemas(const char **paths, int num_paths, Schema **dst)
+{
+    if (!paths || !dst) { return 0; }
+
+    int found = 0;
+    for (int i = 0; i < num_paths; ++i) {
+        dst[i] = findSchema(paths[i]);
+        if (dst[i]) { ++found; }
+    }
+    return found;
+}
+
+int Context::findSchemasInSubtree(const char *path, std::vector<Schema*>& dst)
 {
-    // obviously this is very slow. I need to improve this if this method is called very often.
-    for (auto& n : m_schemas) {
-        if (strcmp(n->getPath(), path) == 0) {
-            return n.get();
+    if (!path) { return 0; }
+    std::unique_lock<tbb::spin_mutex> lock(m_schemas_mutex);
+    return m_schema_index->findSubtree(path, dst);
+}
+
+int Context::findSchemasByPattern(const char *pattern, std::vector<Schema*>& dst)
+{
+    if (!pattern) { return 0; }
+    std::unique_lock<tbb::spin_mutex> lock(m_schemas_mutex);
+    return m_schema_index->findByPattern(pattern, dst);
+}
+
+Schema* Context::findSchemaInTree(const SdfPath& path)
+{
+    {
+        std::unique_lock<tbb::spin_mutex> lock(m_schemas_mutex);
+        if (auto *s = m_schema_index->find(path.GetString())) {
+            return s;
         }
     }
-    return nullptr;
+    if (!m_lazy_schema_tree) { return nullptr; }
+
+    // walk down from the root (or master) and materialize schemas on the path
+    auto prefixes = path.GetPrefixes();
+
+    Schema *s = m_root;
+    size_t start = 0;
+    if (!prefixes.empty()) {
+        for (auto *m : m_masters) {
+            if (m->m_path == prefixes.front().GetString()) {
+                s = m;
+                start = 1;
+                break;
+            }
+        }
+    }
+    for (size_t i = start; s && i < prefixes.size(); ++i) {
+        populateChildren(s);
+        const auto& name = prefixes[i].GetString();
+        Schema *next = nullptr;
+        for (auto *c : s->m_children) {
+            if (c->m_path == name) {
+                next = c;
+                break;
+            }
+        }
+        s = next;
+    }
+    return s;
 }
 
 
@@ -235,7 +480,59 @@ void Context::addSchema(Schema *schema)
     }
     usdiLogTrace("Context::addSchema(): %s\n", schema->getName());
     schema->setup();
-    m_schemas.emplace_back(schema);
+    {
+        std::unique_lock<tbb::spin_mutex> lock(m_schemas_mutex);
+        m_schemas.emplace_back(schema);
+        m_schema_index->add(schema);
+        ++m_tree_revision;
+    }
+    if (m_open_state) {
+        ++m_open_state->num_schemas;
+    }
+}
+
+void Context::destroySchema(Schema *schema)
+{
+    // collect schema and its descendants. parents always come before their children.
+    std::vector<Schema*> targets;
+    targets.push_back(schema);
+    schema->eachChildR([&](Schema *c) { targets.push_back(c); });
+
+    if (auto *parent = schema->getParent()) {
+        parent->removeChild(schema);
+    }
+    for (auto *t : targets) {
+        if (auto *master = t->getMaster()) {
+            master->removeInstance(t);
+        }
+    }
+
+    std::sort(targets.begin(), targets.end());
+    auto is_target = [&](const SchemaPtr& s) {
+        return std::binary_search(targets.begin(), targets.end(), s.get());
+    };
+
+    // take targets out of the list under the lock (addSchema() / findSchema() can run on other threads).
+    // schemas are deleted after the lock is released.
+    std::vector<SchemaPtr> removed;
+    {
+        std::unique_lock<tbb::spin_mutex> lock(m_schemas_mutex);
+        for (auto *t : targets) {
+            m_schema_index->remove(t);
+        }
+        for (auto& s : m_schemas) {
+            if (is_target(s)) { removed.emplace_back(std::move(s)); }
+        }
+        m_schemas.erase(
+            std::remove_if(m_schemas.begin(), m_schemas.end(), [](const SchemaPtr& s) { return !s; }),
+            m_schemas.end());
+        ++m_tree_revision;
+    }
+
+    // delete USD objects in reverse order
+    for (auto i = removed.rbegin(); i != removed.rend(); ++i) {
+        i->reset();
+    }
 }
 
 Schema* Context::createSchema(Schema *parent, const UsdPrim& prim)
@@ -250,28 +547,62 @@ Schema* Context::createSchema(Schema *parent, const UsdPrim& prim)
 Schema* Context::createSchemaRecursive(Schema *parent, UsdPrim prim)
 {
     if (!prim.IsValid()) { return nullptr; }
+    if (m_open_state && m_open_state->cancel) { return nullptr; }
 
     auto *ret = createSchema(parent, prim);
 
-    // handling payload
-    if (m_import_settings.load_all_payloads && prim.HasPayload()) {
+    // handling payload. if the streamer is active, it owns load state of payloads.
+    // payloads can't be loaded while building in parallel. rebuildSchemaTreeFull() loads them beforehand.
+    if (m_import_settings.load_all_payloads && !m_payload_streamer && !m_parallel_build && prim.HasPayload()) {
         prim.Load();
     }
 
-    // handling instance
-    if (prim.IsInstance()) {
-        auto children = prim.GetMaster().GetChildren();
+    if (ret) {
+        if (m_lazy_schema_tree) {
+            ret->m_children_populated = false;
+        }
+        else {
+            createChildSchemas(ret);
+        }
+    }
+    return ret;
+}
+
+void Context::createChildSchemas(Schema *schema)
+{
+    auto prim = schema->getUsdPrim();
+    if (schema->getMaster() || prim.IsInstance()) {
+        // handling instance
+        auto children = schema->getMaster() ? prim.GetChildren() : prim.GetMaster().GetChildren();
         for (auto c : children) {
-            createInstanceSchemaRecursive(ret, c);
+            createInstanceSchemaRecursive(schema, c);
         }
     }
     else {
         auto children = prim.GetChildren();
         for (auto c : children) {
-            createSchemaRecursive(ret, c);
+            createSchemaRecursive(schema, c);
         }
     }
-    return ret;
+    schema->m_children_populated = true;
+}
+
+void Context::populateChildren(Schema *schema)
+{
+    if (!schema || schema->m_children_populated) { return; }
+
+    std::unique_lock<std::recursive_mutex> lock(m_populate_mutex);
+    if (!schema->m_children_populated) {
+        createChildSchemas(schema);
+    }
+}
+
+Context::StageLock Context::lockSchemaTree()
+{
+    if (m_lazy_schema_tree) {
+        return StageLock(m_populate_mutex);
+    }
+    return StageLock();
 }
 
 Schema* Context::createInstanceSchema(Schema *parent, Schema *master, const std::string& path, UsdPrim prim)
@@ -283,7 +614,10 @@ Schema* Context::createInstanceSchema(Schema *parent, Schema *master, const std:
 
 Schema* Context::createInstanceSchemaRecursive(Schema *parent, UsdPrim prim)
 {
-    Schema *master = findSchema(prim.GetPath().GetText());
+    if (m_open_state && m_open_state->cancel) { return nullptr; }
+
+    // masters are built before instances
+    Schema *master = findSchemaInTree(prim.GetPath());
 
     std::string path = parent ? parent->getPath() : "/";
     if (path.back() != '/') {
@@ -292,9 +626,11 @@ Schema* Context::createInstanceSchemaRecursive(Schema *parent, UsdPrim prim)
     path += prim.GetName();
 
     auto *ret = createInstanceSchema(parent, master, path, prim);
-    auto children = prim.GetChildren();
-    for (auto c : children) {
-        createInstanceSchemaRecursive(ret, c);
+    if (m_lazy_schema_tree) {
+        ret->m_children_populated = false;
+    }
+    else {
+        createChildSchemas(ret);
     }
     return ret;
 }
@@ -339,25 +675,344 @@ void Context::endEdit()
     m_stage->SetEditTarget(m_edit_target);
 }
 
+void Context::beginWriteFrame()
+{
+    if (!m_stage) {
+        usdiLogError("Context::beginWriteFrame(): m_stage is null\n");
+        return;
+    }
+    auto layer = getIdentityEditLayer();
+
+    tbb::spin_mutex::scoped_lock lock(m_write_frame_mutex);
+    auto& wf = m_write_frames[std::this_thread::get_id()];
+    if (wf.depth++ > 0) { return; }
+
+    wf.change_block.reset(new SdfChangeBlock());
+    wf.layer = layer;
+}
+
+void Context::endWriteFrame()
+{
+    WriteFrame wf;
+    {
+        tbb::spin_mutex::scoped_lock lock(m_write_frame_mutex);
+        auto it = m_write_frames.find(std::this_thread::get_id());
+        if (it == m_write_frames.end()) {
+            usdiLogWarning("Context::endWriteFrame(): not in write frame\n");
+            return;
+        }
+        if (--it->second.depth > 0) { return; }
+
+        wf = std::move(it->second);
+        m_write_frames.erase(it);
+    }
+    // change processing happens here (outside the lock)
+    wf.change_block.reset();
+}
+
+bool Context::isInWriteFrame() const
+{
+    tbb::spin_mutex::scoped_lock lock(m_write_frame_mutex);
+    return m_write_frames.find(std::this_thread::get_id()) != m_write_frames.end();
+}
+
+SdfLayerHandle Context::getWriteLayer() const
+{
+    tbb::spin_mutex::scoped_lock lock(m_write_frame_mutex);
+    auto it = m_write_frames.find(std::this_thread::get_id());
+    return it != m_write_frames.end() ? it->second.layer : SdfLayerHandle();
+}
+
+SdfLayerHandle Context::getIdentityEditLayer() const
+{
+    if (!m_stage) { return SdfLayerHandle(); }
+
+    // direct access to the layer needs stage paths & times to be the same as the layer's
+    const auto& target = m_stage->GetEditTarget();
+    if (target.IsValid() && target.GetMapFunction().IsIdentity()) {
+        return target.GetLayer();
+    }
+    return SdfLayerHandle();
+}
+
+bool Context::setSample(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t)
+{
+    // clips are already split by time. deduplication needs previous samples that may be in released clips.
+    // partitions are written concurrently. the deduplicator is not thread safe.
+    if (m_export_settings.deduplicate_samples && !m_clip_writer && !m_partition_writer &&
+        !t.IsDefault() && getIdentityEditLayer())
+    {
+        return m_sample_dedup->write(attr, v, t.GetValue());
+    }
+    return authorSample(attr, v, t);
+}
+
+bool Context::queryAuthoredSample(const UsdAttribute& attr, UsdTimeCode t, VtValue& dst)
+{
+    auto layer = getIdentityEditLayer();
+    if (!layer) { return false; }
+
+    const auto& path = attr.GetPath();
+    if (t.IsDefault()) {
+        auto spec = layer->GetAttributeAtPath(path);
+        if (!spec) { return false; }
+        dst = spec->GetDefaultValue();
+        return !dst.IsEmpty();
+    }
+    return layer->QueryTimeSample(SdfAbstractDataSpecId(&path), t.GetValue(), &dst);
+}
+
+void Context::getExportStats(ExportStats& dst) const
+{
+    m_sample_dedup->getStats(dst);
+}
+
+bool Context::authorSample(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t)
+{
+    if (m_partition_writer) {
+        return m_partition_writer->write(attr, v, t);
+    }
+    if (m_clip_writer && !t.IsDefault()) {
+        return m_clip_writer->write(attr, v, t.GetValue());
+    }
+    if (auto layer = getWriteLayer()) {
+        const auto& path = attr.GetPath();
+        auto spec = layer->GetAttributeAtPath(path);
+        // writing to the layer bypasses type checks of UsdAttribute::Set(). values of other types take the slow path.
+        if (spec && v.GetType() == spec->GetTypeName().GetType()) {
+            if (t.IsDefault()) {
+                return spec->SetDefaultValue(v);
+            }
+            layer->SetTimeSample(SdfAbstractDataSpecId(&path), t.GetValue(), v);
+            return true;
+        }
+        // no spec yet (or type mismatch). UsdAttribute::Set() creates it (or rejects the value) and following writes go to the layer.
+    }
+    return attr.Set(v, t);
+}
+
+bool Context::beginClipExport(const ClipExportSettings& settings)
+{
+    if (!m_stage) {
+        usdiLogError("Context::beginClipExport(): m_stage is null\n");
+        return false;
+    }
+    if (m_clip_writer || m_partition_writer) {
+        usdiLogWarning("Context::beginClipExport(): already exporting clips or in parallel\n");
+        return false;
+    }
+    if ((!settings.directory || !settings.directory[0]) && m_stage->GetRootLayer()->IsAnonymous()) {
+        usdiLogError("Context::beginClipExport(): the root layer is anonymous. ClipExportSettings::directory is required\n");
+        return false;
+    }
+    if (m_recorder) {
+        // samples recorded before this call go to the root layer
+        m_recorder->flush();
+    }
+
+    m_clip_writer.reset(new ClipWriter(this, settings));
+    return true;
+}
+
+bool Context::endClipExport()
+{
+    if (!m_clip_writer) { return false; }
+    if (m_recorder) {
+        m_recorder->flush();
+    }
+
+    bool ret = m_clip_writer->flush();
+    m_clip_writer.reset();
+    return ret;
+}
+
+bool Context::isExportingClips() const
+{
+    return m_clip_writer != nullptr;
+}
+
+bool Context::beginParallelExport(const ParallelExportSettings& settings)
+{
+    if (!m_stage) {
+        usdiLogError("Context::beginParallelExport(): m_stage is null\n");
+        return false;
+    }
+    if (m_clip_writer || m_partition_writer) {
+        usdiLogWarning("Context::beginParallelExport(): already exporting clips or in parallel\n");
+        return false;
+    }
+    if (m_stage->GetRootLayer()->IsAnonymous()) {
+        // partitions are written next to the root layer
+        usdiLogError("Context::beginParallelExport(): the root layer is anonymous\n");
+        return false;
+    }
+    if (m_recorder) {
+        m_recorder->flush();
+    }
+
+    m_partition_writer.reset(new PartitionWriter(this, settings));
+    return true;
+}
+
+bool Context::endParallelExport()
+{
+    if (!m_partition_writer) { return false; }
+    if (m_recorder) {
+        m_recorder->flush();
+    }
+
+    bool ret = m_partition_writer->flush();
+    m_partition_writer.reset();
+    return ret;
+}
+
+bool Context::isExportingInParallel() const
+{
+    return m_partition_writer != nullptr;
+}
+
+Context::StageLock Context::lockStage()
+{
+    if (m_partition_writer) {
+        return StageLock(m_stage_mutex);
+    }
+    return StageLock();
+}
+
 void Context::rebuildSchemaTree()
 {
+    if (!m_stage) {
+        usdiLogError("Context::rebuildSchemaTree(): m_stage is null\n");
+        return;
+    }
+
+    SdfPathVector resynced;
+    {
+        std::unique_lock<tbb::spin_mutex> lock(m_notice_mutex);
+        resynced.swap(m_resynced_paths);
+    }
+
+    bool full = m_root == nullptr;
+    if (!full) {
+        // only outermost paths need to be rebuilt
+        std::sort(resynced.begin(), resynced.end());
+        resynced.erase(std::unique(resynced.begin(), resynced.end()), resynced.end());
+        SdfPathVector roots;
+        for (auto& path : resynced) {
+            bool covered = std::any_of(roots.begin(), roots.end(),
+                [&](const SdfPath& r) { return path.HasPrefix(r); });
+            if (!covered) { roots.push_back(path); }
+        }
+
+        for (auto& path : roots) {
+            if (!rebuildSchemaSubtree(path)) {
+                full = true;
+                break;
+            }
+        }
+        usdiLogTrace("Context::rebuildSchemaTree(): %d subtree(s) rebuilt\n", (int)roots.size());
+    }
+
+    if (full) {
+        rebuildSchemaTreeFull();
+    }
+
+    // payloads loaded while traversing the stage resync their own paths. they are already reflected in the tree.
+    std::unique_lock<tbb::spin_mutex> lock(m_notice_mutex);
+    m_resynced_paths.clear();
+}
+
+void Context::rebuildSchemaTreeFull()
+{
+    // delete USD objects in reverse order
+    for (auto i = m_schemas.rbegin(); i != m_schemas.rend(); ++i) { i->reset(); }
     m_masters.clear();
     m_schemas.clear();
+    m_schema_index->clear();
     m_root = nullptr;
     m_id_seed = 0;
 
+    if (m_import_settings.load_all_payloads && !m_payload_streamer) {
+        m_stage->Load(SdfPath::AbsoluteRootPath());
+    }
+
     {
         auto masters = m_stage->GetMasters();
         for (auto& m : masters) {
             m_masters.push_back(createSchemaRecursive(nullptr, m));
         }
     }
-    {
-        auto root_prim = m_stage->GetPseudoRoot();
-        if (root_prim.IsValid()) {
-            m_root = createSchemaRecursive(nullptr, root_prim);
+
+    auto root_prim = m_stage->GetPseudoRoot();
+    if (!root_prim.IsValid()) { return; }
+
+#ifndef usdiDbgForceSingleThread
+    if (!m_lazy_schema_tree) {
+        // create top level schemas serially, then build their subtrees in parallel.
+        // reading composed prims from multiple threads is safe as long as the stage is not modified.
+        m_root = createSchema(nullptr, root_prim);
+        if (!m_root) { return; }
+        for (auto c : root_prim.GetChildren()) {
+            createSchema(m_root, c);
         }
+
+        m_parallel_build = true;
+        auto& top = m_root->m_children;
+        tbb::parallel_for(size_t(0), top.size(), [&](size_t i) {
+            createChildSchemas(top[i]);
+        });
+        m_parallel_build = false;
+        return;
     }
+#endif
+    m_root = createSchemaRecursive(nullptr, root_prim);
+}
+
+bool Context::rebuildSchemaSubtree(const SdfPath& path)
+{
+    if (path.IsAbsoluteRootPath()) { return false; }
+
+    // masters are shared by instances. changes in them (or in instances) require full rebuild.
+    auto prefixes = path.GetPrefixes();
+    if (!prefixes.empty() && TfStringStartsWith(prefixes.front().GetName(), "__Master_")) {
+        return false;
+    }
+
+    Schema *parent = nullptr;
+    size_t index = 0;
+    if (auto *old = findSchema(path.GetText())) {
+        if (old->getMaster() || !old->getParent()) { return false; }
+
+        parent = old->getParent();
+        auto& siblings = parent->m_children;
+        index = std::distance(siblings.begin(), std::find(siblings.begin(), siblings.end(), old));
+        destroySchema(old);
+    }
+    else {
+        // newly added prim
+        parent = findSchema(path.GetParentPath().GetText());
+        if (!parent) {
+            // parent is not in the tree. nothing to do. (e.g. inactive ancestor)
+            return true;
+        }
+        if (parent->getMaster()) { return false; }
+        index = parent->m_children.size();
+    }
+
+    auto prim = m_stage->GetPrimAtPath(path);
+    if (prim.IsValid() && prim.IsActive()) {
+        if (prim.IsInstance() && !findSchema(prim.GetMaster().GetPath().GetText())) {
+            // new master appeared
+            return false;
+        }
+        if (auto *s = createSchemaRecursive(parent, prim)) {
+            // keep original order of children
+            auto& siblings = parent->m_children;
+            siblings.pop_back();
+            siblings.insert(siblings.begin() + std::min(index, siblings.size()), s);
+        }
+    }
+    return true;
 }
 
 int Context::generateID()
@@ -372,21 +1027,73 @@ void Context::notifyForceUpdate()
     }
 }
 
+int Context::newFrame()
+{
+    return ++m_frame;
+}
+
 void Context::updateAllSamples(Time t)
 {
+    auto lock = lockSchemaTree();
+    int frame = newFrame();
+
+    // instances share samples of their masters. update non-instances first so that
+    // instances just need to take over flags of already updated masters.
 #ifdef usdiDbgForceSingleThread
     for (auto& s : m_schemas) {
-        s->updateSample(t);
+        if (!s->getMaster()) { s->updateSampleForFrame(t, frame); }
+    }
+    for (auto& s : m_schemas) {
+        if (s->getMaster()) { s->updateSampleForFrame(t, frame); }
     }
 #else
     size_t grain = std::max<size_t>(m_schemas.size() / 32, 1);
     using range_t = tbb::blocked_range<size_t>;
-    tbb::parallel_for(range_t(0, m_schemas.size(), grain), [t, this](const range_t& r) {
+    tbb::parallel_for(range_t(0, m_schemas.size(), grain), [t, frame, this](const range_t& r) {
         for (size_t i = r.begin(); i != r.end(); ++i) {
-            m_schemas[i]->updateSample(t);
+            auto& s = m_schemas[i];
+            if (!s->getMaster()) { s->updateSampleForFrame(t, frame); }
+        }
+    });
+    tbb::parallel_for(range_t(0, m_schemas.size(), grain), [t, frame, this](const range_t& r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            auto& s = m_schemas[i];
+            if (s->getMaster()) { s->updateSampleForFrame(t, frame); }
         }
     });
 #endif
 }
 
+PayloadStreamer* Context::getPayloadStreamer()
+{
+    if (!m_payload_streamer) {
+        m_payload_streamer.reset(new PayloadStreamer(this));
+    }
+    return m_payload_streamer.get();
+}
+
+UpdateScheduler* Context::getUpdateScheduler()
+{
+    if (!m_update_scheduler) {
+        m_update_scheduler.reset(new UpdateScheduler(this));
+    }
+    return m_update_scheduler.get();
+}
+
+Recorder* Context::getRecorder()
+{
+    if (!m_recorder) {
+        m_recorder.reset(new Recorder(this));
+    }
+    return m_recorder.get();
+}
+
+void Context::onObjectsChanged(const UsdNotice::ObjectsChanged& n, const UsdStageWeakPtr& /*sender*/)
+{
+    std::unique_lock<tbb::spin_mutex> lock(m_notice_mutex);
+    for (const auto& path : n.GetResyncedPaths()) {
+        m_resynced_paths.push_back(path.GetPrimPath());
+    }
+}
+
 } // namespace usdi
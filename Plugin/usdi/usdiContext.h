@@ -2,9 +2,20 @@
 
 namespace usdi {
 
-class Context
+// progress of Context::open(). shared with AsyncOpen.
+struct OpenState
+{
+    std::atomic_int     stage = { (int)OpenStage::OpeningLayer };
+    std::atomic_int     num_prims = { 0 };
+    std::atomic_int     num_schemas = { 0 };
+    std::atomic_bool    cancel = { false };
+};
+
+class Context : public TfWeakBase
 {
 public:
+    using StageLock = std::unique_lock<std::recursive_mutex>;
+
     Context();
     virtual ~Context();
 
@@ -12,9 +23,17 @@ public:
     void                initialize();
     bool                createStage(const char *identifier);
     bool                open(const char *path);
+    bool                open(const char *path, const OpenSettings& settings);
+    // state can be null. if state->cancel is set while opening, open() stops and returns false.
+    bool                open(const char *path, const OpenSettings& settings, OpenState *state);
     bool                save() const;
     // path must *not* be same as identifier (parameter of createStage() or open())
     bool                saveAs(const char *path) const;
+    // copy of the root layer. pending writes are flushed before that.
+    // it is placed next to the root layer (not saved there), so relative asset paths in it resolve the same.
+    SdfLayerRefPtr      takeSnapshot();
+    // AsyncSave writes on this to keep the order of writes
+    AsyncSaveQueue*     getAsyncSaveQueue();
 
     const ImportSettings&   getImportSettings() const;
     void                    setImportSettings(const ImportSettings& v);
@@ -25,7 +44,19 @@ public:
     Schema*             getRoot() const;
     int                 getNumMasters() const;
     Schema*             getMaster(int i) const;
-    Schema*             findSchema(const char *path) const;
+    // materializes schemas on the path if the tree is lazy
+    Schema*             findSchema(const char *path);
+    // dst must have num_paths elements. not found paths are null. return number of found schemas.
+    int                 findSchemas(const char **paths, int num_paths, Schema **dst);
+    // subtree and pattern queries see only materialized schemas if the tree is lazy. see SchemaIndex for pattern syntax.
+    // results are appended to dst in sorted path order. return number of appended schemas.
+    int                 findSchemasInSubtree(const char *path, std::vector<Schema*>& dst);
+    int                 findSchemasByPattern(const char *pattern, std::vector<Schema*>& dst);
+    // all schemas including masters and instances. parents always come before their children.
+    int                 getNumSchemas() const;
+    Schema*             getSchema(int i) const;
+    // incremented whenever schemas are added or removed
+    int                 getTreeRevision() const;
 
     // SchemaType: Xform, Camera, Mesh, etc
     template<class SchemaType>
@@ -34,38 +65,135 @@ public:
     Schema*             createSchemaRecursive(Schema *parent, UsdPrim prim);
     Schema*             createInstanceSchema(Schema *parent, Schema *master, const std::string& path, UsdPrim prim);
     Schema*             createInstanceSchemaRecursive(Schema *parent, UsdPrim prim);
+    // create child schemas of schema if not yet. used by lazy tree.
+    // waits for updates holding lockSchemaTree(). must not be called from the update itself.
+    void                populateChildren(Schema *schema);
     Schema*             createOverride(const char *prim_path);
     void                flatten();
 
     void                beginEdit(const UsdEditTarget& t);
     void                endEdit();
 
+    // writes between begin and end are merged into one SdfChangeBlock. can be nested.
+    // the state is per thread (SdfChangeBlock is per thread). must be called from the thread that writes samples.
+    void                beginWriteFrame();
+    void                endWriteFrame();
+    bool                isInWriteFrame() const;
+    // all value writes of schemas and attributes go through this.
+    // identical consecutive samples are skipped if ExportSettings::deduplicate_samples is set. see SampleDeduplicator.
+    bool                setSample(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t);
+    // author without deduplication. in a write frame, attributes that already have a spec in the edit target layer
+    // are authored to the layer directly.
+    bool                authorSample(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t);
+    // read back a value authored in the edit target layer
+    bool                queryAuthoredSample(const UsdAttribute& attr, UsdTimeCode t, VtValue& dst);
+    void                getExportStats(ExportStats& dst) const;
+
+    // time samples are written to value clip layers between begin and end. see ClipWriter.
+    bool                beginClipExport(const ClipExportSettings& settings);
+    bool                endClipExport();
+    bool                isExportingClips() const;
+    // writes are authored to per-subtree layers between begin and end, and writeSample() of schemas under different
+    // top-level prims can be called concurrently. see PartitionWriter.
+    // schemas must not be created or destroyed while writing.
+    bool                beginParallelExport(const ParallelExportSettings& settings);
+    bool                endParallelExport();
+    bool                isExportingInParallel() const;
+    // serializes access to the stage while exporting in parallel: changes (attribute and xform op creation on first
+    // write) and the reads that can race with them (attribute lookups, type names). returns an unlocked lock otherwise.
+    StageLock           lockStage();
+
+    // rebuild only subtrees that are resynced since last call (variant switch, payload load/unload, etc).
+    // falls back to full rebuild if the tree is not built yet or masters are affected.
     void                rebuildSchemaTree();
     int                 generateID();
     void                notifyForceUpdate();
+    // return frame number to pass to Schema::updateSampleForFrame()
+    int                 newFrame();
     void                updateAllSamples(Time t);
+    // held while all schemas are iterated for update, so that lazy population doesn't add schemas meanwhile.
+    // returns an unlocked lock if the schema tree is not lazy.
+    StageLock           lockSchemaTree();
+
+    // created on first call
+    PayloadStreamer*    getPayloadStreamer();
+    // created on first call
+    UpdateScheduler*    getUpdateScheduler();
+    // created on first call
+    Recorder*           getRecorder();
 
 private:
     void    addSchema(Schema *schema);
+    Schema* findSchemaInTree(const SdfPath& path);
+    void    createChildSchemas(Schema *schema);
+    void    destroySchema(Schema *schema);
     void    applyImportConfig();
+    void    rebuildSchemaTreeFull();
+    bool    rebuildSchemaSubtree(const SdfPath& path);
+    SdfLayerHandle getIdentityEditLayer() const;
+    void    flushPendingWrites() const;
+    void    onObjectsChanged(const UsdNotice::ObjectsChanged& n, const UsdStageWeakPtr& sender);
 
 private:
     using SchemaPtr = std::unique_ptr<Schema>;
     using Schemas = std::vector<SchemaPtr>;
     using Masters = std::vector<Schema*>;
+    using PayloadStreamerPtr = std::unique_ptr<PayloadStreamer>;
+    using UpdateSchedulerPtr = std::unique_ptr<UpdateScheduler>;
+    using RecorderPtr = std::unique_ptr<Recorder>;
+    using SchemaIndexPtr = std::unique_ptr<SchemaIndex>;
+    using SampleDeduplicatorPtr = std::unique_ptr<SampleDeduplicator>;
+    using ClipWriterPtr = std::unique_ptr<ClipWriter>;
+    using AsyncSaveQueuePtr = std::unique_ptr<AsyncSaveQueue>;
+    using PartitionWriterPtr = std::unique_ptr<PartitionWriter>;
 
     UsdStageRefPtr  m_stage;
     Schemas         m_schemas;
+    tbb::spin_mutex m_schemas_mutex;
+    SchemaIndexPtr  m_schema_index;
+    SampleDeduplicatorPtr m_sample_dedup;
     Schema*         m_root = nullptr;
     Masters         m_masters;
 
     ImportSettings  m_import_settings;
     ExportSettings  m_export_settings;
 
-    int             m_id_seed = 0;
+    bool            m_lazy_schema_tree = false;
+    std::recursive_mutex m_populate_mutex;
+
+    OpenState       *m_open_state = nullptr;
+    bool            m_parallel_build = false;
+
+    std::atomic_int m_id_seed = { 0 };
+    int             m_frame = 0;
+    int             m_tree_revision = 0;
     double          m_start_time = 0.0;
     double          m_end_time = 0.0;
     UsdEditTarget   m_edit_target;
+
+    struct WriteFrame
+    {
+        int depth = 0;
+        std::unique_ptr<SdfChangeBlock> change_block;
+        SdfLayerHandle layer; // null if direct authoring is not possible
+    };
+    using WriteFrames = std::map<std::thread::id, WriteFrame>;
+    SdfLayerHandle  getWriteLayer() const;
+
+    WriteFrames     m_write_frames;
+    mutable tbb::spin_mutex m_write_frame_mutex;
+
+    TfNotice::Key   m_notice_key;
+    SdfPathVector   m_resynced_paths;
+    tbb::spin_mutex m_notice_mutex;
+
+    PayloadStreamerPtr m_payload_streamer;
+    UpdateSchedulerPtr m_update_scheduler;
+    RecorderPtr     m_recorder;
+    ClipWriterPtr   m_clip_writer;
+    PartitionWriterPtr m_partition_writer;
+    std::recursive_mutex m_stage_mutex;
+    AsyncSaveQueuePtr m_async_save_queue;
 };
 
 } // namespace usdi
@@ -412,7 +412,7 @@ void Mesh::updateSample(Time t_)
 
 bool Mesh::readSample(MeshData& dst, Time t, bool copy)
 {
-    if (t != m_time_prev) { updateSample(t); }
+    updateSampleIfNeeded(t);
 
     if (!m_front_sample) { return false; }
 
@@ -473,6 +473,7 @@ bool Mesh::readSample(MeshData& dst, Time t, bool copy)
                 const auto& ssrc = splits[i];
                 auto& sdst = dst.submeshes[i];
                 sdst.num_points = (uint)ssrc.points.size();
+                sdst.max_bone_weights = dst.max_bone_weights;
                 sdst.center = ssrc.center;
                 sdst.extents = ssrc.extents;
 
@@ -524,6 +525,7 @@ bool Mesh::readSample(MeshData& dst, Time t, bool copy)
                 const auto& ssrc = splits[i];
                 auto& sdst = dst.submeshes[i];
                 sdst.num_points = (uint)ssrc.points.size();
+                sdst.max_bone_weights = dst.max_bone_weights;
                 if (sdst.indices && !ssrc.indices.empty()) {
                     sdst.indices = (int*)ssrc.indices.cdata();
                 }
@@ -552,35 +554,40 @@ bool Mesh::writeSample(const MeshData& src, Time t_)
 
 #define CreateAttributeIfNeeded(VName, ...) if(!VName) { VName=createAttribute(__VA_ARGS__); }
 
+    // swap_handedness and scale are applied while copying
+    float x = conf.swap_handedness ? -1.0f : 1.0f;
+    float3 position_scale = { x * conf.scale, conf.scale, conf.scale };
+    float3 direction_scale = { x, 1.0f, 1.0f };
+    float4 tangent_scale = { x, 1.0f, 1.0f, 1.0f };
+
+    // looking up attributes reads the stage. in parallel export other threads may be adding attributes to it.
+    UsdAttribute attr_points, attr_velocities, attr_normals, attr_counts, attr_indices;
+    {
+        auto lock = m_ctx->lockStage();
+        attr_points = m_mesh.GetPointsAttr();
+        attr_velocities = m_mesh.GetVelocitiesAttr();
+        attr_normals = m_mesh.GetNormalsAttr();
+        attr_counts = m_mesh.GetFaceVertexCountsAttr();
+        attr_indices = m_mesh.GetFaceVertexIndicesAttr();
+    }
+
     bool  ret = false;
     if (src.points) {
-        sample.points.assign((GfVec3f*)src.points, (GfVec3f*)src.points + src.num_points);
-        if (conf.swap_handedness) {
-            InvertX((float3*)sample.points.data(), sample.points.size());
-        }
-        if (conf.scale != 1.0f) {
-            Scale((float3*)sample.points.data(), conf.scale, sample.points.size());
-        }
-        ret = m_mesh.GetPointsAttr().Set(sample.points, t);
+        sample.points.resize(src.num_points);
+        MulCopy((float3*)sample.points.data(), src.points, position_scale, src.num_points);
+        ret = setSample(attr_points, VtValue(sample.points), t);
     }
 
     if (src.velocities) {
-        sample.points.assign((GfVec3f*)src.velocities, (GfVec3f*)src.velocities + src.num_points);
-        if (conf.swap_handedness) {
-            InvertX((float3*)sample.velocities.data(), sample.velocities.size());
-        }
-        if (conf.scale != 1.0f) {
-            Scale((float3*)sample.velocities.data(), conf.scale, sample.velocities.size());
-        }
-        m_mesh.GetVelocitiesAttr().Set(sample.velocities, t);
+        sample.velocities.resize(src.num_points);
+        MulCopy((float3*)sample.velocities.data(), src.velocities, position_scale, src.num_points);
+        setSample(attr_velocities, VtValue(sample.velocities), t);
     }
 
     if (src.normals) {
-        sample.normals.assign((GfVec3f*)src.normals, (GfVec3f*)src.normals + src.num_points);
-        if (conf.swap_handedness) {
-            InvertX((float3*)sample.normals.data(), sample.normals.size());
-        }
-        m_mesh.GetNormalsAttr().Set(sample.normals, t);
+        sample.normals.resize(src.num_points);
+        MulCopy((float3*)sample.normals.data(), src.normals, direction_scale, src.num_points);
+        setSample(attr_normals, VtValue(sample.normals), t);
     }
 
     if (src.indices) {
@@ -594,25 +601,14 @@ bool Mesh::writeSample(const MeshData& src, Time t_)
         }
 
         if (conf.swap_faces) {
-            auto copy_with_swap = [](VtArray<int>& dst_indices, const int *src_indices, const VtArray<int>& counts) {
-                int i = 0;
-                for (int ngon : counts) {
-                    for (int ni = 0; ni < ngon; ++ni) {
-                        int ini = ngon - ni - 1;
-                        dst_indices[i + ni] = src_indices[i + ini];
-                    }
-                    i += ngon;
-                }
-            };
-
             sample.indices.resize(src.num_indices);
-            copy_with_swap(sample.indices, src.indices, sample.counts);
+            ReverseWinding(sample.indices.data(), src.indices, sample.counts.cdata(), sample.counts.size());
         }
         else {
             sample.indices.assign(src.indices, src.indices + src.num_indices);
         }
-        m_mesh.GetFaceVertexCountsAttr().Set(sample.counts, t);
-        m_mesh.GetFaceVertexIndicesAttr().Set(sample.indices, t);
+        setSample(attr_counts, VtValue(sample.counts), t);
+        setSample(attr_indices, VtValue(sample.indices), t);
     }
 
     if (src.uvs) {
@@ -623,10 +619,8 @@ bool Mesh::writeSample(const MeshData& src, Time t_)
     }
 
     if (src.tangents) {
-        sample.tangents.assign((GfVec4f*)src.tangents, (GfVec4f*)src.tangents + src.num_points);
-        if (conf.swap_handedness) {
-            InvertX((float4*)sample.tangents.data(), sample.tangents.size());
-        }
+        sample.tangents.resize(src.num_points);
+        MulCopy((float4*)sample.tangents.data(), src.tangents, tangent_scale, src.num_points);
 
         CreateAttributeIfNeeded(m_attr_tangents, usdiTangentAttrName, AttributeType::Float4Array);
         m_attr_tangents->setImmediate(&sample.tangents, t_);
@@ -635,17 +629,13 @@ bool Mesh::writeSample(const MeshData& src, Time t_)
 
     // bone & weight attributes
 
-    if (src.weights4 && src.max_bone_weights == 4) {
-        sample.max_bone_weights = src.max_bone_weights;
-        sample.bone_weights.resize(src.num_points * 4);
-        sample.bone_indices.resize(src.num_points * 4);
-        for (uint pi = 0; pi < src.num_points; ++pi) {
-            int pi4 = pi * 4;
-            for (int i = 0; i < 4; ++i) {
-                sample.bone_weights[pi4 + i] = src.weights4[pi].weight[i];
-                sample.bone_indices[pi4 + i] = src.weights4[pi].indices[i];
-            }
-        }
+    if (src.weights4 && (src.max_bone_weights == 4 || src.max_bone_weights == 8)) {
+        // weights4 and weights8 share the pointer
+        int nweights = src.max_bone_weights;
+        sample.max_bone_weights = nweights;
+        sample.bone_weights.resize(src.num_points * nweights);
+        sample.bone_indices.resize(src.num_points * nweights);
+        UnpackWeights(sample.bone_weights.data(), sample.bone_indices.data(), src.weights4, src.num_points, nweights);
 
         CreateAttributeIfNeeded(m_attr_bone_weights, usdiBoneWeightsAttrName, AttributeType::FloatArray);
         CreateAttributeIfNeeded(m_attr_bone_indices, usdiBoneIndicesAttrName, AttributeType::IntArray);
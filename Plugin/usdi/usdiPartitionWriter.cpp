@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiContext.h"
+#include "usdiPartitionWriter.h"
+#include "usdiUtils.h"
+
+namespace usdi {
+
+PartitionWriter::PartitionWriter(Context *ctx, const ParallelExportSettings& settings)
+    : m_ctx(ctx)
+    , m_settings(settings)
+{
+    m_settings.num_partitions = std::max<int>(m_settings.num_partitions, 1);
+
+    SplitLayerPath(m_ctx->getUsdStage()->GetRootLayer(), m_dir, m_basename, m_ext);
+    if (m_ext.empty()) {
+        m_ext = ".usdc";
+    }
+
+    char suffix[64];
+    for (int i = 0; i < m_settings.num_partitions; ++i) {
+        sprintf(suffix, ".part%d", i);
+        PartitionPtr p(new Partition());
+        p->layer = SdfLayer::CreateAnonymous();
+        p->asset_path = "./" + m_basename + suffix + m_ext;
+        m_partitions.push_back(std::move(p));
+    }
+    usdiLogTrace("PartitionWriter::PartitionWriter()\n");
+}
+
+PartitionWriter::~PartitionWriter()
+{
+    usdiLogTrace("PartitionWriter::~PartitionWriter()\n");
+}
+
+const ParallelExportSettings& PartitionWriter::getSettings() const
+{
+    return m_settings;
+}
+
+PartitionWriter::Partition* PartitionWriter::getPartition(const SdfPath& path)
+{
+    // top-level prim
+    SdfPath key = path;
+    while (key.GetPathElementCount() > 1) {
+        key = key.GetParentPath();
+    }
+
+    // SdfPath::Hash depends on addresses. hash the name to get the same partition in every run.
+    const auto& name = key.GetName();
+    auto i = Hash64(name.data(), name.size()) % (uint64_t)m_partitions.size();
+    return m_partitions[i].get();
+}
+
+bool PartitionWriter::write(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t)
+{
+    const auto& path = attr.GetPath();
+    auto *p = getPartition(path);
+
+    std::unique_lock<std::mutex> lock(p->mutex);
+    auto spec = p->layer->GetAttributeAtPath(path);
+    if (!spec) {
+        // reading the type name touches the stage
+        auto stage_lock = m_ctx->lockStage();
+        auto prim = SdfCreatePrimInLayer(p->layer, path.GetPrimPath());
+        if (prim) {
+            spec = SdfAttributeSpec::New(prim, path.GetName(), attr.GetTypeName());
+        }
+        if (!spec) {
+            usdiLogError("PartitionWriter::write(): failed to create spec %s\n", path.GetText());
+            return false;
+        }
+        p->used = true;
+    }
+
+    if (t.IsDefault()) {
+        return spec->SetDefaultValue(v);
+    }
+    p->layer->SetTimeSample(SdfAbstractDataSpecId(&path), t.GetValue(), v);
+    return true;
+}
+
+bool PartitionWriter::flush()
+{
+    bool ret = true;
+    std::set<std::string> ours;
+    std::vector<std::string> written;
+    for (auto& p : m_partitions) {
+        ours.insert(p->asset_path);
+        if (!p->used) { continue; }
+
+        auto path = m_dir + p->asset_path.substr(2); // strip "./"
+        if (!p->layer->Export(path)) {
+            usdiLogError("PartitionWriter::flush(): failed to write %s\n", path.c_str());
+            ret = false;
+            continue;
+        }
+        written.push_back(p->asset_path);
+    }
+
+    // keep sublayers not added by us in front, then partitions in index order
+    auto root = m_ctx->getUsdStage()->GetRootLayer();
+    std::vector<std::string> sublayers;
+    for (const auto& s : root->GetSubLayerPaths()) {
+        std::string path = s;
+        if (ours.find(path) == ours.end()) {
+            sublayers.push_back(path);
+        }
+    }
+    sublayers.insert(sublayers.end(), written.begin(), written.end());
+    root->SetSubLayerPaths(sublayers);
+    return ret;
+}
+
+} // namespace usdi
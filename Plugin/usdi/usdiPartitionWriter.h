@@ -0,0 +1,47 @@
+#pragma once
+
+namespace usdi {
+
+// parallel export. owned by Context between beginParallelExport() and endParallelExport(), and used by
+// Context::authorSample() for all writes.
+// top-level prims are distributed to num_partitions anonymous layers by hash of their names. the layers are not attached
+// to the stage while recording, so writeSample() of schemas in different subtrees can run concurrently. flush() exports
+// them next to the root layer ("<root layer>.part0.usdc", ...) and sublayers them in index order. the result doesn't
+// depend on which thread wrote first.
+// sublayers are weaker than the root layer: opinions authored to the root layer before beginParallelExport() win.
+class PartitionWriter
+{
+public:
+    PartitionWriter(Context *ctx, const ParallelExportSettings& settings);
+    ~PartitionWriter();
+
+    // thread safe as long as each attribute is written from one thread at a time
+    bool    write(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t);
+    // export all partitions and update sublayers of the root layer. must not be called while writing.
+    bool    flush();
+    const ParallelExportSettings& getSettings() const;
+
+private:
+    struct Partition
+    {
+        std::mutex      mutex;
+        SdfLayerRefPtr  layer;
+        std::string     asset_path; // relative to the root layer
+        bool            used = false;
+    };
+    using PartitionPtr = std::unique_ptr<Partition>;
+    // index decides sublayer order
+    using Partitions = std::vector<PartitionPtr>;
+
+    Partition*  getPartition(const SdfPath& path);
+
+private:
+    Context                 *m_ctx = nullptr;
+    ParallelExportSettings  m_settings;
+    std::string             m_dir;
+    std::string             m_basename;
+    std::string             m_ext;
+    Partitions              m_partitions; // fixed on construction. no lock is needed to find a partition
+};
+
+} // namespace usdi
@@ -0,0 +1,528 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiSchema.h"
+#include "usdiContext.h"
+#include "usdiPayloadStreamer.h"
+
+namespace usdi {
+
+static std::string GetPayloadAssetPath(const UsdPrim& prim)
+{
+    for (auto& spec : prim.GetPrimStack()) {
+        if (spec->HasPayload()) {
+            auto payload = spec->GetPayload();
+            if (payload.GetAssetPath().empty()) {
+                // internal payload. nothing to prefetch.
+                return std::string();
+            }
+            return SdfComputeAssetPathRelativeToLayer(spec->GetLayer(), payload.GetAssetPath());
+        }
+    }
+    return std::string();
+}
+
+static size_t GetFileSize(const std::string& path)
+{
+    size_t ret = 0;
+    if (FILE *f = fopen(path.c_str(), "rb")) {
+        fseek(f, 0, SEEK_END);
+        ret = (size_t)ftell(f);
+        fclose(f);
+    }
+    return ret;
+}
+
+
+PayloadStreamer::PayloadStreamer(Context *ctx)
+    : m_ctx(ctx)
+{
+    m_worker = std::thread([this]() { workerMain(); });
+    usdiLogTrace("PayloadStreamer::PayloadStreamer()\n");
+}
+
+PayloadStreamer::~PayloadStreamer()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+        for (auto& job : m_queue) { job->cancelled = true; }
+    }
+    m_cond.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    usdiLogTrace("PayloadStreamer::~PayloadStreamer()\n");
+}
+
+const PayloadStreamerSettings& PayloadStreamer::getSettings() const
+{
+    return m_settings;
+}
+
+void PayloadStreamer::setSettings(const PayloadStreamerSettings& v)
+{
+    m_settings = v;
+    m_settings.max_loads_per_update = std::max<int>(m_settings.max_loads_per_update, 1);
+}
+
+void PayloadStreamer::setViewPosition(const float3& v)
+{
+    m_view_pos = v;
+}
+
+PayloadStreamer::Entry* PayloadStreamer::findOrAddEntry(const std::string& path)
+{
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+        return &it->second;
+    }
+
+    auto stage = m_ctx->getUsdStage();
+    if (!stage) { return nullptr; }
+
+    auto prim = stage->GetPrimAtPath(SdfPath(path));
+    if (!prim.IsValid() || !prim.HasPayload()) {
+        return nullptr;
+    }
+
+    auto& e = m_entries[path];
+    e.path = path;
+    e.state = prim.IsLoaded() ? State::Loaded : State::Unloaded;
+
+    // position in world space. used to prioritize by distance.
+    UsdGeomXformCache xcache;
+    auto t = xcache.GetLocalToWorldTransform(prim).ExtractTranslation();
+    const auto& conf = m_ctx->getImportSettings();
+    e.position = { (float)t[0], (float)t[1], (float)t[2] };
+    if (conf.swap_handedness) {
+        e.position.x *= -1.0f;
+    }
+    e.position *= conf.scale;
+    return &e;
+}
+
+void PayloadStreamer::scanPayloads()
+{
+    m_needs_scan = false;
+    auto stage = m_ctx->getUsdStage();
+    if (!stage) { return; }
+
+    for (auto prim : UsdTreeIterator::AllPrims(stage->GetPseudoRoot())) {
+        if (prim.HasPayload()) {
+            findOrAddEntry(prim.GetPath().GetString());
+        }
+    }
+}
+
+void PayloadStreamer::updatePriorities()
+{
+    for (auto& kvp : m_entries) {
+        auto& e = kvp.second;
+        if (e.requested && e.explicit_priority >= 0.0f) {
+            e.priority = e.explicit_priority;
+        }
+        else {
+            // always below explicit requests (>= 0). offsetting explicit ones by a huge value would lose their order in float.
+            e.priority = -1.0f - length(e.position - m_view_pos);
+        }
+    }
+}
+
+bool PayloadStreamer::requestLoad(const char *path, float priority)
+{
+    if (!path) {
+        usdiLogError("PayloadStreamer::requestLoad(): invalid parameter\n");
+        return false;
+    }
+    if (!m_ctx->getUsdStage()) {
+        usdiLogError("PayloadStreamer::requestLoad(): stage is not open\n");
+        return false;
+    }
+
+    auto *e = findOrAddEntry(path);
+    if (!e) {
+        usdiLogWarning("PayloadStreamer::requestLoad(): %s is not a payload\n", path);
+        return false;
+    }
+    e->requested = true;
+    e->unload_requested = false;
+    e->explicit_priority = priority;
+    if (e->state == State::Unloaded) {
+        schedule(*e);
+    }
+    return true;
+}
+
+bool PayloadStreamer::requestUnload(const char *path)
+{
+    if (!path) {
+        usdiLogError("PayloadStreamer::requestUnload(): invalid parameter\n");
+        return false;
+    }
+
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    auto& e = it->second;
+    e.requested = false;
+    e.auto_loaded = false;
+    switch (e.state) {
+    case State::Queued:
+    case State::Prefetched:
+    case State::Deferred:
+        cancel(e);
+        break;
+    case State::Loaded:
+        e.unload_requested = true;
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+void PayloadStreamer::schedule(Entry& e)
+{
+    auto stage = m_ctx->getUsdStage();
+    if (!stage) { return; }
+    auto prim = stage->GetPrimAtPath(SdfPath(e.path));
+    if (!prim.IsValid()) { return; }
+
+    // don't prefetch what doesn't fit. update() retries it when budget is available.
+    if (!fitsBudget(e)) {
+        e.state = State::Deferred;
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->path = e.path;
+    job->asset_path = GetPayloadAssetPath(prim);
+    job->priority = e.priority;
+    e.job = job;
+    e.state = State::Queued;
+    enqueue(job);
+}
+
+bool PayloadStreamer::fitsBudget(const Entry& e) const
+{
+    if (m_settings.memory_budget == 0 || e.size == 0) { return true; }
+
+    // loaded payloads with lower priority can be evicted for e
+    size_t evictable = 0;
+    for (auto& kvp : m_entries) {
+        auto& o = kvp.second;
+        if (o.state == State::Loaded && &o != &e && o.priority < e.priority) { evictable += o.size; }
+    }
+    return m_resident_size + e.size <= m_settings.memory_budget + evictable;
+}
+
+size_t PayloadStreamer::getLayersSize(const std::vector<Entry*>& entries) const
+{
+    std::set<std::string> layers;
+    for (auto *e : entries) {
+        for (auto& layer : e->layers) { layers.insert(layer->GetIdentifier()); }
+    }
+    size_t ret = 0;
+    for (auto& id : layers) {
+        auto it = m_layer_sizes.find(id);
+        if (it != m_layer_sizes.end()) { ret += it->second; }
+    }
+    return ret;
+}
+
+void PayloadStreamer::cancel(Entry& e)
+{
+    if (e.job) {
+        e.job->cancelled = true;
+        e.job.reset();
+    }
+    release(e.layers);
+    e.state = State::Unloaded;
+}
+
+void PayloadStreamer::release(std::vector<SdfLayerRefPtr>& layers)
+{
+    if (layers.empty()) { return; }
+
+    // destructing layers can be heavy. let the worker do it.
+    auto job = std::make_shared<Job>();
+    job->release = true;
+    job->layers.swap(layers);
+    enqueue(job);
+}
+
+void PayloadStreamer::addEvent(PayloadEvent::Type type, const Entry& e)
+{
+    m_events.push_back({ type, e.path, e.size });
+}
+
+int PayloadStreamer::update()
+{
+    usdiVTuneScope("PayloadStreamer::update()");
+
+    auto stage = m_ctx->getUsdStage();
+    if (!stage) { return 0; }
+
+    if (m_settings.load_distance > 0.0f && m_needs_scan) {
+        scanPayloads();
+    }
+    updatePriorities();
+
+    // automatic loads / unloads by distance
+    if (m_settings.load_distance > 0.0f) {
+        for (auto& kvp : m_entries) {
+            auto& e = kvp.second;
+            if (e.requested) { continue; }
+            float distance = length(e.position - m_view_pos);
+            if (e.state == State::Unloaded && distance <= m_settings.load_distance) {
+                e.auto_loaded = true;
+                schedule(e);
+            }
+            else if (e.auto_loaded && m_settings.unload_distance > 0.0f && distance > m_settings.unload_distance) {
+                e.auto_loaded = false;
+                if (e.state == State::Loaded) { e.unload_requested = true; }
+                else { cancel(e); }
+            }
+        }
+    }
+
+    // reflect priorities to queued jobs
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (auto& kvp : m_entries) {
+            if (kvp.second.job) { kvp.second.job->priority = kvp.second.priority; }
+        }
+    }
+
+    // completed prefetches
+    JobPtr job;
+    while (m_completed.try_pop(job)) {
+        auto it = m_entries.find(job->path);
+        if (it == m_entries.end() || it->second.job != job) {
+            // cancelled
+            release(job->layers);
+            continue;
+        }
+        auto& e = it->second;
+        e.job.reset();
+        if (job->succeeded) {
+            e.state = State::Prefetched;
+            e.layers.swap(job->layers);
+            e.size = job->size;
+            for (size_t i = 0; i < e.layers.size(); ++i) {
+                m_layer_sizes[e.layers[i]->GetIdentifier()] = job->layer_sizes[i];
+            }
+        }
+        else {
+            e.state = State::Unloaded;
+            e.requested = e.auto_loaded = false;
+            addEvent(PayloadEvent::Type::Failed, e);
+            usdiLogWarning("PayloadStreamer::update(): failed to open %s\n", job->asset_path.c_str());
+        }
+    }
+
+    // pick prefetched entries to compose in priority order
+    std::vector<Entry*> prefetched, loaded, to_load;
+    for (auto& kvp : m_entries) {
+        auto& e = kvp.second;
+        if (e.state == State::Prefetched) { prefetched.push_back(&e); }
+        else if (e.state == State::Loaded && !e.unload_requested) { loaded.push_back(&e); }
+    }
+    std::sort(prefetched.begin(), prefetched.end(), [](Entry *a, Entry *b) { return a->priority > b->priority; });
+
+    if (m_settings.memory_budget > 0) {
+        // enforce memory budget. evict lower priority payloads first.
+        // prefetched layers are in memory too. prefetched entries that don't fit release their layers (deferred).
+        std::sort(loaded.begin(), loaded.end(), [](Entry *a, Entry *b) { return a->priority < b->priority; });
+        std::vector<Entry*> resident = loaded; // loaded[num_evicted..] + accepted prefetched entries
+        size_t num_evicted = 0;
+        for (auto *e : prefetched) {
+            auto with = resident;
+            with.push_back(e);
+            size_t n = num_evicted;
+            while (getLayersSize(with) > m_settings.memory_budget && n < loaded.size() && loaded[n]->priority < e->priority) {
+                with.erase(std::find(with.begin(), with.end(), loaded[n]));
+                ++n;
+            }
+            if (getLayersSize(with) > m_settings.memory_budget) {
+                e->state = State::Deferred;
+                release(e->layers);
+                continue;
+            }
+
+            // evict only if the candidate fits after that. otherwise evictions are wasted.
+            for (; num_evicted < n; ++num_evicted) {
+                loaded[num_evicted]->unload_requested = true;
+            }
+            resident.swap(with);
+            if ((int)to_load.size() < m_settings.max_loads_per_update) {
+                to_load.push_back(e);
+            }
+        }
+    }
+    else {
+        to_load = prefetched;
+        if ((int)to_load.size() > m_settings.max_loads_per_update) {
+            to_load.resize(m_settings.max_loads_per_update);
+        }
+    }
+
+    SdfPathSet load_set, unload_set;
+    for (auto *e : to_load) {
+        load_set.insert(SdfPath(e->path));
+    }
+    std::vector<Entry*> to_unload;
+    for (auto& kvp : m_entries) {
+        auto& e = kvp.second;
+        if (e.unload_requested && e.state == State::Loaded) {
+            unload_set.insert(SdfPath(e.path));
+            to_unload.push_back(&e);
+        }
+    }
+
+    if (!load_set.empty() || !unload_set.empty()) {
+        usdiVTuneScope("PayloadStreamer::update() LoadAndUnload");
+        stage->LoadAndUnload(load_set, unload_set);
+        m_needs_scan = true;
+
+        for (auto *e : to_load) {
+            e->state = State::Loaded;
+            addEvent(PayloadEvent::Type::Loaded, *e);
+        }
+        for (auto *e : to_unload) {
+            e->state = State::Unloaded;
+            e->unload_requested = false;
+            release(e->layers);
+            addEvent(PayloadEvent::Type::Unloaded, *e);
+            e->size = 0;
+        }
+    }
+
+    std::vector<Entry*> resident;
+    for (auto& kvp : m_entries) {
+        auto state = kvp.second.state;
+        if (state == State::Loaded || state == State::Prefetched) { resident.push_back(&kvp.second); }
+    }
+    m_resident_size = getLayersSize(resident);
+
+    // retry deferred payloads. schedule() defers them again if they still don't fit.
+    for (auto& kvp : m_entries) {
+        if (kvp.second.state == State::Deferred) { schedule(kvp.second); }
+    }
+    return (int)m_events.size();
+}
+
+bool PayloadStreamer::popEvent(PayloadEvent& dst)
+{
+    if (m_events.empty()) { return false; }
+
+    auto& ev = m_events.front();
+    m_event_path = ev.path;
+    dst.type = ev.type;
+    dst.path = m_event_path.c_str();
+    dst.resident_size = ev.size;
+    m_events.pop_front();
+    return true;
+}
+
+size_t PayloadStreamer::getResidentSize() const
+{
+    return m_resident_size;
+}
+
+void PayloadStreamer::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond_idle.wait(lock, [this]() { return m_queue.empty() && m_processing == 0; });
+}
+
+
+void PayloadStreamer::enqueue(const JobPtr& job)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.push_back(job);
+    }
+    m_cond.notify_one();
+}
+
+void PayloadStreamer::workerMain()
+{
+    for (;;) {
+        JobPtr job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_stop) { break; }
+
+            // release jobs first. then higher priority first.
+            auto it = std::max_element(m_queue.begin(), m_queue.end(), [](const JobPtr& a, const JobPtr& b) {
+                if (a->release != b->release) { return b->release; }
+                return a->priority < b->priority;
+            });
+            job = *it;
+            m_queue.erase(it);
+            ++m_processing;
+        }
+
+        if (job->release) {
+            job->layers.clear();
+        }
+        else {
+            if (!job->cancelled) {
+                prefetch(*job);
+            }
+            m_completed.push(job);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            --m_processing;
+        }
+        m_cond_idle.notify_all();
+    }
+
+    // jobs left in the queue hold layers. drop them on this thread.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queue.clear();
+}
+
+void PayloadStreamer::prefetch(Job& job)
+{
+    usdiVTuneScope("PayloadStreamer::prefetch()");
+
+    if (job.asset_path.empty()) {
+        job.succeeded = true;
+        return;
+    }
+
+    // open the payload layer and all layers it refers to.
+    // composition in UsdStage::LoadAndUnload() will find them in the layer registry.
+    std::vector<std::string> stack = { job.asset_path };
+    std::set<std::string> visited;
+    while (!stack.empty() && !job.cancelled) {
+        auto path = stack.back();
+        stack.pop_back();
+        if (!visited.insert(path).second) { continue; }
+
+        auto layer = SdfLayer::FindOrOpen(path);
+        if (!layer) {
+            if (path == job.asset_path) { return; }
+            usdiLogWarning("PayloadStreamer::prefetch(): failed to open %s\n", path.c_str());
+            continue;
+        }
+        size_t size = GetFileSize(layer->GetRealPath());
+        job.layers.push_back(layer);
+        job.layer_sizes.push_back(size);
+        job.size += size;
+        for (auto& ref : layer->GetExternalReferences()) {
+            if (!ref.empty()) {
+                stack.push_back(SdfComputeAssetPathRelativeToLayer(layer, ref));
+            }
+        }
+    }
+    job.succeeded = !job.cancelled && !job.layers.empty();
+}
+
+} // namespace usdi
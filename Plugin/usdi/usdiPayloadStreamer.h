@@ -0,0 +1,119 @@
+#pragma once
+
+namespace usdi {
+
+// loads / unloads payloads without stalling the main thread.
+// opening and parsing layers of payloads is done on a worker thread. composing prefetched layers
+// into the stage is done in update() on the main thread. the stage itself is never touched by the worker.
+class PayloadStreamer
+{
+public:
+    PayloadStreamer(Context *ctx);
+    ~PayloadStreamer();
+
+    const PayloadStreamerSettings& getSettings() const;
+    void    setSettings(const PayloadStreamerSettings& v);
+    void    setViewPosition(const float3& v);
+
+    // priority < 0: distance to view position is used
+    bool    requestLoad(const char *path, float priority);
+    bool    requestUnload(const char *path);
+
+    // apply completed prefetches, enforce memory budget and schedule next loads.
+    // return number of events available.
+    int     update();
+    // non-blocking. return false if there is no event.
+    bool    popEvent(PayloadEvent& dst);
+    size_t  getResidentSize() const;
+    // block until all queued jobs are done
+    void    wait();
+
+private:
+    enum class State {
+        Unloaded,
+        Queued,
+        Prefetched,
+        Deferred,   // prefetched once but didn't fit in the budget. layers are released until it fits.
+        Loaded,
+    };
+
+    struct Job
+    {
+        std::string path;
+        std::string asset_path;
+        float priority = 0.0f;
+        bool release = false;
+        std::atomic_bool cancelled = { false };
+
+        // outputs
+        std::vector<SdfLayerRefPtr> layers;
+        std::vector<size_t> layer_sizes;
+        size_t size = 0;
+        bool succeeded = false;
+    };
+    using JobPtr = std::shared_ptr<Job>;
+
+    struct Entry
+    {
+        std::string path;
+        State state = State::Unloaded;
+        bool requested = false;         // explicitly requested by requestLoad()
+        bool auto_loaded = false;       // loaded by load_distance
+        bool unload_requested = false;
+        float explicit_priority = -1.0f;
+        float priority = 0.0f;
+        float3 position = { 0.0f, 0.0f, 0.0f };
+        JobPtr job;
+        std::vector<SdfLayerRefPtr> layers;
+        size_t size = 0;                // on-disk size of the layers. kept while deferred
+    };
+
+    struct EventRecord
+    {
+        PayloadEvent::Type type;
+        std::string path;
+        size_t size;
+    };
+
+    Entry*  findOrAddEntry(const std::string& path);
+    void    scanPayloads();
+    void    updatePriorities();
+    void    schedule(Entry& e);
+    // size of e is known after it is prefetched once. unknown sizes always fit.
+    bool    fitsBudget(const Entry& e) const;
+    // layers shared by entries are counted once
+    size_t  getLayersSize(const std::vector<Entry*>& entries) const;
+    void    cancel(Entry& e);
+    void    release(std::vector<SdfLayerRefPtr>& layers);
+    void    addEvent(PayloadEvent::Type type, const Entry& e);
+
+    void    enqueue(const JobPtr& job);
+    void    workerMain();
+    static void prefetch(Job& job);
+
+private:
+    using Entries = std::map<std::string, Entry>;
+    using Jobs = std::vector<JobPtr>;
+    using Events = std::deque<EventRecord>;
+
+    Context                 *m_ctx = nullptr;
+    PayloadStreamerSettings m_settings;
+    float3                  m_view_pos = { 0.0f, 0.0f, 0.0f };
+    Entries                 m_entries;
+    bool                    m_needs_scan = true;
+    size_t                  m_resident_size = 0;
+    std::map<std::string, size_t> m_layer_sizes; // layer identifier -> on-disk size
+    Events                  m_events;
+    std::string             m_event_path;
+
+    std::thread             m_worker;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    std::condition_variable m_cond_idle;
+    Jobs                    m_queue;
+    int                     m_processing = 0;
+    bool                    m_stop = false;
+    tbb::concurrent_queue<JobPtr> m_completed;
+};
+
+} // namespace usdi
@@ -89,7 +89,7 @@ void Points::updateSample(Time t_)
 
 bool Points::readSample(PointsData& dst, Time t, bool copy)
 {
-    if (t != m_time_prev) { updateSample(t); }
+    updateSampleIfNeeded(t);
 
     if (!m_front_sample) { return false; }
     const auto& sample = *m_front_sample;
@@ -123,27 +123,31 @@ bool Points::writeSample(const PointsData& src, Time t_)
 
     PointsSample sample;
 
+    // swap_handedness and scale are applied while copying, same as Mesh::writeSample()
+    float x = conf.swap_handedness ? -1.0f : 1.0f;
+    float3 position_scale = { x * conf.scale, conf.scale, conf.scale };
+
     if (src.points) {
-        sample.points.assign((GfVec3f*)src.points, (GfVec3f*)src.points + src.num_points);
-        if (conf.swap_handedness) {
-            for (auto& v : sample.points) {
-                v[0] *= -1.0f;
-            }
-        }
+        sample.points.resize(src.num_points);
+        MulCopy((float3*)sample.points.data(), src.points, position_scale, src.num_points);
     }
 
     if (src.velocities) {
-        sample.velocities.assign((GfVec3f*)src.velocities, (GfVec3f*)src.velocities + src.num_points);
-        if (conf.swap_handedness) {
-            for (auto& v : sample.velocities) {
-                v[0] *= -1.0f;
-            }
-        }
+        sample.velocities.resize(src.num_points);
+        MulCopy((float3*)sample.velocities.data(), src.velocities, position_scale, src.num_points);
+    }
+
+    // looking up attributes reads the stage. in parallel export other threads may be adding attributes to it.
+    UsdAttribute attr_points, attr_velocities;
+    {
+        auto lock = m_ctx->lockStage();
+        attr_points = m_points.GetPointsAttr();
+        attr_velocities = m_points.GetVelocitiesAttr();
     }
 
-    bool  ret = m_points.GetPointsAttr().Set(sample.points, t);
+    bool  ret = setSample(attr_points, VtValue(sample.points), t);
     if (src.velocities) {
-        m_points.GetVelocitiesAttr().Set(sample.velocities, t);
+        setSample(attr_velocities, VtValue(sample.velocities), t);
     }
     m_summary_needs_update = true;
     return ret;
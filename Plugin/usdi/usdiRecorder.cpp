@@ -0,0 +1,303 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiSchema.h"
+#include "usdiXform.h"
+#include "usdiCamera.h"
+#include "usdiMesh.h"
+#include "usdiPoints.h"
+#include "usdiContext.h"
+#include "usdiRecorder.h"
+
+namespace usdi {
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double ElapsedMS(Clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+static const size_t ArenaBlockSize = 1024 * 1024;
+static const size_t ArenaAlignment = 16;
+
+
+void* Recorder::Arena::allocate(size_t size)
+{
+    // size 0 still returns a valid pointer. writeSample() distinguishes null from empty.
+    size = (std::max<size_t>(size, 1) + (ArenaAlignment - 1)) & ~(ArenaAlignment - 1);
+
+    while (m_current < m_blocks.size()) {
+        auto& b = m_blocks[m_current];
+        if (b.used + size <= b.size) {
+            void *ret = b.data.get() + b.used;
+            b.used += size;
+            return ret;
+        }
+        ++m_current;
+    }
+
+    Block b;
+    b.size = std::max<size_t>(size, ArenaBlockSize);
+    b.data.reset(new char[b.size]);
+    b.used = size;
+    m_blocks.push_back(std::move(b));
+    m_current = m_blocks.size() - 1;
+    return m_blocks.back().data.get();
+}
+
+template<class T>
+T* Recorder::Arena::copy(const T *src, size_t n)
+{
+    if (!src) { return nullptr; }
+    auto *ret = (T*)allocate(sizeof(T) * n);
+    memcpy(ret, src, sizeof(T) * n);
+    return ret;
+}
+
+char* Recorder::Arena::copyString(const char *src)
+{
+    if (!src) { return nullptr; }
+    return copy(src, strlen(src) + 1);
+}
+
+void Recorder::Arena::clear()
+{
+    for (auto& b : m_blocks) { b.used = 0; }
+    m_current = 0;
+}
+
+size_t Recorder::Arena::getCapacity() const
+{
+    size_t ret = 0;
+    for (auto& b : m_blocks) { ret += b.size; }
+    return ret;
+}
+
+
+void Recorder::Frame::clear()
+{
+    commands.clear();
+    xforms.clear();
+    cameras.clear();
+    meshes.clear();
+    points.clear();
+    arena.clear();
+}
+
+
+Recorder::Recorder(Context *ctx)
+    : m_ctx(ctx)
+{
+    m_worker = std::thread([this]() { workerMain(); });
+    usdiLogTrace("Recorder::Recorder()\n");
+}
+
+Recorder::~Recorder()
+{
+    flush();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    usdiLogTrace("Recorder::~Recorder()\n");
+}
+
+RecorderSettings Recorder::getSettings() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_settings;
+}
+
+void Recorder::setSettings(const RecorderSettings& v)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_settings = v;
+    m_settings.max_queued_frames = std::max<int>(m_settings.max_queued_frames, 1);
+}
+
+Recorder::Frame& Recorder::getCurrentFrame()
+{
+    if (!m_current) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_pool.empty()) {
+            m_current = std::move(m_pool.back());
+            m_pool.pop_back();
+        }
+        else {
+            m_current.reset(new Frame());
+        }
+    }
+    return *m_current;
+}
+
+void Recorder::addCommand(CommandType type, Schema *schema, Time t, int index)
+{
+    m_current->commands.push_back({ type, schema, t, index });
+}
+
+bool Recorder::writeXform(Xform *schema, const XformData& src, Time t)
+{
+    if (!schema) { return false; }
+
+    auto& f = getCurrentFrame();
+    addCommand(CommandType::Xform, schema, t, (int)f.xforms.size());
+    f.xforms.push_back(src);
+    return true;
+}
+
+bool Recorder::writeCamera(Camera *schema, const CameraData& src, Time t)
+{
+    if (!schema) { return false; }
+
+    auto& f = getCurrentFrame();
+    addCommand(CommandType::Camera, schema, t, (int)f.cameras.size());
+    f.cameras.push_back(src);
+    return true;
+}
+
+bool Recorder::writeMesh(Mesh *schema, const MeshData& src, Time t)
+{
+    if (!schema) { return false; }
+
+    auto& f = getCurrentFrame();
+    auto& a = f.arena;
+    MeshData dst = src;
+    dst.points      = a.copy(src.points, src.num_points);
+    dst.velocities  = a.copy(src.velocities, src.num_points);
+    dst.normals     = a.copy(src.normals, src.num_points);
+    dst.tangents    = a.copy(src.tangents, src.num_points);
+    dst.uvs         = a.copy(src.uvs, src.num_points);
+    dst.counts      = a.copy(src.counts, src.num_counts);
+    dst.indices     = a.copy(src.indices, src.num_indices);
+    dst.indices_triangulated = a.copy(src.indices_triangulated, src.num_indices_triangulated);
+    if (src.max_bone_weights == 8) {
+        dst.weights8 = a.copy(src.weights8, src.num_points);
+    }
+    else {
+        dst.weights4 = src.max_bone_weights == 4 ? a.copy(src.weights4, src.num_points) : nullptr;
+    }
+    dst.bindposes   = a.copy(src.bindposes, src.num_bones);
+    dst.bones       = nullptr;
+    if (src.bones) {
+        dst.bones = (char**)a.allocate(sizeof(char*) * src.num_bones);
+        for (uint bi = 0; bi < src.num_bones; ++bi) {
+            dst.bones[bi] = a.copyString(src.bones[bi]);
+        }
+    }
+    dst.root_bone   = a.copyString(src.root_bone);
+    // submeshes are not written by Mesh::writeSample()
+    dst.submeshes = nullptr;
+    dst.num_submeshes = 0;
+
+    addCommand(CommandType::Mesh, schema, t, (int)f.meshes.size());
+    f.meshes.push_back(dst);
+    return true;
+}
+
+bool Recorder::writePoints(Points *schema, const PointsData& src, Time t)
+{
+    if (!schema) { return false; }
+
+    auto& f = getCurrentFrame();
+    PointsData dst = src;
+    dst.points      = f.arena.copy(src.points, src.num_points);
+    dst.velocities  = f.arena.copy(src.velocities, src.num_points);
+
+    addCommand(CommandType::Points, schema, t, (int)f.points.size());
+    f.points.push_back(dst);
+    return true;
+}
+
+void Recorder::endFrame()
+{
+    if (!m_current || m_current->commands.empty()) { return; }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_current->use_write_frame = m_settings.use_write_frame;
+        if ((int)m_queue.size() >= m_settings.max_queued_frames) {
+            // backpressure: the worker can't keep up
+            auto begin = Clock::now();
+            m_cond_written.wait(lock, [this]() { return (int)m_queue.size() < m_settings.max_queued_frames; });
+            ++m_stats.num_stalls;
+            m_stats.stall_time += ElapsedMS(begin);
+        }
+        m_queue.push_back(std::move(m_current));
+        m_stats.max_queued_frames = std::max<int>(m_stats.max_queued_frames, (int)m_queue.size());
+    }
+    m_cond.notify_one();
+}
+
+void Recorder::flush()
+{
+    endFrame();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond_written.wait(lock, [this]() { return m_queue.empty() && !m_writing; });
+}
+
+void Recorder::getStats(RecorderStats& dst)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    dst = m_stats;
+    dst.num_queued_frames = (int)m_queue.size() + (m_writing ? 1 : 0);
+    dst.pooled_bytes = 0;
+    for (auto& f : m_pool) { dst.pooled_bytes += f->arena.getCapacity(); }
+}
+
+void Recorder::writeFrame(Frame& f)
+{
+    if (f.use_write_frame) { m_ctx->beginWriteFrame(); }
+    for (auto& c : f.commands) {
+        switch (c.type) {
+        case CommandType::Xform:
+            static_cast<Xform*>(c.schema)->writeSample(f.xforms[c.index], c.time);
+            break;
+        case CommandType::Camera:
+            static_cast<Camera*>(c.schema)->writeSample(f.cameras[c.index], c.time);
+            break;
+        case CommandType::Mesh:
+            static_cast<Mesh*>(c.schema)->writeSample(f.meshes[c.index], c.time);
+            break;
+        case CommandType::Points:
+            static_cast<Points*>(c.schema)->writeSample(f.points[c.index], c.time);
+            break;
+        }
+    }
+    if (f.use_write_frame) { m_ctx->endWriteFrame(); }
+}
+
+void Recorder::workerMain()
+{
+    for (;;) {
+        FramePtr frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) { break; }
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_writing = true;
+        }
+
+        auto begin = Clock::now();
+        writeFrame(*frame);
+        double elapsed = ElapsedMS(begin);
+        frame->clear();
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pool.push_back(std::move(frame));
+            m_writing = false;
+            ++m_stats.num_written_frames;
+            m_stats.write_time += elapsed;
+        }
+        m_cond_written.notify_all();
+    }
+}
+
+} // namespace usdi
@@ -0,0 +1,105 @@
+#pragma once
+
+namespace usdi {
+
+// records samples without stalling the caller.
+// write*() take a snapshot of the data into pooled buffers and return immediately. conversion and authoring
+// (Xform::writeSample(), Mesh::writeSample(), etc) are done on a worker thread in the order of the calls.
+// schemas must not be created or destroyed while the worker is writing. call flush() before that.
+// the worker is the only thread that writes to the stage while recording: don't write samples of the same
+// context directly until flush(). write frames (Context::beginWriteFrame()) are per thread and don't interfere.
+class Recorder
+{
+public:
+    Recorder(Context *ctx);
+    ~Recorder();
+
+    RecorderSettings getSettings() const;
+    void    setSettings(const RecorderSettings& v);
+
+    bool    writeXform(Xform *schema, const XformData& src, Time t);
+    bool    writeCamera(Camera *schema, const CameraData& src, Time t);
+    bool    writeMesh(Mesh *schema, const MeshData& src, Time t);
+    bool    writePoints(Points *schema, const PointsData& src, Time t);
+
+    // pass recorded samples to the worker. blocks while max_queued_frames frames are waiting to be written.
+    void    endFrame();
+    // endFrame() and block until all queued frames are written
+    void    flush();
+    void    getStats(RecorderStats& dst);
+
+private:
+    // bump allocator. blocks are kept on clear() and reused by following frames.
+    class Arena
+    {
+    public:
+        void*   allocate(size_t size);
+        template<class T> T* copy(const T *src, size_t n);
+        char*   copyString(const char *src);
+        void    clear();
+        size_t  getCapacity() const;
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<char[]> data;
+            size_t size = 0;
+            size_t used = 0;
+        };
+        std::vector<Block> m_blocks;
+        size_t m_current = 0;
+    };
+
+    enum class CommandType {
+        Xform,
+        Camera,
+        Mesh,
+        Points,
+    };
+
+    struct Command
+    {
+        CommandType type;
+        Schema      *schema;
+        Time        time;
+        int         index; // index in Frame::xforms, cameras, etc
+    };
+
+    struct Frame
+    {
+        std::vector<Command>    commands;
+        std::vector<XformData>  xforms;
+        std::vector<CameraData> cameras;
+        std::vector<MeshData>   meshes;
+        std::vector<PointsData> points;
+        Arena                   arena;
+        bool                    use_write_frame = true;
+
+        void clear();
+    };
+    using FramePtr = std::unique_ptr<Frame>;
+    using Frames = std::deque<FramePtr>;
+    using FramePool = std::vector<FramePtr>;
+
+    Frame&  getCurrentFrame();
+    void    addCommand(CommandType type, Schema *schema, Time t, int index);
+    void    writeFrame(Frame& frame);
+    void    workerMain();
+
+private:
+    Context                 *m_ctx = nullptr;
+    RecorderSettings        m_settings;
+    FramePtr                m_current;
+
+    std::thread             m_worker;
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_cond;         // worker waits for frames
+    std::condition_variable m_cond_written; // producers wait for free queue slots or idle
+    Frames                  m_queue;
+    FramePool               m_pool;
+    bool                    m_writing = false;
+    bool                    m_stop = false;
+    RecorderStats           m_stats;
+};
+
+} // namespace usdi
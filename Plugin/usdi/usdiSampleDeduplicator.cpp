@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiContext.h"
+#include "usdiSampleDeduplicator.h"
+#include "usdiUtils.h"
+
+namespace usdi {
+
+template<class T>
+static bool HashScalar(const VtValue& v, uint64_t& hash, size_t& size)
+{
+    if (!v.IsHolding<T>()) { return false; }
+    size = sizeof(T);
+    hash = Hash64(&v.UncheckedGet<T>(), size);
+    return true;
+}
+
+template<class T>
+static bool HashArray(const VtValue& v, uint64_t& hash, size_t& size)
+{
+    if (!v.IsHolding<VtArray<T>>()) { return false; }
+    const auto& a = v.UncheckedGet<VtArray<T>>();
+    size = sizeof(T) * a.size();
+    // seed with the length so that arrays of different sizes with the same leading data differ
+    hash = Hash64(a.cdata(), size, (uint64_t)a.size());
+    return true;
+}
+
+
+SampleDeduplicator::SampleDeduplicator(Context *ctx)
+    : m_ctx(ctx)
+{
+}
+
+SampleDeduplicator::~SampleDeduplicator()
+{
+}
+
+void SampleDeduplicator::clear()
+{
+    m_streams.clear();
+    m_stats = ExportStats();
+}
+
+void SampleDeduplicator::HashValue(const VtValue& v, uint64_t& hash, size_t& size)
+{
+    // raw data of types written by schemas and attributes. others fall back to VtValue::GetHash().
+    if (HashArray<GfVec3f>(v, hash, size) ||
+        HashArray<int>(v, hash, size) ||
+        HashArray<float>(v, hash, size) ||
+        HashArray<GfVec2f>(v, hash, size) ||
+        HashArray<GfVec4f>(v, hash, size) ||
+        HashArray<GfMatrix4f>(v, hash, size) ||
+        HashArray<GfQuatf>(v, hash, size) ||
+        HashArray<half>(v, hash, size) ||
+        HashArray<double>(v, hash, size) ||
+        HashArray<GfVec3d>(v, hash, size) ||
+        HashScalar<GfVec3f>(v, hash, size) ||
+        HashScalar<GfQuatf>(v, hash, size) ||
+        HashScalar<GfVec2f>(v, hash, size) ||
+        HashScalar<GfVec4f>(v, hash, size) ||
+        HashScalar<float>(v, hash, size) ||
+        HashScalar<int>(v, hash, size) ||
+        HashScalar<double>(v, hash, size) ||
+        HashScalar<GfMatrix4f>(v, hash, size) ||
+        HashScalar<GfMatrix4d>(v, hash, size))
+    {
+        return;
+    }
+    hash = v.GetHash();
+    size = 0; // unknown
+}
+
+bool SampleDeduplicator::author(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t, size_t size)
+{
+    ++m_stats.num_written_samples;
+    m_stats.bytes_written += size;
+    return m_ctx->authorSample(attr, v, t);
+}
+
+bool SampleDeduplicator::write(const UsdAttribute& attr, const VtValue& v, Time t)
+{
+    uint64_t hash;
+    size_t size;
+    HashValue(v, hash, size);
+
+    const auto& path = attr.GetPath();
+    auto it = m_streams.find(path);
+    if (it == m_streams.end()) {
+        Stream s;
+        s.hash = hash;
+        s.size = size;
+        s.value = v;
+        s.first_time = s.last_time = s.last_written = t;
+        m_streams[path] = s;
+        return author(attr, v, UsdTimeCode::Default(), size);
+    }
+
+    auto& s = it->second;
+    if (hash == s.hash && size == s.size && t >= s.last_time && v == s.value) {
+        s.last_time = t;
+        ++m_stats.num_skipped_samples;
+        m_stats.bytes_avoided += size;
+        return true;
+    }
+
+    if (s.as_default && t == s.first_time && t == s.last_time) {
+        // the first sample is written again
+        s.hash = hash;
+        s.size = size;
+        s.value = v;
+        return author(attr, v, UsdTimeCode::Default(), size);
+    }
+
+    // the value changed or the sample is out of order. make the previous run explicit before writing the new sample.
+    bool needs_first = s.as_default && s.first_time != t;
+    bool needs_run_end = s.last_time != s.last_written && s.last_time != t;
+    if (needs_first || needs_run_end) {
+        VtValue prev;
+        auto prev_time = s.as_default ? UsdTimeCode::Default() : UsdTimeCode(s.last_written);
+        if (m_ctx->queryAuthoredSample(attr, prev_time, prev)) {
+            if (needs_first) { author(attr, prev, s.first_time, s.size); }
+            if (needs_run_end) { author(attr, prev, s.last_time, s.size); }
+        }
+        else {
+            usdiLogWarning("SampleDeduplicator::write(): failed to read previous value of %s\n", path.GetText());
+        }
+    }
+    s.as_default = false;
+
+    if (t < s.last_time) {
+        // out of order. the latest run is still the previous value and is closed at last_time.
+        s.last_written = s.last_time;
+    }
+    else {
+        s.hash = hash;
+        s.size = size;
+        s.value = v;
+        s.last_time = s.last_written = t;
+    }
+    return author(attr, v, t, size);
+}
+
+void SampleDeduplicator::getStats(ExportStats& dst) const
+{
+    dst = m_stats;
+    dst.num_constant_streams = 0;
+    for (auto& kvp : m_streams) {
+        if (kvp.second.as_default) { ++dst.num_constant_streams; }
+    }
+}
+
+} // namespace usdi
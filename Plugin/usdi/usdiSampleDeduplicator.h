@@ -0,0 +1,42 @@
+#pragma once
+
+namespace usdi {
+
+// export side change detection. owned by Context and used by Context::setSample() if ExportSettings::deduplicate_samples is set.
+// each attribute is a stream identified by its path. a stream is authored as default value until its value changes,
+// and samples identical to the previous one are skipped. hash hits are confirmed by comparing with the kept previous value. when the value changes, the skipped run is closed by
+// authoring the previous value at the last skipped time, so both held and linear interpolation give the same result
+// as writing every sample.
+class SampleDeduplicator
+{
+public:
+    SampleDeduplicator(Context *ctx);
+    ~SampleDeduplicator();
+
+    void    clear();
+    bool    write(const UsdAttribute& attr, const VtValue& v, Time t);
+    void    getStats(ExportStats& dst) const;
+
+private:
+    struct Stream
+    {
+        uint64_t    hash = 0;
+        size_t      size = 0;
+        VtValue     value;              // previous value. arrays share the caller's buffer (copy on write)
+        Time        first_time = 0.0;   // time of the first sample
+        Time        last_time = 0.0;    // time of the last sample, including skipped ones
+        Time        last_written = 0.0; // time of the last authored time sample
+        bool        as_default = true;  // not changed yet. authored only as default value
+    };
+    using Streams = std::unordered_map<SdfPath, Stream, SdfPath::Hash>;
+
+    static void HashValue(const VtValue& v, uint64_t& hash, size_t& size);
+    bool    author(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t, size_t size);
+
+private:
+    Context         *m_ctx = nullptr;
+    Streams         m_streams;
+    ExportStats     m_stats;
+};
+
+} // namespace usdi
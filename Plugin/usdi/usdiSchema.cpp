@@ -171,6 +171,7 @@ Attribute* Schema::createAttribute(const char *name, AttributeType type, Attribu
         }
     }
 
+    auto lock = m_ctx->lockStage();
     if (auto *c = CreateAttribute(this, name, internal_type)) {
         m_attributes.emplace_back(c);
         return c->findOrCreateConverter(type);
@@ -182,8 +183,18 @@ Attribute* Schema::createAttribute(const char *name, AttributeType type, Attribu
 // parent & child interface
 
 Schema* Schema::getParent() const       { return m_parent; }
-int     Schema::getNumChildren() const  { return (int)m_children.size(); }
-Schema* Schema::getChild(int i) const   { return m_children[i]; }
+
+int Schema::getNumChildren() const
+{
+    if (!m_children_populated) { m_ctx->populateChildren(const_cast<Schema*>(this)); }
+    return (int)m_children.size();
+}
+
+Schema* Schema::getChild(int i) const
+{
+    if (!m_children_populated) { m_ctx->populateChildren(const_cast<Schema*>(this)); }
+    return m_children[i];
+}
 
 
 // reference & instance interface
@@ -391,6 +402,11 @@ void Schema::notifyImportConfigChanged()
     m_update_flag_next.import_config_updated = 1;
 }
 
+bool Schema::setSample(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t)
+{
+    return m_ctx->setSample(attr, v, t);
+}
+
 UpdateFlags Schema::getUpdateFlags() const { return m_update_flag; }
 UpdateFlags Schema::getUpdateFlagsPrev() const  { return m_update_flag_prev; }
 
@@ -422,6 +438,111 @@ void Schema::updateSample(Time t)
     //}
 }
 
+void Schema::updateSampleForFrame(Time t, int frame)
+{
+    if (m_master) {
+        m_master->updateSampleForFrame(t, frame);
+
+        // instances have no data on their own. take over flags of the master.
+        m_update_flag_prev = m_update_flag;
+        m_update_flag.bits = m_master->m_update_flag.bits | m_update_flag_next.bits;
+        m_update_flag_next.bits = 0;
+        m_time_prev = t;
+        return;
+    }
+
+    std::unique_lock<tbb::spin_mutex> lock(m_mutex);
+    if (m_update_frame != frame) {
+        m_update_frame = frame;
+        updateSample(t);
+    }
+}
+
+void Schema::updateSampleIfNeeded(Time t)
+{
+    std::unique_lock<tbb::spin_mutex> lock(m_mutex);
+    if (t != m_time_prev) {
+        updateSample(t);
+    }
+}
+
+int Schema::getInstanceTransforms(float4x4 *dst, int max_instances, Time t_)
+{
+    std::unique_lock<tbb::spin_mutex> lock(m_mutex);
+
+    int num_instances = (int)m_instances.size();
+    if (t_ != m_instance_transforms_time || m_instance_transforms.size() != m_instances.size()) {
+        m_instance_transforms_time = t_;
+        m_instance_transforms.resize(num_instances);
+
+        const auto& conf = getImportSettings();
+        UsdGeomXformCache xcache(UsdTimeCode(t_));
+        for (int i = 0; i < num_instances; ++i) {
+            GfMatrix4d m = m_instances[i]->computeLocalToWorld(xcache);
+
+            if (conf.swap_handedness) {
+                m[0][1] *= -1.0; m[0][2] *= -1.0;
+                m[1][0] *= -1.0; m[2][0] *= -1.0;
+                m[3][0] *= -1.0;
+            }
+            m[3][0] *= conf.scale;
+            m[3][1] *= conf.scale;
+            m[3][2] *= conf.scale;
+
+            // GfMatrix4f is row-major with row vectors. its memory layout is identical to column-major with column vectors.
+            (GfMatrix4f&)m_instance_transforms[i] = GfMatrix4f(m);
+        }
+    }
+
+    if (dst) {
+        int n = std::min<int>(num_instances, max_instances);
+        memcpy(dst, m_instance_transforms.data(), sizeof(float4x4) * n);
+    }
+    return num_instances;
+}
+
+float Schema::getUpdatePriority() const
+{
+    return m_update_priority;
+}
+
+void Schema::setUpdatePriority(float v)
+{
+    m_update_priority = v;
+}
+
+GfMatrix4d Schema::computeLocalToWorld(UsdGeomXformCache& xcache) const
+{
+    // compose local transforms of prims in the master, then world transform of the instance root.
+    GfMatrix4d m(1.0);
+    const Schema *s = this;
+    for (; s && s->m_master; s = s->m_parent) {
+        UsdGeomXformable xf(s->m_prim);
+        if (xf) {
+            GfMatrix4d local;
+            bool reset_stack = false;
+            xf.GetLocalTransformation(&local, &reset_stack, xcache.GetTime());
+            m = m * local;
+        }
+    }
+    if (s) {
+        m = m * xcache.GetLocalToWorldTransform(s->m_prim);
+    }
+    return m;
+}
+
+bool Schema::skipSampleForFrame(int frame)
+{
+    std::unique_lock<tbb::spin_mutex> lock(m_mutex);
+    if (m_update_frame == frame) { return false; }
+
+    // pending flags (m_update_flag_next) are kept for the next actual update
+    m_update_frame = frame;
+    m_update_flag_prev = m_update_flag;
+    m_update_flag.bits = 0;
+    return true;
+}
+
 const ImportSettings& Schema::getImportSettings() const
 {
     return m_isettings_overridden ? m_isettings : m_ctx->getImportSettings();
@@ -469,11 +590,24 @@ void Schema::addChild(Schema *child)
     m_children.push_back(child);
 }
 
+void Schema::removeChild(Schema *child)
+{
+    m_children.erase(std::remove(m_children.begin(), m_children.end(), child), m_children.end());
+}
+
 void Schema::addInstance(Schema *instance)
 {
+    // instances can be added from multiple threads while building schema tree in parallel
+    std::unique_lock<tbb::spin_mutex> lock(m_mutex);
     m_instances.push_back(instance);
 }
 
+void Schema::removeInstance(Schema *instance)
+{
+    std::unique_lock<tbb::spin_mutex> lock(m_mutex);
+    m_instances.erase(std::remove(m_instances.begin(), m_instances.end(), instance), m_instances.end());
+}
+
 std::string Schema::makePath(const char *name_)
 {
     // sanitize
@@ -43,6 +43,7 @@ public:
     // parent & child interface
 
     Schema*         getParent() const;
+    // child schemas are materialized on first call if the tree is lazy
     int             getNumChildren() const;
     Schema*         getChild(int i) const;
 
@@ -89,6 +90,24 @@ public:
     UpdateFlags     getUpdateFlags() const;
     UpdateFlags     getUpdateFlagsPrev() const;
     virtual void    updateSample(Time t);
+    // called by Context::updateAllSamples(). sample is updated only once per frame even if it is shared by many instances.
+    void            updateSampleForFrame(Time t, int frame);
+    // update sample if t differs from the last update. safe to call from multiple threads.
+    void            updateSampleIfNeeded(Time t);
+
+    // world space transforms of instances of this master. layout of each matrix is compatible with Unity's Matrix4x4.
+    // dst can be null. return number of instances.
+    int             getInstanceTransforms(float4x4 *dst, int max_instances, Time t);
+    // world transform of this schema in USD space. for instances, local transforms of prims in the master are
+    // composed with the world transform of the instance root (the prim itself is in the master and shared).
+    GfMatrix4d      computeLocalToWorld(UsdGeomXformCache& xcache) const;
+
+    // used by UpdateScheduler. priority < 0: estimated from screen size
+    float           getUpdatePriority() const;
+    void            setUpdatePriority(float v);
+    // called by UpdateScheduler instead of updateSampleForFrame() if the schema is deferred.
+    // keeps current sample and reports no update. return false if the sample is already updated in this frame.
+    bool            skipSampleForFrame(int frame);
 
     const ImportSettings&   getImportSettings() const;
     bool                    isImportSettingsOverridden() const;
@@ -138,9 +157,13 @@ public:
 
 protected:
     void notifyForceUpdate();
+    // write values through Context::setSample() so that write frames can batch them
+    bool setSample(const UsdAttribute& attr, const VtValue& v, UsdTimeCode t);
     void notifyImportConfigChanged();
     void addChild(Schema *child);
+    void removeChild(Schema *child);
     void addInstance(Schema *instance);
+    void removeInstance(Schema *instance);
     std::string makePath(const char *name);
 
 protected:
@@ -168,7 +191,9 @@ protected:
     std::string     m_path;
     UsdPrim         m_prim;
     Children        m_children;
+    std::atomic_bool m_children_populated = { true };
     Instances       m_instances;
+    tbb::spin_mutex m_mutex;
     Attributes      m_attributes;
 
     VariantSets     m_variant_sets;
@@ -176,9 +201,11 @@ protected:
     Time            m_time_start = usdiInvalidTime;
     Time            m_time_end = usdiInvalidTime;
     Time            m_time_prev = usdiInvalidTime;
+    int             m_update_frame = 0;
     UpdateFlags     m_update_flag;
     UpdateFlags     m_update_flag_prev;
     UpdateFlags     m_update_flag_next;
+    float           m_update_priority = -1.0f;
 
     ImportSettings  m_isettings;
     bool            m_isettings_overridden = false;
@@ -187,6 +214,9 @@ protected:
     bool            m_esettings_overridden = false;
 
     void            *m_userdata = nullptr;
+
+    std::vector<float4x4> m_instance_transforms;
+    Time            m_instance_transforms_time = usdiInvalidTime;
 };
 
 
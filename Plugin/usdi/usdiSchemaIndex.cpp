@@ -0,0 +1,194 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiSchema.h"
+#include "usdiSchemaIndex.h"
+
+namespace usdi {
+
+SchemaIndex::SchemaIndex()
+{
+}
+
+SchemaIndex::~SchemaIndex()
+{
+}
+
+void SchemaIndex::clear()
+{
+    m_table.clear();
+    m_root.schema = nullptr;
+    m_root.children.clear();
+}
+
+void SchemaIndex::SplitPath(const std::string& path, Elements& dst)
+{
+    dst.clear();
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t next = path.find('/', pos);
+        if (next == std::string::npos) { next = path.size(); }
+        if (next > pos) {
+            dst.emplace_back(path, pos, next - pos);
+        }
+        pos = next + 1;
+    }
+}
+
+bool SchemaIndex::MatchElement(const char *pattern, const char *name)
+{
+    // iterative glob with backtracking to the last '*'
+    const char *star = nullptr;
+    const char *resume = nullptr;
+    while (*name) {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        }
+        else if (*pattern == '?' || *pattern == *name) {
+            ++pattern;
+            ++name;
+        }
+        else if (star) {
+            pattern = star + 1;
+            name = ++resume;
+        }
+        else {
+            return false;
+        }
+    }
+    while (*pattern == '*') { ++pattern; }
+    return *pattern == '\0';
+}
+
+void SchemaIndex::add(Schema *schema)
+{
+    if (!schema) { return; }
+
+    std::string path = schema->getPath();
+    if (!m_table.emplace(path, schema).second) {
+        usdiLogWarning("SchemaIndex::add(): %s is already registered\n", path.c_str());
+        return;
+    }
+
+    Elements elements;
+    SplitPath(path, elements);
+    Node *node = &m_root;
+    for (auto& e : elements) {
+        auto& c = node->children[e];
+        if (!c) { c.reset(new Node()); }
+        node = c.get();
+    }
+    node->schema = schema;
+}
+
+void SchemaIndex::remove(Schema *schema)
+{
+    if (!schema) { return; }
+
+    std::string path = schema->getPath();
+    auto it = m_table.find(path);
+    if (it == m_table.end() || it->second != schema) { return; }
+    m_table.erase(it);
+
+    Elements elements;
+    SplitPath(path, elements);
+    std::vector<Node*> nodes;
+    nodes.push_back(&m_root);
+    for (auto& e : elements) {
+        auto c = nodes.back()->children.find(e);
+        if (c == nodes.back()->children.end()) { return; }
+        nodes.push_back(c->second.get());
+    }
+    nodes.back()->schema = nullptr;
+
+    // prune nodes that no longer have schemas
+    for (size_t i = elements.size(); i > 0; --i) {
+        Node *n = nodes[i];
+        if (n->schema || !n->children.empty()) { break; }
+        nodes[i - 1]->children.erase(elements[i - 1]);
+    }
+}
+
+Schema* SchemaIndex::find(const std::string& path) const
+{
+    auto it = m_table.find(path);
+    return it != m_table.end() ? it->second : nullptr;
+}
+
+const SchemaIndex::Node* SchemaIndex::findNode(const std::string& path) const
+{
+    Elements elements;
+    SplitPath(path, elements);
+    const Node *node = &m_root;
+    for (auto& e : elements) {
+        auto c = node->children.find(e);
+        if (c == node->children.end()) { return nullptr; }
+        node = c->second.get();
+    }
+    return node;
+}
+
+void SchemaIndex::gatherSubtree(const Node& node, std::vector<Schema*>& dst) const
+{
+    if (node.schema) { dst.push_back(node.schema); }
+    for (auto& c : node.children) {
+        gatherSubtree(*c.second, dst);
+    }
+}
+
+int SchemaIndex::findSubtree(const std::string& path, std::vector<Schema*>& dst) const
+{
+    size_t n = dst.size();
+    if (auto *node = findNode(path)) {
+        gatherSubtree(*node, dst);
+    }
+    return (int)(dst.size() - n);
+}
+
+void SchemaIndex::gatherPattern(const Node& node, const Elements& pattern, size_t pos, std::vector<Schema*>& dst) const
+{
+    if (pos == pattern.size()) {
+        if (node.schema) { dst.push_back(node.schema); }
+        return;
+    }
+
+    const auto& p = pattern[pos];
+    if (p == "**") {
+        // zero elements, or one element and stay on "**"
+        gatherPattern(node, pattern, pos + 1, dst);
+        for (auto& c : node.children) {
+            gatherPattern(*c.second, pattern, pos, dst);
+        }
+    }
+    else if (p.find_first_of("*?") == std::string::npos) {
+        auto c = node.children.find(p);
+        if (c != node.children.end()) {
+            gatherPattern(*c->second, pattern, pos + 1, dst);
+        }
+    }
+    else {
+        for (auto& c : node.children) {
+            if (MatchElement(p.c_str(), c.first.c_str())) {
+                gatherPattern(*c.second, pattern, pos + 1, dst);
+            }
+        }
+    }
+}
+
+int SchemaIndex::findByPattern(const std::string& pattern, std::vector<Schema*>& dst) const
+{
+    Elements elements;
+    SplitPath(pattern, elements);
+
+    size_t n = dst.size();
+    gatherPattern(m_root, elements, 0, dst);
+
+    // consecutive "**" can reach the same node more than once
+    if (std::count(elements.begin(), elements.end(), "**") > 1) {
+        std::set<Schema*> found;
+        dst.erase(std::remove_if(dst.begin() + n, dst.end(), [&](Schema *s) { return !found.insert(s).second; }), dst.end());
+    }
+    return (int)(dst.size() - n);
+}
+
+} // namespace usdi
@@ -0,0 +1,47 @@
+#pragma once
+
+namespace usdi {
+
+// path -> schema index. owned by Context.
+// exact lookups go through a hash table. subtree and pattern queries walk a trie of path elements
+// whose children are sorted by name, so results are always in the same order.
+// not thread safe. Context guards it with m_schemas_mutex.
+class SchemaIndex
+{
+public:
+    SchemaIndex();
+    ~SchemaIndex();
+
+    void    clear();
+    void    add(Schema *schema);
+    void    remove(Schema *schema);
+
+    Schema* find(const std::string& path) const;
+    // path and all its descendants. return number of schemas added to dst.
+    int     findSubtree(const std::string& path, std::vector<Schema*>& dst) const;
+    // pattern is a path that can contain wildcards in its elements:
+    //  '*' matches any string within an element, '?' matches any single character, "**" matches zero or more elements.
+    //  e.g. "/World/Props/*/Mesh", "/World/**/Light?"
+    // return number of schemas added to dst.
+    int     findByPattern(const std::string& pattern, std::vector<Schema*>& dst) const;
+
+private:
+    struct Node
+    {
+        Schema *schema = nullptr;
+        std::map<std::string, std::unique_ptr<Node>> children;
+    };
+    using Elements = std::vector<std::string>;
+
+    static void SplitPath(const std::string& path, Elements& dst);
+    static bool MatchElement(const char *pattern, const char *name);
+    const Node* findNode(const std::string& path) const;
+    void    gatherSubtree(const Node& node, std::vector<Schema*>& dst) const;
+    void    gatherPattern(const Node& node, const Elements& pattern, size_t pos, std::vector<Schema*>& dst) const;
+
+private:
+    std::unordered_map<std::string, Schema*> m_table;
+    Node m_root;
+};
+
+} // namespace usdi
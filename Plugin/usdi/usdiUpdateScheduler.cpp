@@ -0,0 +1,250 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiSchema.h"
+#include "usdiContext.h"
+#include "usdiUpdateScheduler.h"
+
+namespace usdi {
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double ElapsedMS(Clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+
+UpdateScheduler::UpdateScheduler(Context *ctx)
+    : m_ctx(ctx)
+{
+    usdiLogTrace("UpdateScheduler::UpdateScheduler()\n");
+}
+
+UpdateScheduler::~UpdateScheduler()
+{
+    usdiLogTrace("UpdateScheduler::~UpdateScheduler()\n");
+}
+
+const UpdateSchedulerSettings& UpdateScheduler::getSettings() const
+{
+    return m_settings;
+}
+
+void UpdateScheduler::setSettings(const UpdateSchedulerSettings& v)
+{
+    m_settings = v;
+    m_settings.bounds_update_interval = std::max<int>(m_settings.bounds_update_interval, 1);
+}
+
+void UpdateScheduler::setViewPosition(const float3& v)
+{
+    m_view_pos = v;
+}
+
+const UpdateReport& UpdateScheduler::getReport() const
+{
+    return m_report;
+}
+
+Schema* UpdateScheduler::getSkipped(int i) const
+{
+    if (i < 0 || i >= (int)m_skipped.size()) { return nullptr; }
+    return m_skipped[i];
+}
+
+void UpdateScheduler::syncEntries()
+{
+    m_tree_revision = m_ctx->getTreeRevision();
+    m_bounds_needs_update = true;
+
+    // take over aging of schemas that still exist
+    std::map<Schema*, Entry> prev;
+    for (auto& e : m_entries) { prev[e.schema] = e; }
+
+    int n = m_ctx->getNumSchemas();
+    std::map<Schema*, int> indices;
+    m_entries.resize(n);
+    for (int i = 0; i < n; ++i) {
+        auto *s = m_ctx->getSchema(i);
+        auto& e = m_entries[i];
+        e = Entry();
+        auto it = prev.find(s);
+        if (it != prev.end() && it->second.id == s->getID()) {
+            e.skipped = it->second.skipped;
+        }
+        e.schema = s;
+        e.id = s->getID();
+        indices[s] = i;
+    }
+
+    auto find_index = [&](Schema *s) {
+        auto it = indices.find(s);
+        return it != indices.end() ? it->second : -1;
+    };
+    for (auto& e : m_entries) {
+        if (auto *parent = e.schema->getParent()) { e.parent = find_index(parent); }
+        if (auto *master = e.schema->getMaster()) { e.master = find_index(master); }
+    }
+}
+
+void UpdateScheduler::updateBounds(Time t_)
+{
+    m_bounds_needs_update = false;
+
+    auto t = UsdTimeCode(t_);
+    const auto& conf = m_ctx->getImportSettings();
+    UsdGeomXformCache xcache(t);
+    VtVec3fArray extent;
+    for (auto& e : m_entries) {
+        auto prim = e.schema->getUsdPrim();
+        if (!prim.IsValid()) { continue; }
+
+        // instances share the prim of the master. their transforms must be composed through the instance root.
+        auto m = e.schema->computeLocalToWorld(xcache);
+        GfVec3d center = m.ExtractTranslation();
+        double radius = 0.0;
+
+        UsdGeomBoundable boundable(prim);
+        if (boundable && boundable.GetExtentAttr().Get(&extent, t) && extent.size() == 2) {
+            GfVec3d bmin = extent[0], bmax = extent[1];
+            double s = std::max<double>(std::max<double>(
+                m.GetRow3(0).GetLength(), m.GetRow3(1).GetLength()), m.GetRow3(2).GetLength());
+            center = m.Transform((bmin + bmax) * 0.5);
+            radius = (bmax - bmin).GetLength() * 0.5 * s;
+        }
+
+        e.center = { (float)center[0], (float)center[1], (float)center[2] };
+        if (conf.swap_handedness) {
+            e.center.x *= -1.0f;
+        }
+        e.center *= conf.scale;
+        e.radius = (float)radius * conf.scale;
+    }
+}
+
+void UpdateScheduler::updatePriorities()
+{
+    // size on screen in pixels = radius / distance * scale
+    float proj = m_settings.screen_height / (2.0f * std::tan(m_settings.field_of_view * Deg2Rad * 0.5f));
+
+    for (auto& e : m_entries) {
+        float explicit_priority = e.schema->getUpdatePriority();
+        if (explicit_priority >= 0.0f) {
+            e.priority = explicit_priority;
+        }
+        else {
+            float distance = length(e.center - m_view_pos);
+            e.priority = distance > e.radius ? e.radius / distance * proj : m_settings.screen_height;
+        }
+    }
+
+    // parents and masters affect their children and instances. they must not be less important.
+    // parents always come before their children, so one reverse pass is enough.
+    for (int i = (int)m_entries.size() - 1; i >= 0; --i) {
+        auto& e = m_entries[i];
+        if (e.parent >= 0) {
+            auto& p = m_entries[e.parent];
+            p.priority = std::max<float>(p.priority, e.priority);
+        }
+        if (e.master >= 0) {
+            auto& m = m_entries[e.master];
+            m.priority = std::max<float>(m.priority, e.priority);
+        }
+    }
+
+    m_critical.clear();
+    m_order.clear();
+    for (int i = 0; i < (int)m_entries.size(); ++i) {
+        if (m_entries[i].priority >= m_settings.critical_priority) {
+            m_critical.push_back(i);
+        }
+        else {
+            m_order.push_back(i);
+        }
+    }
+
+    auto aged = [this](int i) {
+        const auto& e = m_entries[i];
+        return e.priority + m_settings.aging * (float)e.skipped;
+    };
+    std::stable_sort(m_order.begin(), m_order.end(), [&](int a, int b) { return aged(a) > aged(b); });
+}
+
+void UpdateScheduler::update(Time t)
+{
+    auto lock = m_ctx->lockSchemaTree();
+    auto begin = Clock::now();
+    int frame = m_ctx->newFrame();
+
+    if (m_tree_revision != m_ctx->getTreeRevision()) {
+        syncEntries();
+    }
+    if (m_bounds_needs_update || m_num_updates % m_settings.bounds_update_interval == 0) {
+        updateBounds(t);
+    }
+    ++m_num_updates;
+    updatePriorities();
+
+    auto update_range = [this, t, frame](const Indices& indices, size_t first, size_t last) {
+#ifdef usdiDbgForceSingleThread
+        for (size_t i = first; i != last; ++i) {
+            m_entries[indices[i]].schema->updateSampleForFrame(t, frame);
+        }
+#else
+        size_t grain = std::max<size_t>((last - first) / 32, 1);
+        using range_t = tbb::blocked_range<size_t>;
+        tbb::parallel_for(range_t(first, last, grain), [&](const range_t& r) {
+            for (size_t i = r.begin(); i != r.end(); ++i) {
+                m_entries[indices[i]].schema->updateSampleForFrame(t, frame);
+            }
+        });
+#endif
+    };
+
+    // critical tier ignores the budget
+    update_range(m_critical, 0, m_critical.size());
+    for (int i : m_critical) { m_entries[i].skipped = 0; }
+
+    // the rest is updated in batches until the next batch is expected to exceed the budget
+    size_t num_updated = m_order.size();
+    if (m_settings.time_budget > 0.0) {
+        size_t batch_size = std::max<size_t>(tbb::task_scheduler_init::default_num_threads() * 4, 1);
+        double batch_time = 0.0;
+        size_t pos = 0;
+        while (pos < m_order.size()) {
+            double elapsed = ElapsedMS(begin);
+            if (elapsed + batch_time > m_settings.time_budget) { break; }
+
+            auto batch_begin = Clock::now();
+            size_t last = std::min<size_t>(pos + batch_size, m_order.size());
+            update_range(m_order, pos, last);
+            batch_time = ElapsedMS(batch_begin);
+            pos = last;
+        }
+        num_updated = pos;
+    }
+    else {
+        update_range(m_order, 0, m_order.size());
+    }
+
+    m_skipped.clear();
+    for (size_t i = 0; i < m_order.size(); ++i) {
+        auto& e = m_entries[m_order[i]];
+        if (i >= num_updated && e.schema->skipSampleForFrame(frame)) {
+            ++e.skipped;
+            m_skipped.push_back(e.schema);
+        }
+        else {
+            e.skipped = 0;
+        }
+    }
+
+    m_report.num_skipped = (int)m_skipped.size();
+    m_report.num_updated = (int)m_entries.size() - m_report.num_skipped;
+    m_report.elapsed = ElapsedMS(begin);
+    if (m_report.num_skipped > 0) {
+        usdiLogTrace("UpdateScheduler::update(): %d schemas deferred\n", m_report.num_skipped);
+    }
+}
+
+} // namespace usdi
@@ -0,0 +1,57 @@
+#pragma once
+
+namespace usdi {
+
+// updates samples of schemas in order of priority within a time budget.
+// schemas that don't fit in the budget are deferred to the next update() with aged priority.
+class UpdateScheduler
+{
+public:
+    UpdateScheduler(Context *ctx);
+    ~UpdateScheduler();
+
+    const UpdateSchedulerSettings& getSettings() const;
+    void    setSettings(const UpdateSchedulerSettings& v);
+    void    setViewPosition(const float3& v);
+
+    void    update(Time t);
+    const UpdateReport& getReport() const;
+    // schemas skipped by last update()
+    Schema* getSkipped(int i) const;
+
+private:
+    struct Entry
+    {
+        Schema  *schema = nullptr;
+        int     id = 0;
+        int     parent = -1;    // index of parent entry
+        int     master = -1;    // index of master entry
+        float3  center = { 0.0f, 0.0f, 0.0f }; // world space
+        float   radius = 0.0f;
+        float   priority = 0.0f;
+        int     skipped = 0;    // number of frames skipped in a row
+    };
+
+    void    syncEntries();
+    void    updateBounds(Time t);
+    void    updatePriorities();
+
+private:
+    using Entries = std::vector<Entry>;
+    using Indices = std::vector<int>;
+    using Skipped = std::vector<Schema*>;
+
+    Context                 *m_ctx = nullptr;
+    UpdateSchedulerSettings m_settings;
+    float3                  m_view_pos = { 0.0f, 0.0f, 0.0f };
+    Entries                 m_entries;
+    Indices                 m_critical;
+    Indices                 m_order;
+    Skipped                 m_skipped;
+    UpdateReport            m_report;
+    int                     m_tree_revision = -1;
+    int                     m_num_updates = 0;
+    bool                    m_bounds_needs_update = true;
+};
+
+} // namespace usdi
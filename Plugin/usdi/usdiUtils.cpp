@@ -11,5 +11,94 @@ TempBuffer& GetTemporaryBuffer()
     return s_buf;
 }
 
+// xxHash64 (https://github.com/Cyan4973/xxHash)
+static const uint64_t XXH_Prime1 = 0x9E3779B185EBCA87ull;
+static const uint64_t XXH_Prime2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t XXH_Prime3 = 0x165667B19E3779F9ull;
+static const uint64_t XXH_Prime4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t XXH_Prime5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t XXH_Rotl(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+static inline uint64_t XXH_Read64(const char *p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint32_t XXH_Read32(const char *p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+static inline uint64_t XXH_Round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_Prime2;
+    return XXH_Rotl(acc, 31) * XXH_Prime1;
+}
+
+static inline uint64_t XXH_MergeRound(uint64_t acc, uint64_t v)
+{
+    acc ^= XXH_Round(0, v);
+    return acc * XXH_Prime1 + XXH_Prime4;
+}
+
+uint64_t Hash64(const void *data_, size_t size, uint64_t seed)
+{
+    auto *p = (const char*)data_;
+    auto *end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + XXH_Prime1 + XXH_Prime2;
+        uint64_t v2 = seed + XXH_Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_Prime1;
+        for (; p + 32 <= end; p += 32) {
+            v1 = XXH_Round(v1, XXH_Read64(p));
+            v2 = XXH_Round(v2, XXH_Read64(p + 8));
+            v3 = XXH_Round(v3, XXH_Read64(p + 16));
+            v4 = XXH_Round(v4, XXH_Read64(p + 24));
+        }
+        h = XXH_Rotl(v1, 1) + XXH_Rotl(v2, 7) + XXH_Rotl(v3, 12) + XXH_Rotl(v4, 18);
+        h = XXH_MergeRound(h, v1);
+        h = XXH_MergeRound(h, v2);
+        h = XXH_MergeRound(h, v3);
+        h = XXH_MergeRound(h, v4);
+    }
+    else {
+        h = seed + XXH_Prime5;
+    }
+    h += (uint64_t)size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= XXH_Round(0, XXH_Read64(p));
+        h = XXH_Rotl(h, 27) * XXH_Prime1 + XXH_Prime4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)XXH_Read32(p) * XXH_Prime1;
+        h = XXH_Rotl(h, 23) * XXH_Prime2 + XXH_Prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= (uint8_t)*p * XXH_Prime5;
+        h = XXH_Rotl(h, 11) * XXH_Prime1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_Prime2;
+    h ^= h >> 29;
+    h *= XXH_Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+void SplitLayerPath(const SdfLayerHandle& layer, std::string& dir, std::string& basename, std::string& ext)
+{
+    std::string path = layer ? layer->GetRealPath() : std::string();
+    auto sep = path.find_last_of("/\\");
+    dir = sep == std::string::npos ? "" : path.substr(0, sep + 1);
+    basename = sep == std::string::npos ? path : path.substr(sep + 1);
+    auto dot = basename.find_last_of('.');
+    if (dot != std::string::npos) {
+        ext = basename.substr(dot);
+        basename.resize(dot);
+    }
+    else {
+        ext.clear();
+    }
+}
+
 
 } // namespace usdi
@@ -10,6 +10,13 @@ typedef RawVector<char> TempBuffer;
 
 TempBuffer& GetTemporaryBuffer();
 
+// non-cryptographic hash to detect changes of sample data (xxHash64). every input bit affects all output bits.
+uint64_t Hash64(const void *data, size_t size, uint64_t seed = 0);
+
+// split the real path of the layer. dir has a trailing separator (empty if no directory), ext has a leading '.'.
+// used to place layers written alongside (clips, partitions, etc).
+void SplitLayerPath(const SdfLayerHandle& layer, std::string& dir, std::string& basename, std::string& ext);
+
 
 template<class SourceT>
 inline void InterleaveBuffered(TempBuffer& buf, const SourceT& src, size_t num)
@@ -19,4 +26,24 @@ inline void InterleaveBuffered(TempBuffer& buf, const SourceT& src, size_t num)
     Interleave((vertex_t*)buf.data(), src, num);
 }
 
+inline void InterleaveBuffered(TempBuffer& buf, const VertexLayout& layout, const VertexSource& src, size_t num)
+{
+    buf.resize(layout.getStride() * num);
+    Interleave(buf.data(), layout, src, num);
+}
+
+// interleave into mapped GPU memory. direct: write dst with streaming stores.
+// otherwise build vertices in the temporary buffer and copy (for write-combined memory shared with other threads).
+inline void InterleaveMapped(void *dst, const VertexLayout& layout, const VertexSource& src, size_t num, bool direct)
+{
+    if (direct) {
+        InterleaveStream(dst, layout, src, num);
+    }
+    else {
+        auto& buf = GetTemporaryBuffer();
+        InterleaveBuffered(buf, layout, src, num);
+        memcpy(dst, buf.data(), buf.size());
+    }
+}
+
 } // namespace usdi
@@ -0,0 +1,213 @@
+#include "pch.h"
+#include "usdiInternal.h"
+#include "usdiSchema.h"
+#include "usdiXform.h"
+#include "usdiMesh.h"
+#include "usdiUtils.h"
+#include "usdiVertexAnimation.h"
+
+namespace usdi {
+
+// normals of a sample that has none are null, or zero filled if NormalCalculationType::Never
+static bool HasNormals(const float3 *normals, size_t num)
+{
+    if (!normals) { return false; }
+    for (size_t i = 0; i < num; ++i) {
+        if (normals[i].x != 0.0f || normals[i].y != 0.0f || normals[i].z != 0.0f) { return true; }
+    }
+    return false;
+}
+
+bool VertexAnimation::bake(Mesh *mesh, const VertexAnimationSettings& settings)
+{
+    Time start = settings.start;
+    Time end = settings.end;
+    if (start == end) {
+        const auto& summary = mesh->getSummary();
+        start = summary.start;
+        end = summary.end;
+    }
+    if (settings.interval <= 0.0 || end < start || settings.max_width <= 0) {
+        usdiLogError("VertexAnimation::bake(): invalid settings\n");
+        return false;
+    }
+    int num_frames = (int)((end - start) / settings.interval + 0.001) + 1;
+
+    // read all frames first. bounds of the whole animation are needed to encode points.
+    std::vector<float3> points, normals, sub_points, sub_normals;
+    int num_points = 0;
+    bool has_normals = settings.bake_normals;
+    for (int fi = 0; fi < num_frames; ++fi) {
+        Time t = start + settings.interval * fi;
+        MeshData data;
+        if (!mesh->readSample(data, t, false)) {
+            usdiLogError("VertexAnimation::bake(): failed to read sample at %lf\n", t);
+            return false;
+        }
+
+        // a split mesh is imported as its submeshes. texels must follow the vertices of the submesh then.
+        SubmeshData sub;
+        const float3 *src_points = data.points;
+        const float3 *src_normals = data.normals;
+        int src_num_points = (int)data.num_points;
+        if (data.num_submeshes > 1) {
+            usdiLogError("VertexAnimation::bake(): mesh is split into %u submeshes. only one can be baked\n", data.num_submeshes);
+            return false;
+        }
+        else if (data.num_submeshes == 1) {
+            // the first read only gets the number of points
+            MeshData sdata;
+            sdata.submeshes = &sub;
+            mesh->readSample(sdata, t, false);
+            sub_points.resize(sub.num_points);
+            sub_normals.assign(sub.num_points, float3());
+            sub.points = sub_points.data();
+            sub.normals = sub_normals.data();
+            mesh->readSample(sdata, t, true);
+            src_points = sub.points;
+            src_normals = sub.normals;
+            src_num_points = (int)sub.num_points;
+        }
+
+        if (fi == 0) {
+            num_points = src_num_points;
+            if (num_points == 0 || !src_points) {
+                usdiLogError("VertexAnimation::bake(): mesh has no points\n");
+                return false;
+            }
+            points.resize((size_t)num_points * num_frames);
+            has_normals = has_normals && HasNormals(src_normals, num_points);
+            if (has_normals) {
+                normals.resize(points.size());
+            }
+        }
+        else if (src_num_points != num_points) {
+            usdiLogError("VertexAnimation::bake(): number of points changed at %lf. topology must be constant\n", t);
+            return false;
+        }
+        else if (has_normals && !HasNormals(src_normals, num_points)) {
+            usdiLogError("VertexAnimation::bake(): normals are missing at %lf\n", t);
+            return false;
+        }
+
+        memcpy(&points[(size_t)num_points * fi], src_points, sizeof(float3) * num_points);
+        if (has_normals) {
+            memcpy(&normals[(size_t)num_points * fi], src_normals, sizeof(float3) * num_points);
+        }
+    }
+
+    auto& info = m_info;
+    info.start = start;
+    info.interval = settings.interval;
+    info.num_points = num_points;
+    info.num_frames = num_frames;
+    info.width = std::min(num_points, settings.max_width);
+    info.rows_per_frame = (num_points + info.width - 1) / info.width;
+    info.height = info.rows_per_frame * num_frames;
+    info.half_precision = settings.half_precision;
+    info.texel_size = settings.half_precision ? sizeof(uint16_t) * 4 : sizeof(float) * 4;
+    info.has_normals = has_normals;
+    ComputeBounds(points.data(), points.size(), info.bounds_min, info.bounds_max);
+    if (info.height > 16384) {
+        usdiLogWarning("VertexAnimation::bake(): texture height %d exceeds 16384. some devices can't create the texture\n", info.height);
+    }
+
+    // rows of unused texels are left zero
+    m_points_texels.assign(getTextureSize(), 0);
+    m_normals_texels.assign(has_normals ? getTextureSize() : 0, 0);
+    tbb::parallel_for(0, num_frames, [&](int fi) {
+        size_t offset = (size_t)num_points * fi;
+        encodeFrame(fi, &points[offset], has_normals ? &normals[offset] : nullptr);
+    });
+    return true;
+}
+
+void VertexAnimation::encodeFrame(int frame, const float3 *points, const float3 *normals)
+{
+    const auto& info = m_info;
+    size_t num = (size_t)info.num_points;
+    // points of a frame are contiguous in the texture: ((f * rows_per_frame + i / width) * width + i % width)
+    size_t offset = (size_t)frame * info.rows_per_frame * info.width * info.texel_size;
+
+    float3 extents = info.bounds_max - info.bounds_min;
+    float3 rcp = {
+        extents.x > 0.0f ? 1.0f / extents.x : 0.0f,
+        extents.y > 0.0f ? 1.0f / extents.y : 0.0f,
+        extents.z > 0.0f ? 1.0f / extents.z : 0.0f };
+
+    RawVector<float4> tmp;
+    tmp.resize(num);
+    auto store = [&](std::vector<char>& dst) {
+        if (info.half_precision) {
+            FloatToHalf((uint16_t*)&dst[offset], (const float*)tmp.data(), num * 4);
+        }
+        else {
+            memcpy(&dst[offset], tmp.data(), sizeof(float4) * num);
+        }
+    };
+
+    for (size_t i = 0; i < num; ++i) {
+        float3 p = points[i] - info.bounds_min;
+        tmp[i] = { p.x * rcp.x, p.y * rcp.y, p.z * rcp.z, 1.0f };
+    }
+    store(m_points_texels);
+
+    if (normals) {
+        for (size_t i = 0; i < num; ++i) {
+            tmp[i] = { normals[i].x, normals[i].y, normals[i].z, 0.0f };
+        }
+        store(m_normals_texels);
+    }
+}
+
+const VertexAnimationInfo& VertexAnimation::getInfo() const
+{
+    return m_info;
+}
+
+size_t VertexAnimation::getTextureSize() const
+{
+    return (size_t)m_info.width * m_info.height * m_info.texel_size;
+}
+
+const void* VertexAnimation::getPointsTexels() const
+{
+    return m_points_texels.empty() ? nullptr : m_points_texels.data();
+}
+
+const void* VertexAnimation::getNormalsTexels() const
+{
+    return m_normals_texels.empty() ? nullptr : m_normals_texels.data();
+}
+
+bool VertexAnimation::writeFile(const char *path) const
+{
+    if (m_points_texels.empty()) {
+        usdiLogError("VertexAnimation::writeFile(): nothing to write\n");
+        return false;
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        usdiLogError("VertexAnimation::writeFile(): failed to open %s\n", path);
+        return false;
+    }
+
+    VertexAnimationFileHeader header;
+    header.info = m_info;
+    bool ret =
+        fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(m_points_texels.data(), m_points_texels.size(), 1, f) == 1 &&
+        (m_normals_texels.empty() || fwrite(m_normals_texels.data(), m_normals_texels.size(), 1, f) == 1);
+    fclose(f);
+
+    if (ret) {
+        usdiLogInfo("VertexAnimation::writeFile(): %s\n", path);
+    }
+    else {
+        usdiLogError("VertexAnimation::writeFile(): failed to write %s\n", path);
+    }
+    return ret;
+}
+
+} // namespace usdi
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace usdi {
+
+// points (and normals) of a mesh baked into textures for GPU playback (vertex animation texture).
+// frames are sampled with VertexAnimationSettings::interval and each frame is a block of rows_per_frame rows:
+// texel of point i at frame f is (x, y) = (i % width, f * rows_per_frame + i / width).
+// points texture: rgb = (point - bounds_min) / (bounds_max - bounds_min), a = 1. normals texture: rgb = normal, a = 0.
+// see usdiVertexAnimation.cginc for decoding in shaders.
+class VertexAnimation
+{
+public:
+    // moves the mesh's sample time over the range. topology must be constant and normals must be in all frames or none.
+    // a mesh split into one submesh is baked by the vertices of the submesh. meshes split into more are rejected.
+    bool    bake(Mesh *mesh, const VertexAnimationSettings& settings);
+
+    const VertexAnimationInfo& getInfo() const;
+    size_t  getTextureSize() const; // in byte
+    const void* getPointsTexels() const;
+    const void* getNormalsTexels() const; // null if normals are not baked
+
+    // file layout: VertexAnimationFileHeader, points texels, normals texels (if info.has_normals)
+    bool    writeFile(const char *path) const;
+
+private:
+    void    encodeFrame(int frame, const float3 *points, const float3 *normals);
+
+    VertexAnimationInfo m_info;
+    std::vector<char>   m_points_texels;
+    std::vector<char>   m_normals_texels;
+};
+
+struct VertexAnimationFileHeader
+{
+    char                magic[4] = { 'U', 'V', 'A', 'T' };
+    int                 version = 1;
+    VertexAnimationInfo info;
+};
+
+} // namespace usdi
@@ -246,7 +246,7 @@ void Xform::updateSample(Time t_)
 
 bool Xform::readSample(XformData& dst, Time t)
 {
-    if (t != m_time_prev) { updateSample(t); }
+    updateSampleIfNeeded(t);
 
     dst = m_sample;
     return true;
@@ -260,6 +260,7 @@ bool Xform::writeSample(const XformData& src_, Time t_)
     XformData src = src_;
 
     if (m_write_ops.empty()) {
+        auto lock = m_ctx->lockStage();
         m_write_ops.push_back(m_xf.AddTranslateOp(UsdGeomXformOp::PrecisionFloat));
 #ifdef usdiSerializeRotationAsEuler
         m_write_ops.push_back(m_xf.AddRotateZXYOp(UsdGeomXformOp::PrecisionFloat));
@@ -274,20 +275,20 @@ bool Xform::writeSample(const XformData& src_, Time t_)
         SwapHandedness(src.rotation);
     }
 
-    m_write_ops[0].Set((const GfVec3f&)src.position, t);
+    setSample(m_write_ops[0].GetAttr(), VtValue((const GfVec3f&)src.position), t);
 
 #ifdef usdiSerializeRotationAsEuler
     {
         float3 euler = QuaternionToEulerZXY(src.rotation) * Rad2Deg;
-        m_write_ops[1].Set((const GfVec3f&)euler, t);
+        setSample(m_write_ops[1].GetAttr(), VtValue((const GfVec3f&)euler), t);
     }
 #else // usdiSerializeRotationAsEuler
     {
-        m_write_ops[1].Set((const GfQuatf&)src.rotation, t);
+        setSample(m_write_ops[1].GetAttr(), VtValue((const GfQuatf&)src.rotation), t);
     }
 #endif // usdiSerializeRotationAsEuler
 
-    m_write_ops[2].Set((const GfVec3f&)src.scale, t);
+    setSample(m_write_ops[2].GetAttr(), VtValue((const GfVec3f&)src.scale), t);
     return true;
 }
 
@@ -14,12 +14,36 @@ namespace UTJ
             public static implicit operator bool(Context v) { return v.ptr != IntPtr.Zero; }
         }
 
+        public struct AsyncSave
+        {
+            public IntPtr ptr;
+            public static implicit operator bool(AsyncSave v) { return v.ptr != IntPtr.Zero; }
+        }
+
+        public struct AsyncOpen
+        {
+            public IntPtr ptr;
+            public static implicit operator bool(AsyncOpen v) { return v.ptr != IntPtr.Zero; }
+        }
+
         public struct Attribute
         {
             public IntPtr ptr;
             public static implicit operator bool(Attribute v) { return v.ptr != IntPtr.Zero; }
         }
 
+        public struct AttributeBatch
+        {
+            public IntPtr ptr;
+            public static implicit operator bool(AttributeBatch v) { return v.ptr != IntPtr.Zero; }
+        }
+
+        public struct SampleHandle
+        {
+            public IntPtr ptr;
+            public static implicit operator bool(SampleHandle v) { return v.ptr != IntPtr.Zero; }
+        }
+
         public struct Schema
         {
             public IntPtr ptr;
@@ -57,6 +81,12 @@ namespace UTJ
             public static implicit operator Xform(Points v) { Xform r; r.ptr = v.ptr; return r; }
         }
 
+        public struct VertexAnimation
+        {
+            public IntPtr ptr;
+            public static implicit operator bool(VertexAnimation v) { return v.ptr != IntPtr.Zero; }
+        }
+
         public enum AttributeType
         {
             Unknown,
@@ -172,6 +202,34 @@ namespace UTJ
             }
         };
 
+        public struct OpenSettings
+        {
+            public IntPtr population_mask; // array of string pointers. usdiOpenMasked() is easier to use for masks
+            public int num_population_mask;
+            // if true, children are created on first usdiPrimGetNumChildren() / usdiPrimGetChild() / usdiFindSchema().
+            // call them from the main thread.
+            public Bool lazy_schema_tree;
+
+            public static OpenSettings default_value { get { return default(OpenSettings); } }
+        };
+
+        public enum OpenStage
+        {
+            OpeningLayer,
+            Composing,
+            BuildingSchemas,
+            Completed,
+            Failed,
+            Cancelled,
+        };
+
+        public struct OpenProgress
+        {
+            public OpenStage stage;
+            public float progress; // progress of the stage. 0.0 - 1.0
+            public int num_schemas;
+        };
+
         [Serializable]
         public struct ExportSettings
         {
@@ -179,6 +237,7 @@ namespace UTJ
             public Bool swap_handedness;
             public Bool swap_faces;
             public Bool instanceable_by_default;
+            public Bool deduplicate_samples;
 
             public static ExportSettings default_value
             {
@@ -190,11 +249,21 @@ namespace UTJ
                         swap_handedness = true,
                         swap_faces = true,
                         instanceable_by_default = false,
+                        deduplicate_samples = false,
                     };
                 }
             }
         };
 
+        public struct ExportStats
+        {
+            public int num_written_samples;
+            public int num_skipped_samples;
+            public int num_constant_streams;
+            public ulong bytes_written;
+            public ulong bytes_avoided;
+        };
+
 
         public struct XformSummary
         {
@@ -300,6 +369,7 @@ namespace UTJ
             public IntPtr   indices; // always triangulated
             public IntPtr   weights;
             public int      num_points; // == num_indices
+            public int      max_bone_weights; // same as MeshData.max_bone_weights
 
             public Vector3  center;
             public Vector3  extents;
@@ -380,6 +450,179 @@ namespace UTJ
             public int num_elements;
         };
 
+        public struct PayloadStreamerSettings
+        {
+            public ulong memory_budget;
+            public float load_distance;
+            public float unload_distance;
+            public int max_loads_per_update;
+
+            public static PayloadStreamerSettings default_value
+            {
+                get
+                {
+                    return new PayloadStreamerSettings
+                    {
+                        memory_budget = 0,
+                        load_distance = 0.0f,
+                        unload_distance = 0.0f,
+                        max_loads_per_update = 1,
+                    };
+                }
+            }
+        };
+
+        public struct PayloadEvent
+        {
+            public enum Type
+            {
+                Loaded,
+                Unloaded,
+                Failed,
+            };
+
+            public Type type;
+            public IntPtr path;
+            public ulong resident_size;
+        };
+
+        public struct UpdateSchedulerSettings
+        {
+            public double time_budget;
+            public float field_of_view;
+            public float screen_height;
+            public float critical_priority;
+            public float aging;
+            public int bounds_update_interval;
+
+            public static UpdateSchedulerSettings default_value
+            {
+                get
+                {
+                    return new UpdateSchedulerSettings
+                    {
+                        time_budget = 0.0,
+                        field_of_view = 60.0f,
+                        screen_height = 1080.0f,
+                        critical_priority = 1000000.0f,
+                        aging = 16.0f,
+                        bounds_update_interval = 8,
+                    };
+                }
+            }
+        };
+
+        public struct UpdateReport
+        {
+            public int num_updated;
+            public int num_skipped;
+            public double elapsed;
+        };
+
+        public struct RecorderSettings
+        {
+            public int max_queued_frames;
+            public Bool use_write_frame;
+
+            public static RecorderSettings default_value
+            {
+                get
+                {
+                    return new RecorderSettings
+                    {
+                        max_queued_frames = 4,
+                        use_write_frame = true,
+                    };
+                }
+            }
+        };
+
+        public struct RecorderStats
+        {
+            public int num_queued_frames;
+            public int max_queued_frames;
+            public int num_written_frames;
+            public int num_stalls;
+            public double stall_time;
+            public double write_time;
+            public ulong pooled_bytes;
+        };
+
+        public struct ClipExportSettings
+        {
+            public int frames_per_clip;
+            public Bool binary;
+            public IntPtr directory; // null: next to the root layer. required if the root layer is anonymous
+
+            public static ClipExportSettings default_value
+            {
+                get
+                {
+                    return new ClipExportSettings
+                    {
+                        frames_per_clip = 300,
+                        binary = true,
+                    };
+                }
+            }
+        };
+
+        public struct ParallelExportSettings
+        {
+            public int num_partitions;
+
+            public static ParallelExportSettings default_value
+            {
+                get
+                {
+                    return new ParallelExportSettings
+                    {
+                        num_partitions = 8,
+                    };
+                }
+            }
+        };
+
+        public struct VertexAnimationSettings
+        {
+            public double start, end; // start == end: time range of the mesh
+            public double interval;
+            public int max_width;
+            public Bool half_precision;
+            public Bool bake_normals;
+
+            public static VertexAnimationSettings default_value
+            {
+                get
+                {
+                    return new VertexAnimationSettings
+                    {
+                        interval = 1.0 / 30.0,
+                        max_width = 4096,
+                        half_precision = false,
+                        bake_normals = true,
+                    };
+                }
+            }
+        };
+
+        public struct VertexAnimationInfo
+        {
+            public double start;
+            public double interval;
+            public int num_points;
+            public int num_frames;
+            public int width, height;
+            public int rows_per_frame;
+            public int texel_size;
+            public Bool half_precision;
+            public Bool has_normals;
+            public Vector3 bounds_min;
+            public Vector3 bounds_max;
+
+            public static VertexAnimationInfo default_value { get { return default(VertexAnimationInfo); } }
+        };
+
 
         public enum Platform
         {
@@ -410,30 +653,88 @@ namespace UTJ
         [DllImport ("usdi")] public static extern Context       usdiCreateContext();
         [DllImport ("usdi")] public static extern void          usdiDestroyContext(Context ctx);
         [DllImport ("usdi")] public static extern Bool          usdiOpen(Context ctx, string path);
+        [DllImport ("usdi")] public static extern Bool          usdiOpenMasked(Context ctx, string path, string[] mask_paths, int num_mask_paths);
+        [DllImport ("usdi")] public static extern Bool          usdiOpenWithSettings(Context ctx, string path, ref OpenSettings settings);
+        // ctx must not be used until the returned object is finished
+        [DllImport ("usdi")] public static extern AsyncOpen     usdiOpenAsync(Context ctx, string path, ref OpenSettings settings);
+        [DllImport ("usdi")] public static extern AsyncOpen     usdiOpenAsync(Context ctx, string path, IntPtr settings);
+        [DllImport ("usdi")] public static extern Bool          usdiAsyncOpenIsFinished(AsyncOpen ao);
+        [DllImport ("usdi")] public static extern Bool          usdiAsyncOpenWait(AsyncOpen ao);
+        [DllImport ("usdi")] public static extern void          usdiAsyncOpenGetProgress(AsyncOpen ao, ref OpenProgress dst);
+        [DllImport ("usdi")] public static extern void          usdiAsyncOpenCancel(AsyncOpen ao);
+        [DllImport ("usdi")] public static extern void          usdiAsyncOpenRelease(AsyncOpen ao);
         [DllImport ("usdi")] public static extern Bool          usdiCreateStage(Context ctx, string path);
         [DllImport ("usdi")] public static extern Bool          usdiSave(Context ctx);
         [DllImport ("usdi")] public static extern Bool          usdiSaveAs(Context ctx, string path);
+        [DllImport ("usdi")] public static extern AsyncSave     usdiSaveAsync(Context ctx);
+        [DllImport ("usdi")] public static extern AsyncSave     usdiSaveAsAsync(Context ctx, string path);
+        [DllImport ("usdi")] public static extern Bool          usdiAsyncSaveIsFinished(AsyncSave save);
+        [DllImport ("usdi")] public static extern Bool          usdiAsyncSaveWait(AsyncSave save);
+        [DllImport ("usdi")] public static extern void          usdiAsyncSaveRelease(AsyncSave save);
 
         [DllImport ("usdi")] public static extern void          usdiSetImportSettings(Context ctx, ref ImportSettings v);
         [DllImport ("usdi")] public static extern void          usdiGetImportSettings(Context ctx, ref ImportSettings v);
         [DllImport ("usdi")] public static extern void          usdiSetExportSettings(Context ctx, ref ExportSettings v);
         [DllImport ("usdi")] public static extern void          usdiGetExportSettings(Context ctx, ref ExportSettings v);
+        [DllImport ("usdi")] public static extern void          usdiGetExportStats(Context ctx, ref ExportStats dst);
 
         [DllImport ("usdi")] public static extern Schema        usdiCreateOverride(Context ctx, string prim_path);
         [DllImport ("usdi")] public static extern Xform         usdiCreateXform(Context ctx, Schema parent, string name);
         [DllImport ("usdi")] public static extern Camera        usdiCreateCamera(Context ctx, Schema parent, string name);
         [DllImport ("usdi")] public static extern Mesh          usdiCreateMesh(Context ctx, Schema parent, string name);
         [DllImport ("usdi")] public static extern Points        usdiCreatePoints(Context ctx, Schema parent, string name);
+        [DllImport ("usdi")] public static extern void          usdiBeginWriteFrame(Context ctx);
+        [DllImport ("usdi")] public static extern void          usdiEndWriteFrame(Context ctx);
 
         [DllImport ("usdi")] public static extern Schema        usdiGetRoot(Context ctx);
         [DllImport ("usdi")] public static extern int           usdiGetNumMasters(Context ctx);
         [DllImport ("usdi")] public static extern Schema        usdiGetMaster(Context ctx, int i);
         [DllImport ("usdi")] public static extern Schema        usdiFindSchema(Context ctx, string path);
+        [DllImport ("usdi")] public static extern int           usdiFindSchemas(Context ctx, string[] paths, int num, Schema[] dst);
+        [DllImport ("usdi")] public static extern int           usdiFindSchemasInSubtree(Context ctx, string path, Schema[] dst, int max_dst);
+        [DllImport ("usdi")] public static extern int           usdiFindSchemasByPattern(Context ctx, string pattern, Schema[] dst, int max_dst);
 
         [DllImport ("usdi")] public static extern void          usdiNotifyForceUpdate(Context ctx);
         [DllImport ("usdi")] public static extern void          usdiUpdateAllSamples(Context ctx, double t);
         [DllImport ("usdi")] public static extern void          usdiRebuildSchemaTree(Context ctx);
 
+        // Payload streaming interface
+        [DllImport ("usdi")] public static extern void          usdiStreamerSetSettings(Context ctx, ref PayloadStreamerSettings v);
+        [DllImport ("usdi")] public static extern void          usdiStreamerGetSettings(Context ctx, ref PayloadStreamerSettings v);
+        [DllImport ("usdi")] public static extern void          usdiStreamerSetViewPosition(Context ctx, ref Vector3 v);
+        [DllImport ("usdi")] public static extern Bool          usdiStreamerRequestLoad(Context ctx, string prim_path, float priority);
+        [DllImport ("usdi")] public static extern Bool          usdiStreamerRequestUnload(Context ctx, string prim_path);
+        [DllImport ("usdi")] public static extern int           usdiStreamerUpdate(Context ctx);
+        [DllImport ("usdi")] public static extern Bool          usdiStreamerPopEvent(Context ctx, ref PayloadEvent dst);
+        [DllImport ("usdi")] public static extern ulong         usdiStreamerGetResidentSize(Context ctx);
+        [DllImport ("usdi")] public static extern void          usdiStreamerWait(Context ctx);
+
+        // Update scheduler interface
+        [DllImport ("usdi")] public static extern void          usdiSchedulerSetSettings(Context ctx, ref UpdateSchedulerSettings v);
+        [DllImport ("usdi")] public static extern void          usdiSchedulerGetSettings(Context ctx, ref UpdateSchedulerSettings v);
+        [DllImport ("usdi")] public static extern void          usdiSchedulerSetViewPosition(Context ctx, ref Vector3 v);
+        [DllImport ("usdi")] public static extern void          usdiSchedulerUpdate(Context ctx, double t, ref UpdateReport report);
+        [DllImport ("usdi")] public static extern Schema        usdiSchedulerGetSkipped(Context ctx, int i);
+
+        // Recorder interface
+        [DllImport ("usdi")] public static extern void          usdiRecorderSetSettings(Context ctx, ref RecorderSettings v);
+        [DllImport ("usdi")] public static extern void          usdiRecorderGetSettings(Context ctx, ref RecorderSettings v);
+        [DllImport ("usdi")] public static extern Bool          usdiRecorderWriteXform(Context ctx, Xform xf, ref XformData src, double t);
+        [DllImport ("usdi")] public static extern Bool          usdiRecorderWriteCamera(Context ctx, Camera cam, ref CameraData src, double t);
+        [DllImport ("usdi")] public static extern Bool          usdiRecorderWriteMesh(Context ctx, Mesh mesh, ref MeshData src, double t);
+        [DllImport ("usdi")] public static extern Bool          usdiRecorderWritePoints(Context ctx, Points points, ref PointsData src, double t);
+        [DllImport ("usdi")] public static extern void          usdiRecorderEndFrame(Context ctx);
+        [DllImport ("usdi")] public static extern void          usdiRecorderFlush(Context ctx);
+        [DllImport ("usdi")] public static extern void          usdiRecorderGetStats(Context ctx, ref RecorderStats dst);
+
+        // Value clip export interface
+        [DllImport ("usdi")] public static extern Bool          usdiBeginClipExport(Context ctx, ref ClipExportSettings settings);
+        [DllImport ("usdi")] public static extern Bool          usdiEndClipExport(Context ctx);
+
+        // Parallel export interface
+        [DllImport ("usdi")] public static extern Bool          usdiBeginParallelExport(Context ctx, ref ParallelExportSettings settings);
+        [DllImport ("usdi")] public static extern Bool          usdiEndParallelExport(Context ctx);
+
         // Prim interface
         [DllImport ("usdi")] public static extern int           usdiPrimGetID(Schema schema);
         [DllImport ("usdi")] public static extern IntPtr        usdiPrimGetPath(Schema schema);
@@ -443,6 +744,9 @@ namespace UTJ
         [DllImport ("usdi")] public static extern Schema        usdiPrimGetMaster(Schema schema);
         [DllImport ("usdi")] public static extern int           usdiPrimGetNumInstances(Schema schema);
         [DllImport ("usdi")] public static extern Schema        usdiPrimGetInstance(Schema schema, int i);
+        [DllImport ("usdi")] public static extern int           usdiPrimGetInstanceTransforms(Schema schema, Matrix4x4[] dst, int max_instances, double t);
+        [DllImport ("usdi")] public static extern float         usdiPrimGetUpdatePriority(Schema schema);
+        [DllImport ("usdi")] public static extern void          usdiPrimSetUpdatePriority(Schema schema, float v);
         [DllImport ("usdi")] public static extern void          usdiPrimSetInstanceable(Schema schema, Bool v);
         [DllImport ("usdi")] public static extern Bool          usdiPrimAddReference(Schema schema, string asset_path, string prim_path);
 
@@ -508,6 +812,23 @@ namespace UTJ
         [DllImport ("usdi")] public static extern Bool          usdiMeshReadSample(Mesh mesh, ref MeshData dst, double t, Bool copy);
         [DllImport ("usdi")] public static extern Bool          usdiMeshWriteSample(Mesh mesh, ref MeshData src, double t);
 
+        // Vertex animation texture interface
+        [DllImport ("usdi")] public static extern VertexAnimation usdiMeshBakeVertexAnimation(Mesh mesh, ref VertexAnimationSettings settings);
+        [DllImport ("usdi")] public static extern void          usdiVtxAnimRelease(VertexAnimation va);
+        [DllImport ("usdi")] public static extern void          usdiVtxAnimGetInfo(VertexAnimation va, ref VertexAnimationInfo dst);
+        [DllImport ("usdi")] public static extern Bool          usdiVtxAnimReadTexels(VertexAnimation va, IntPtr dst_points, IntPtr dst_normals);
+        [DllImport ("usdi")] public static extern Bool          usdiVtxAnimWriteFile(VertexAnimation va, string path);
+
+        // set properties used by usdiVertexAnimation.cginc
+        public static void VertexAnimationSetMaterialProperties(Material mat, ref VertexAnimationInfo info, Texture points, Texture normals)
+        {
+            mat.SetTexture("_usdiVATPoints", points);
+            mat.SetTexture("_usdiVATNormals", normals);
+            mat.SetVector("_usdiVATParams", new Vector4(info.rows_per_frame, info.num_frames, (float)(1.0 / info.interval), (float)info.start));
+            mat.SetVector("_usdiVATBoundsMin", info.bounds_min);
+            mat.SetVector("_usdiVATBoundsMax", info.bounds_max);
+        }
+
         // Points interface
         [DllImport ("usdi")] public static extern Points        usdiAsPoints(Schema schema);
         [DllImport ("usdi")] public static extern void          usdiPointsGetSummary(Points points, ref PointsSummary dst);
@@ -520,6 +841,19 @@ namespace UTJ
         [DllImport ("usdi")] public static extern void          usdiAttrGetSummary(Attribute attr, ref AttributeSummary dst);
         [DllImport ("usdi")] public static extern bool          usdiAttrReadSample(Attribute attr, ref AttributeData dst, double t, Bool copy);
         [DllImport ("usdi")] public static extern bool          usdiAttrWriteSample(Attribute attr, ref AttributeData src, double t);
+        [DllImport ("usdi")] public static extern Bool          usdiAttrEnableCache(Attribute attr, ulong max_bytes);
+        [DllImport ("usdi")] public static extern void          usdiAttrDisableCache(Attribute attr);
+        [DllImport ("usdi")] public static extern ulong         usdiAttrGetCacheSize(Attribute attr);
+        [DllImport ("usdi")] public static extern SampleHandle  usdiAttrAcquireSample(Attribute attr, ref AttributeData dst, double t);
+        [DllImport ("usdi")] public static extern void          usdiSampleRetain(SampleHandle handle);
+        [DllImport ("usdi")] public static extern void          usdiSampleRelease(SampleHandle handle);
+
+        // Attribute batch interface
+        [DllImport ("usdi")] public static extern AttributeBatch usdiCreateAttributeBatch();
+        [DllImport ("usdi")] public static extern void          usdiAttrBatchRelease(AttributeBatch batch);
+        [DllImport ("usdi")] public static extern int           usdiAttrBatchAdd(AttributeBatch batch, Attribute attr, ulong offset, int capacity);
+        [DllImport ("usdi")] public static extern void          usdiAttrBatchClear(AttributeBatch batch);
+        [DllImport ("usdi")] public static extern int           usdiAttrBatchRead(AttributeBatch batch, IntPtr arena, double t, uint[] changed_mask, int[] num_elements);
 
         [DllImport ("usdi")] public static extern IntPtr        usdiIndexStringArray(IntPtr v, int i);
         [DllImport ("usdi")] public static extern void          usdiMeshAssignRootBone(Mesh mesh, ref MeshData dst, string v);
@@ -597,8 +931,13 @@ namespace UTJ
         [DllImport("usdi")] public static extern void usdiVtxCmdDestroy(IntPtr h);
         [DllImport("usdi")] public static extern void usdiVtxCmdUpdate(IntPtr h, ref MeshData data, IntPtr vb, IntPtr ib);
         [DllImport("usdi")] public static extern void usdiVtxCmdUpdateSub(IntPtr h, ref SubmeshData data, IntPtr vb, IntPtr ib);
+        [DllImport("usdi")] public static extern void usdiVtxCmdSetVertexLayout(IntPtr h, VertexAttribute attributes);
         [DllImport("usdi")] public static extern void usdiVtxCmdWait();
 
+        [DllImport("usdi")] public static extern Bool usdiVtxAnimCreateTextures(VertexAnimation va, ref IntPtr dst_points_tex, ref IntPtr dst_normals_tex);
+        [DllImport("usdi")] public static extern Bool usdiVtxAnimWriteTextures(VertexAnimation va, IntPtr points_tex, IntPtr normals_tex);
+        [DllImport("usdi")] public static extern void usdiGfxReleaseTexture(IntPtr tex);
+
 
         public delegate void usdiMonoDelegate(IntPtr arg);
         [DllImport("usdi")] public static extern void usdiTaskDestroy(IntPtr task);
@@ -652,6 +991,18 @@ namespace UTJ
         public static MeshAssignBoundsT MeshAssignBounds;
 
 
+        // attributes are placed in this order in a vertex
+        [Flags]
+        public enum VertexAttribute
+        {
+            Default     = 0, // Points, Normals [, UVs [, Tangents]] by the sample
+            Points      = 0x01,
+            Normals     = 0x02,
+            UVs         = 0x04,
+            Tangents    = 0x08,
+            Weights4    = 0x40, // 0x10 and 0x20 are reserved
+        };
+
         public class VertexUpdateCommand
         {
             IntPtr handle;
@@ -675,6 +1026,11 @@ namespace UTJ
             {
                 usdiVtxCmdUpdateSub(handle, ref data, vb, ib);
             }
+
+            public void SetVertexLayout(VertexAttribute attributes)
+            {
+                usdiVtxCmdSetVertexLayout(handle, attributes);
+            }
         }
 
 
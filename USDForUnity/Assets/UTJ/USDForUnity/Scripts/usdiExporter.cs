@@ -632,6 +632,8 @@ namespace UTJ
         public float m_scale = 1.0f;
         public bool m_swapHandedness = true;
         public bool m_swapFaces = true;
+        [Tooltip("Skip samples that are identical to the previous frame. Static attributes are written as default value.")]
+        public bool m_deduplicateSamples = true;
 
         [Header("Capture Components")]
 
@@ -675,6 +677,7 @@ namespace UTJ
 
         usdi.Task m_asyncFlush;
         float m_timeFlush;
+        usdi.AsyncSave m_asyncSave;
         #endregion
 
 
@@ -924,6 +927,7 @@ namespace UTJ
             conf.scale = m_scale;
             conf.swap_handedness = m_swapHandedness;
             conf.swap_faces = m_swapFaces;
+            conf.deduplicate_samples = m_deduplicateSamples;
             usdi.usdiSetExportSettings(m_ctx, ref conf);
         }
 
@@ -990,12 +994,30 @@ namespace UTJ
             }
         }
 
+        void ReleaseAsyncSave()
+        {
+            if (m_asyncSave)
+            {
+                usdi.usdiAsyncSaveRelease(m_asyncSave); // waits
+                m_asyncSave = default(usdi.AsyncSave);
+            }
+        }
+
         void FlushUSD()
         {
             WaitFlush();
+            ReleaseAsyncSave();
             usdi.usdiSave(m_ctx);
         }
 
+        // the snapshot is taken here and written to the file while next frames are captured
+        void FlushUSDAsync()
+        {
+            WaitFlush();
+            ReleaseAsyncSave();
+            m_asyncSave = usdi.usdiSaveAsync(m_ctx);
+        }
+
 
         void ProcessCapture()
         {
@@ -1021,7 +1043,9 @@ namespace UTJ
 #if UNITY_EDITOR
             if (m_forceSingleThread)
             {
+                usdi.usdiBeginWriteFrame(m_ctx);
                 foreach (var c in m_capturers) { c.Flush(time); }
+                usdi.usdiEndWriteFrame(m_ctx);
             }
             else
 #endif
@@ -1030,12 +1054,14 @@ namespace UTJ
                 {
                     m_asyncFlush = new usdi.DelegateTask((var) =>
                     {
+                        usdi.usdiBeginWriteFrame(m_ctx);
                         try
                         {
                             foreach (var c in m_capturers) { c.Flush(m_timeFlush); }
                         }
                         finally
                         {
+                            usdi.usdiEndWriteFrame(m_ctx);
                         }
                     }, "usdiExporter: " + gameObject.name);
                 }
@@ -1049,7 +1075,7 @@ namespace UTJ
             // flush to file when needed
             if (m_flushEveryNthFrames > 0 && m_frameCount % m_flushEveryNthFrames == 0)
             {
-                FlushUSD();
+                FlushUSDAsync();
             }
 
             m_elapsed = Time.realtimeSinceStartup - begin_time;